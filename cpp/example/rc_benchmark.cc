@@ -0,0 +1,243 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/energy_storage_device.h>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/mpi/environment.hpp>
+#include <boost/mpi/timer.hpp>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// This example compares the cost of a time step of the resistor-capacitor
+// devices with the cost of the same time step when the coefficients are
+// evaluated at every step, as the devices did before the propagators were
+// cached. The devices are timed with a fixed time step, which is the case
+// during a stage of a protocol, and with a time step that changes at every
+// step, which forces the coefficients that the operating condition uses to be
+// recomputed.
+
+// Cells advanced with the formulas of the devices before the propagators were
+// cached: the exponentials are evaluated at every time step and nothing is
+// evaluated for a cell without leakage under constant current. The functions
+// are virtual so that they pay for the same dispatch as the devices.
+struct UncachedCells
+{
+  UncachedCells(boost::property_tree::ptree const &database,
+                std::size_t const n_cells)
+      : R(n_cells, database.get<double>("series_resistance")),
+        G(n_cells, 1.0 / database.get("parallel_resistance",
+                                      std::numeric_limits<double>::infinity())),
+        C(n_cells, database.get<double>("capacitance")),
+        U_C(n_cells, database.get<double>("initial_voltage")), U(U_C),
+        I(n_cells, 0.0)
+  {
+  }
+
+  virtual ~UncachedCells() = default;
+
+  virtual void constant_current(double const dt, double const current)
+  {
+    for (std::size_t i = 0; i < R.size(); ++i)
+    {
+      if (G[i] == 0.0)
+        U_C[i] += current * dt / C[i];
+      else
+      {
+        double const x = G[i] * dt / C[i];
+        U_C[i] = U_C[i] * std::exp(-x) - current * std::expm1(-x) / G[i];
+      }
+      I[i] = current;
+      U[i] = U_C[i] + R[i] * current;
+    }
+  }
+
+  virtual void constant_voltage(double const dt, double const voltage)
+  {
+    for (std::size_t i = 0; i < R.size(); ++i)
+    {
+      double const gain = 1.0 / (1.0 + R[i] * G[i]);
+      U_C[i] -= (voltage * gain - U_C[i]) *
+                std::expm1(-dt / (R[i] * C[i] * gain));
+      U[i] = voltage;
+      I[i] = (voltage - U_C[i]) / R[i];
+    }
+  }
+
+  virtual void constant_power(double const dt, double const power)
+  {
+    for (std::size_t i = 0; i < R.size(); ++i)
+    {
+      double charge = dt / C[i];
+      double U_eq = U_C[i];
+      if (G[i] != 0.0)
+      {
+        double const x = G[i] * dt / C[i];
+        charge = -std::expm1(-x) / G[i];
+        U_eq *= std::exp(-x);
+      }
+      double const discriminant = U_eq * U_eq + 4.0 * (R[i] + charge) * power;
+      U[i] = 0.5 * (U_eq + std::copysign(std::sqrt(discriminant), U_eq));
+      I[i] = power / U[i];
+      U_C[i] = U_eq + charge * I[i];
+      U[i] = U_C[i] + R[i] * I[i];
+    }
+  }
+
+  std::vector<double> R, G, C, U_C, U, I;
+};
+
+// Each call to evolve_two_time_steps performs a charge step and a discharge
+// step so that the voltage stays bounded.
+template <typename Device>
+double time_per_step(
+    Device &device,
+    std::function<void(Device &, double)> const &evolve_two_time_steps,
+    bool const fixed_time_step, unsigned int const n_steps)
+{
+  double const time_step = 1.0e-3;
+  boost::mpi::timer timer;
+  for (unsigned int i = 0; i < n_steps; ++i)
+    evolve_two_time_steps(
+        device, fixed_time_step ? time_step : time_step * (1.0 + 1.0e-9 * i));
+  return timer.elapsed() / (2 * n_steps);
+}
+
+void run_example(boost::mpi::communicator &comm)
+{
+  std::vector<boost::property_tree::ptree> databases(3);
+  for (auto &database : databases)
+  {
+    database.put("series_resistance", 50.0e-3);
+    database.put("capacitance", 3.0);
+    database.put("initial_voltage", 1.0);
+  }
+  databases[0].put("type", "SeriesRC");
+  databases[1].put("type", "ParallelRC");
+  databases[1].put("parallel_resistance", 2.5e6);
+  databases[2].put("type", "RCBank");
+  databases[2].put("parallel_resistance", 2.5e6);
+  databases[2].put("n_cells", 10000);
+  databases[2].put("distributed", true);
+
+  typedef cap::EnergyStorageDevice Device;
+  std::vector<std::tuple<std::string, std::function<void(Device &, double)>,
+                         std::function<void(UncachedCells &, double)>>>
+      operating_conditions = {
+          std::make_tuple(
+              "constant current",
+              [](Device &device, double dt)
+              {
+                device.evolve_one_time_step_constant_current(dt, 0.1);
+                device.evolve_one_time_step_constant_current(dt, -0.1);
+              },
+              [](UncachedCells &cells, double dt)
+              {
+                cells.constant_current(dt, 0.1);
+                cells.constant_current(dt, -0.1);
+              }),
+          std::make_tuple(
+              "constant voltage",
+              [](Device &device, double dt)
+              {
+                device.evolve_one_time_step_constant_voltage(dt, 2.0);
+                device.evolve_one_time_step_constant_voltage(dt, 1.0);
+              },
+              [](UncachedCells &cells, double dt)
+              {
+                cells.constant_voltage(dt, 2.0);
+                cells.constant_voltage(dt, 1.0);
+              }),
+          std::make_tuple(
+              "constant power",
+              [](Device &device, double dt)
+              {
+                device.evolve_one_time_step_constant_power(dt, 0.1);
+                device.evolve_one_time_step_constant_power(dt, -0.1);
+              },
+              [](UncachedCells &cells, double dt)
+              {
+                cells.constant_power(dt, 0.1);
+                cells.constant_power(dt, -0.1);
+              })};
+
+  for (auto const &database : databases)
+  {
+    std::string const type = database.get<std::string>("type");
+    auto device = cap::EnergyStorageDevice::build(database, comm);
+    // The uncached cells of the distributed bank are split as evenly as
+    // possible among the processors.
+    std::size_t n_cells = 1;
+    if (type == "RCBank")
+    {
+      std::size_t const n_bank_cells = database.get<std::size_t>("n_cells");
+      std::size_t const n_processors = comm.size();
+      std::size_t const rank = comm.rank();
+      n_cells = n_bank_cells / n_processors +
+                ((rank < n_bank_cells % n_processors) ? 1 : 0);
+    }
+    UncachedCells uncached(database, n_cells);
+    unsigned int const n_steps = (type == "RCBank") ? 1000 : 1000000;
+    for (auto const &condition : operating_conditions)
+    {
+      double const baseline = time_per_step<UncachedCells>(
+          uncached, std::get<2>(condition), true, n_steps);
+      double const fixed =
+          time_per_step<Device>(*device, std::get<1>(condition), true, n_steps);
+      double const varying = time_per_step<Device>(
+          *device, std::get<1>(condition), false, n_steps);
+      if (comm.rank() == 0)
+        std::cout << type << " " << std::get<0>(condition) << ": "
+                  << baseline * 1.0e9 << " ns per step without cache, "
+                  << fixed * 1.0e9 << " ns with a fixed time step (speedup "
+                  << baseline / fixed << "), " << varying * 1.0e9
+                  << " ns with a varying time step (speedup "
+                  << baseline / varying << ")" << std::endl;
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  try
+  {
+    boost::mpi::environment env(argc, argv);
+    boost::mpi::communicator world;
+    run_example(world);
+  }
+  catch (std::exception &exc)
+  {
+    std::cerr << std::endl
+              << std::endl
+              << "----------------------------------------------------"
+              << std::endl;
+    std::cerr << "Exception on processing: " << std::endl
+              << exc.what() << std::endl
+              << "Aborting!" << std::endl
+              << "----------------------------------------------------"
+              << std::endl;
+    return 1;
+  }
+  catch (...)
+  {
+    std::cerr << std::endl
+              << std::endl
+              << "----------------------------------------------------"
+              << std::endl;
+    std::cerr << "Unknown exception!" << std::endl
+              << "Aborting!" << std::endl
+              << "----------------------------------------------------"
+              << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -4,9 +4,36 @@
 #include <cap/supercapacitor.h>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/info_parser.hpp>
+#include <boost/mpi/collectives.hpp>
 #include <boost/mpi/environment.hpp>
 #include <boost/mpi/timer.hpp>
+#include <functional>
 #include <iostream>
+#include <string>
+#include <sys/resource.h>
+
+// Return the peak resident set size of the process in MB.
+double get_peak_memory()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  // ru_maxrss is in kB on Linux.
+  return usage.ru_maxrss / 1024.;
+}
+
+void report_memory(boost::mpi::communicator &comm, std::string const &stage)
+{
+  double const peak_memory = get_peak_memory();
+  double max_peak_memory = 0.;
+  double sum_peak_memory = 0.;
+  boost::mpi::reduce(comm, peak_memory, max_peak_memory,
+                     boost::mpi::maximum<double>(), 0);
+  boost::mpi::reduce(comm, peak_memory, sum_peak_memory, std::plus<double>(),
+                     0);
+  if (comm.rank() == 0)
+    std::cout << "Peak memory after " << stage << " (MB): max per processor "
+              << max_peak_memory << ", total " << sum_peak_memory << std::endl;
+}
 
 void run_example(boost::mpi::communicator &comm)
 {
@@ -19,8 +46,16 @@ void run_example(boost::mpi::communicator &comm)
   boost::property_tree::info_parser::read_info("super_capacitor.info",
                                                device_database);
 
+  // The startup time includes the construction of the mesh, the distribution
+  // of the degrees of freedom, and the assembly of the system.
+  boost::mpi::timer setup_timer;
   std::shared_ptr<cap::EnergyStorageDevice> device =
       cap::EnergyStorageDevice::build(device_database, comm);
+  comm.barrier();
+  double const setup_time = setup_timer.elapsed();
+  if (comm.rank() == 0)
+    std::cout << "Setup time: " << setup_time << std::endl;
+  report_memory(comm, "setup");
 
   unsigned int const n_time_steps = 10;
   double const time_step = 0.1;
@@ -36,6 +71,7 @@ void run_example(boost::mpi::communicator &comm)
     std::cout << "n dofs: " << data["n_dofs"] << std::endl;
     std::cout << "Elapsed time: " << timer.elapsed() << std::endl;
   }
+  report_memory(comm, "time stepping");
 
   if (device_database.get<int>("dim") == 2)
   {
@@ -11,4 +11,12 @@ namespace cap
 {
 template class ElectrochemicalPhysics<2>;
 template class ElectrochemicalPhysics<3>;
+template double
+check_equipotential_collectors(PhysicsParameters<2> const &parameters,
+                               boost::mpi::communicator const &mpi_communicator,
+                               double const max_ratio);
+template double
+check_equipotential_collectors(PhysicsParameters<3> const &parameters,
+                               boost::mpi::communicator const &mpi_communicator,
+                               double const max_ratio);
 }
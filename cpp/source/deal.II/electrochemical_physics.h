@@ -57,15 +57,67 @@ public:
 
   ~ElectrochemicalPhysics();
 
+  /**
+   * Return the number of degrees of freedom constrained by
+   * make_inactive_dof_constraints().
+   */
+  unsigned int get_n_inactive_dofs() const { return _n_inactive_dofs; }
+
 private:
+  /**
+   * Constrain to zero the degrees of freedom that do not carry any physics,
+   * i.e. the degrees of freedom of a potential that are only supported on
+   * cells where the conductivity of its phase, the specific capacitance, and
+   * the faradaic reaction coefficient are all zero. For the usual materials,
+   * this is the solid potential inside the separator and the liquid
+   * potential inside the collectors. These degrees of freedom would be left
+   * decoupled from the rest of the system. Return their number.
+   */
+  unsigned int make_inactive_dof_constraints();
+
+  /**
+   * Replace each current collector by an equipotential region: the solid
+   * potential at the degrees of freedom of a collector, except the ones on
+   * the anode and the cathode, is constrained to be equal to the potential of
+   * a single degree of freedom of this collector. Return these degrees of
+   * freedom. The accuracy of the approximation is checked once, when the
+   * device is built, by check_equipotential_collectors().
+   */
+  std::vector<dealii::types::global_dof_index>
+  make_equipotential_collector_constraints();
+
   void assemble_system(std::shared_ptr<PhysicsParameters<dim> const> parameters,
                        bool const inhomogeneous_bc);
 
   unsigned int _solid_potential_component;
   unsigned int _liquid_potential_component;
+  unsigned int _n_inactive_dofs;
   Timer _assembly_timer;
   Timer _setup_timer;
 };
+
+/**
+ * Estimate, for each current collector, the ratio of the potential drop
+ * along the collector to the potential drop across the rest of the device
+ * when the same current flows through both. The collector is treated as a
+ * plate of length @f$L@f$ (the largest side of its bounding box) and volume
+ * @f$V_c@f$ that collects the current uniformly and drains it at one end,
+ * i.e. @f$R_c = L^2 / (2 \sigma_c V_c)@f$ with @f$\sigma_c@f$ the smallest
+ * conductivity in the collector. The rest of the device is treated as a slab
+ * of thickness @f$T@f$, measured along the smallest side of the bounding box
+ * of the collector, i.e. @f$R = T^2 \int 1/\sigma \, dV / V^2@f$ with
+ * @f$\sigma@f$ the sum of the solid and the liquid conductivities. Print the
+ * largest ratio if the verbosity is positive and throw if it exceeds @p
+ * max_ratio, in which case the collectors cannot be treated as equipotential
+ * regions.
+ *
+ * @p parameters must provide the MPValuesTable.
+ */
+template <int dim>
+double check_equipotential_collectors(
+    PhysicsParameters<dim> const &parameters,
+    boost::mpi::communicator const &mpi_communicator,
+    double const max_ratio = 1e-2);
 }
 
 #endif
@@ -11,10 +11,17 @@
 #include <cap/electrochemical_physics.h>
 #include <cap/types.h>
 #include <boost/assert.hpp>
+#include <boost/mpi/collectives.hpp>
 #include <deal.II/base/function.h>
 #include <deal.II/dofs/dof_tools.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/numerics/vector_tools.h>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <string>
 
 namespace cap
 {
@@ -24,6 +31,7 @@ ElectrochemicalPhysics<dim>::ElectrochemicalPhysics(
     boost::mpi::communicator mpi_communicator)
     : Physics<dim>(parameters, mpi_communicator),
       _solid_potential_component(-1), _liquid_potential_component(-1),
+      _n_inactive_dofs(0),
       _assembly_timer(mpi_communicator, "ElectrochemicalPhysics assembly"),
       _setup_timer(mpi_communicator, "ElectrochemicalPhysics setup")
 {
@@ -57,6 +65,31 @@ ElectrochemicalPhysics<dim>::ElectrochemicalPhysics(
   dealii::DoFTools::make_hanging_node_constraints(*(this->dof_handler),
                                                   this->constraint_matrix);
 
+  // The material properties are static. Evaluate them once unless they have
+  // been provided with the parameters.
+  if (!this->mp_values_table)
+  {
+    dealii::FiniteElement<dim> const &fe = this->dof_handler->get_fe();
+    this->mp_values_table = std::make_shared<MPValuesTable<dim>>(
+        *(this->mp_values),
+        std::vector<std::string>{
+            "specific_capacitance", "solid_electrical_conductivity",
+            "liquid_electrical_conductivity", "faradaic_reaction_coefficient"},
+        *(this->dof_handler), dealii::QGauss<dim>(fe.degree + 1));
+  }
+
+  // Take care of the degrees of freedom that have no physical meaning.
+  if (database.get("constrain_inactive_dofs", true))
+    _n_inactive_dofs = make_inactive_dof_constraints();
+
+  // The conductivity of the current collectors is several orders of magnitude
+  // larger than the conductivity of the electrodes. Optionally, consider them
+  // as equipotential regions: this removes their degrees of freedom from the
+  // system and improves its conditioning.
+  std::vector<dealii::types::global_dof_index> collector_dofs;
+  if (database.get("equipotential_collectors", false))
+    collector_dofs = make_equipotential_collector_constraints();
+
   // Take care of Dirichlet boundary condition.
   // The anode is always set in Earth (Dirichlet value of 0).
   // If we impose a the voltage, the cathode is also a Dirichlet condition.
@@ -88,10 +121,16 @@ ElectrochemicalPhysics<dim>::ElectrochemicalPhysics(
   // Finally close the ConstraintMatrix.
   this->constraint_matrix.close();
 
-  // Create sparsity pattern
-  this->sparsity_pattern.reinit(
-      this->locally_owned_dofs, this->locally_owned_dofs,
-      this->locally_relevant_dofs, this->mpi_communicator);
+  // Create sparsity pattern. The rows of the degrees of freedom that carry
+  // the potential of the collectors receive contributions from every
+  // processor that owns a part of the collector.
+  dealii::IndexSet writable_dofs(this->locally_relevant_dofs);
+  for (auto const dof : collector_dofs)
+    writable_dofs.add_index(dof);
+  writable_dofs.compress();
+  this->sparsity_pattern.reinit(this->locally_owned_dofs,
+                                this->locally_owned_dofs, writable_dofs,
+                                this->mpi_communicator);
   dealii::DoFTools::make_sparsity_pattern(
       *(this->dof_handler), this->sparsity_pattern, this->constraint_matrix,
       true, dealii::Utilities::MPI::this_mpi_process(this->mpi_communicator));
@@ -116,6 +155,216 @@ ElectrochemicalPhysics<dim>::~ElectrochemicalPhysics()
   }
 }
 
+template <int dim>
+unsigned int ElectrochemicalPhysics<dim>::make_inactive_dof_constraints()
+{
+  // A potential carries no physics on a cell where the conductivity of its
+  // phase is zero and where the two phases are not coupled, i.e. the specific
+  // capacitance and the faradaic reaction coefficient are zero too. With the
+  // usual materials, this is the solid potential in the separator and the
+  // liquid potential in the collectors.
+  MPValuesTable<dim> const &mp_values_table = *(this->mp_values_table);
+  unsigned int const n_q_points = mp_values_table.n_quadrature_points();
+  // clang-format off
+  unsigned int const specific_capacitance_handle           = mp_values_table.get_handle("specific_capacitance");
+  unsigned int const solid_electrical_conductivity_handle  = mp_values_table.get_handle("solid_electrical_conductivity");
+  unsigned int const liquid_electrical_conductivity_handle = mp_values_table.get_handle("liquid_electrical_conductivity");
+  unsigned int const faradaic_reaction_coefficient_handle  = mp_values_table.get_handle("faradaic_reaction_coefficient");
+  // clang-format on
+  auto vanishes = [&mp_values_table, n_q_points](unsigned int const handle,
+                                                 unsigned int const index)
+  {
+    double const *values = mp_values_table.get_values(handle, index);
+    return std::all_of(values, values + n_q_points, [](double const value)
+                       {
+                         return value == 0.;
+                       });
+  };
+
+  // Flag the degrees of freedom that are used by at least one cell where
+  // their component is meaningful. A cell can share degrees of freedom with
+  // cells owned by other processors so the flags are summed over all the
+  // processors and the ghost entries are imported afterwards.
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  unsigned int const dofs_per_cell = fe.dofs_per_cell;
+  std::vector<dealii::types::global_dof_index> local_dof_indices(
+      dofs_per_cell);
+  dealii::Vector<double> cell_active(dofs_per_cell);
+  dealii::Trilinos::MPI::Vector active(this->locally_owned_dofs,
+                                       this->mpi_communicator);
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+    {
+      unsigned int const index = cell->active_cell_index();
+      bool const uncoupled =
+          vanishes(specific_capacitance_handle, index) &&
+          vanishes(faradaic_reaction_coefficient_handle, index);
+      bool const solid_active =
+          !(uncoupled && vanishes(solid_electrical_conductivity_handle, index));
+      bool const liquid_active =
+          !(uncoupled &&
+            vanishes(liquid_electrical_conductivity_handle, index));
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+      {
+        unsigned int const component = fe.system_to_component_index(i).first;
+        bool const meaningful =
+            (component == this->_solid_potential_component)
+                ? solid_active
+                : ((component == this->_liquid_potential_component)
+                       ? liquid_active
+                       : true);
+        cell_active[i] = meaningful ? 1. : 0.;
+      }
+      cell->get_dof_indices(local_dof_indices);
+      active.add(local_dof_indices, cell_active);
+    }
+  active.compress(dealii::VectorOperation::add);
+  dealii::Trilinos::MPI::Vector relevant_active(this->locally_owned_dofs,
+                                                this->locally_relevant_dofs,
+                                                this->mpi_communicator);
+  relevant_active = active;
+
+  // A line without entries constrains the degree of freedom to zero.
+  unsigned int n_inactive_dofs = 0;
+  unsigned int const n_relevant_dofs = this->locally_relevant_dofs.n_elements();
+  for (unsigned int k = 0; k < n_relevant_dofs; ++k)
+  {
+    dealii::types::global_dof_index const dof =
+        this->locally_relevant_dofs.nth_index_in_set(k);
+    if ((relevant_active[dof] == 0.) &&
+        (!this->constraint_matrix.is_constrained(dof)))
+    {
+      this->constraint_matrix.add_line(dof);
+      if (this->locally_owned_dofs.is_element(dof))
+        ++n_inactive_dofs;
+    }
+  }
+
+  n_inactive_dofs =
+      dealii::Utilities::MPI::sum(n_inactive_dofs, this->mpi_communicator);
+  if ((this->verbose_lvl > 0) && (this->mpi_communicator.rank() == 0))
+    std::cout << "Inactive degrees of freedom: " << n_inactive_dofs
+              << std::endl;
+
+  return n_inactive_dofs;
+}
+
+template <int dim>
+std::vector<dealii::types::global_dof_index>
+ElectrochemicalPhysics<dim>::make_equipotential_collector_constraints()
+{
+  auto const &materials = *this->geometry->get_materials();
+  auto const collector = materials.find("collector");
+  if (collector == materials.end())
+    throw std::runtime_error("equipotential_collectors requires the material "
+                             "collector");
+  // Each material id of the collectors is an equipotential region.
+  std::vector<dealii::types::material_id> const collector_ids(
+      collector->second.begin(), collector->second.end());
+  unsigned int const n_collectors = collector_ids.size();
+
+  // The degrees of freedom on the anode and on the cathode are left free.
+  // Thus, the cells touching the cathode still belong to the collector and
+  // the current computed by the postprocessor is not affected.
+  auto boundaries = *this->geometry->get_boundaries();
+  std::set<dealii::types::boundary_id> tab_ids = boundaries["anode"];
+  tab_ids.insert(boundaries["cathode"].begin(), boundaries["cathode"].end());
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  std::vector<bool> mask(fe.n_components(), false);
+  mask[this->_solid_potential_component] = true;
+  dealii::IndexSet tab_dofs;
+  dealii::DoFTools::extract_boundary_dofs(
+      dof_handler, dealii::ComponentMask(mask), tab_dofs, tab_ids);
+
+  // Flag the solid potential degrees of freedom of each collector.
+  unsigned int const dofs_per_cell = fe.dofs_per_cell;
+  std::vector<dealii::types::global_dof_index> local_dof_indices(
+      dofs_per_cell);
+  dealii::Vector<double> cell_flags(dofs_per_cell);
+  for (unsigned int i = 0; i < dofs_per_cell; ++i)
+    cell_flags[i] = (fe.system_to_component_index(i).first ==
+                     this->_solid_potential_component)
+                        ? 1.
+                        : 0.;
+  std::vector<dealii::Trilinos::MPI::Vector> in_collector(
+      n_collectors, dealii::Trilinos::MPI::Vector(this->locally_owned_dofs,
+                                                  this->mpi_communicator));
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+    {
+      auto const id = std::find(collector_ids.begin(), collector_ids.end(),
+                                cell->material_id());
+      if (id == collector_ids.end())
+        continue;
+      cell->get_dof_indices(local_dof_indices);
+      in_collector[id - collector_ids.begin()].add(local_dof_indices,
+                                                   cell_flags);
+    }
+  for (auto &flags : in_collector)
+    flags.compress(dealii::VectorOperation::add);
+
+  // Assign the free degrees of freedom to their collector and choose the
+  // degree of freedom with the smallest index as the one that carries the
+  // potential of the collector.
+  dealii::Trilinos::MPI::Vector owned_collector(this->locally_owned_dofs,
+                                                this->mpi_communicator);
+  std::vector<dealii::types::global_dof_index> local_masters(
+      n_collectors, dealii::numbers::invalid_dof_index);
+  unsigned int const n_owned_dofs = this->locally_owned_dofs.n_elements();
+  for (unsigned int k = 0; k < n_owned_dofs; ++k)
+  {
+    dealii::types::global_dof_index const dof =
+        this->locally_owned_dofs.nth_index_in_set(k);
+    if (tab_dofs.is_element(dof) || this->constraint_matrix.is_constrained(dof))
+      continue;
+    for (unsigned int c = 0; c < n_collectors; ++c)
+      if (in_collector[c][dof] > 0.)
+      {
+        owned_collector[dof] = c + 1;
+        local_masters[c] = std::min(local_masters[c], dof);
+      }
+  }
+  owned_collector.compress(dealii::VectorOperation::insert);
+  std::vector<dealii::types::global_dof_index> masters(n_collectors);
+  boost::mpi::all_reduce(
+      this->mpi_communicator, local_masters.data(), n_collectors,
+      masters.data(), boost::mpi::minimum<dealii::types::global_dof_index>());
+  dealii::Trilinos::MPI::Vector relevant_collector(this->locally_owned_dofs,
+                                                   this->locally_relevant_dofs,
+                                                   this->mpi_communicator);
+  relevant_collector = owned_collector;
+
+  unsigned int n_condensed_dofs = 0;
+  unsigned int const n_relevant_dofs = this->locally_relevant_dofs.n_elements();
+  for (unsigned int k = 0; k < n_relevant_dofs; ++k)
+  {
+    dealii::types::global_dof_index const dof =
+        this->locally_relevant_dofs.nth_index_in_set(k);
+    unsigned int const c = static_cast<unsigned int>(relevant_collector[dof]);
+    if ((c == 0) || (dof == masters[c - 1]) ||
+        this->constraint_matrix.is_constrained(dof))
+      continue;
+    this->constraint_matrix.add_line(dof);
+    this->constraint_matrix.add_entry(dof, masters[c - 1], 1.);
+    if (this->locally_owned_dofs.is_element(dof))
+      ++n_condensed_dofs;
+  }
+
+  n_condensed_dofs =
+      dealii::Utilities::MPI::sum(n_condensed_dofs, this->mpi_communicator);
+  if ((this->verbose_lvl > 0) && (this->mpi_communicator.rank() == 0))
+    std::cout << "Equipotential collectors: " << n_condensed_dofs
+              << " degrees of freedom condensed" << std::endl;
+
+  masters.erase(std::remove(masters.begin(), masters.end(),
+                            dealii::numbers::invalid_dof_index),
+                masters.end());
+
+  return masters;
+}
+
 template <int dim>
 void ElectrochemicalPhysics<dim>::assemble_system(
     std::shared_ptr<PhysicsParameters<dim> const> parameters,
@@ -141,19 +390,29 @@ void ElectrochemicalPhysics<dim>::assemble_system(
       fe, quadrature_rule, dealii::update_values | dealii::update_gradients |
                                dealii::update_JxW_values |
                                dealii::update_quadrature_points);
+  Geometry<dim> const &geometry = *(this->geometry);
 
   unsigned int const dofs_per_cell = fe.dofs_per_cell;
   unsigned int const n_q_points = quadrature_rule.size();
+  std::vector<double> JxW(n_q_points);
   double const time_step = electrochemical_parameters->time_step;
   dealii::Vector<double> cell_rhs(dofs_per_cell);
   dealii::FullMatrix<double> cell_system_matrix(dofs_per_cell, dofs_per_cell);
   dealii::FullMatrix<double> cell_mass_matrix(dofs_per_cell, dofs_per_cell);
-  std::vector<double> solid_phase_diffusion_coefficient_values(n_q_points);
-  std::vector<double> liquid_phase_diffusion_coefficient_values(n_q_points);
-  std::vector<double> specific_capacitance_values(n_q_points);
-  std::vector<double> faradaic_reaction_coefficient_values(n_q_points);
   std::vector<dealii::types::global_dof_index> local_dof_indices(dofs_per_cell);
 
+  std::shared_ptr<MPValuesTable<dim> const> mp_values_table =
+      this->mp_values_table;
+  BOOST_ASSERT_MSG(mp_values_table->n_quadrature_points() == n_q_points,
+                   "The table of material properties does not match the "
+                   "quadrature rule");
+  // clang-format off
+  unsigned int const specific_capacitance_handle           = mp_values_table->get_handle("specific_capacitance");
+  unsigned int const solid_electrical_conductivity_handle  = mp_values_table->get_handle("solid_electrical_conductivity");
+  unsigned int const liquid_electrical_conductivity_handle = mp_values_table->get_handle("liquid_electrical_conductivity");
+  unsigned int const faradaic_reaction_coefficient_handle  = mp_values_table->get_handle("faradaic_reaction_coefficient");
+  // clang-format on
+
   this->system_matrix = 0.0;
   this->mass_matrix = 0.0;
   this->system_rhs = 0.0;
@@ -166,12 +425,16 @@ void ElectrochemicalPhysics<dim>::assemble_system(
       cell_mass_matrix = 0.0;
       cell_rhs = 0.0;
       fe_values.reinit(cell);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+        JxW[q] = fe_values.JxW(q) *
+                 geometry.get_measure_factor(fe_values.quadrature_point(q));
 
+      unsigned int const index = cell->active_cell_index();
       // clang-format off
-      (this->mp_values)->get_values("specific_capacitance",           fe_values, specific_capacitance_values);
-      (this->mp_values)->get_values("solid_electrical_conductivity",  fe_values, solid_phase_diffusion_coefficient_values);
-      (this->mp_values)->get_values("liquid_electrical_conductivity", fe_values, liquid_phase_diffusion_coefficient_values);
-      (this->mp_values)->get_values("faradaic_reaction_coefficient",  fe_values, faradaic_reaction_coefficient_values);
+      double const *specific_capacitance_values               = mp_values_table->get_values(specific_capacitance_handle,           index);
+      double const *solid_phase_diffusion_coefficient_values  = mp_values_table->get_values(solid_electrical_conductivity_handle,  index);
+      double const *liquid_phase_diffusion_coefficient_values = mp_values_table->get_values(liquid_electrical_conductivity_handle, index);
+      double const *faradaic_reaction_coefficient_values      = mp_values_table->get_values(faradaic_reaction_coefficient_handle,  index);
       // clang-format on
 
       // The coefficients are zeros when the physics does not make sense.
@@ -191,7 +454,7 @@ void ElectrochemicalPhysics<dim>::assemble_system(
                      fe_values[solid_potential].value(j, q) +
                  fe_values[liquid_potential].value(i, q) *
                      fe_values[liquid_potential].value(j, q)) *
-                fe_values.JxW(q);
+                JxW[q];
             cell_mass_matrix(i, j) += mass_matrix_val;
             cell_system_matrix(i, j) +=
                 mass_matrix_val +
@@ -212,7 +475,7 @@ void ElectrochemicalPhysics<dim>::assemble_system(
                            fe_values[liquid_potential].value(j, q)) +
                           (fe_values[liquid_potential].value(i, q) *
                            fe_values[liquid_potential].value(j, q)))) *
-                    fe_values.JxW(q);
+                    JxW[q];
           }
         }
 
@@ -258,7 +521,9 @@ void ElectrochemicalPhysics<dim>::assemble_system(
               for (unsigned int i = 0; i < dofs_per_cell; ++i)
                 cell_rhs[i] += time_step * current_density *
                                fe_face_values[solid_potential].value(i, q) *
-                               fe_face_values.JxW(q);
+                               fe_face_values.JxW(q) *
+                               geometry.get_measure_factor(
+                                   fe_face_values.quadrature_point(q));
           }
         }
         cell->get_dof_indices(local_dof_indices);
@@ -275,6 +540,145 @@ void ElectrochemicalPhysics<dim>::assemble_system(
 
   _assembly_timer.stop();
 }
+
+template <int dim>
+double check_equipotential_collectors(
+    PhysicsParameters<dim> const &parameters,
+    boost::mpi::communicator const &mpi_communicator, double const max_ratio)
+{
+  auto const &materials = *parameters.geometry->get_materials();
+  auto const collector = materials.find("collector");
+  if (collector == materials.end())
+    throw std::runtime_error("equipotential_collectors requires the material "
+                             "collector");
+  std::vector<dealii::types::material_id> const collector_ids(
+      collector->second.begin(), collector->second.end());
+  unsigned int const n_collectors = collector_ids.size();
+
+  dealii::DoFHandler<dim> const &dof_handler = *parameters.dof_handler;
+  dealii::QGauss<dim> quadrature_rule(dof_handler.get_fe().degree + 1);
+  dealii::FEValues<dim> fe_values(dof_handler.get_fe(), quadrature_rule,
+                                  dealii::update_JxW_values |
+                                      dealii::update_quadrature_points);
+  unsigned int const n_q_points = quadrature_rule.size();
+  MPValuesTable<dim> const &mp_values_table = *parameters.mp_values_table;
+  BOOST_ASSERT_MSG(mp_values_table.n_quadrature_points() == n_q_points,
+                   "The table of material properties does not match the "
+                   "quadrature rule");
+  // clang-format off
+  unsigned int const solid_electrical_conductivity_handle  = mp_values_table.get_handle("solid_electrical_conductivity");
+  unsigned int const liquid_electrical_conductivity_handle = mp_values_table.get_handle("liquid_electrical_conductivity");
+  // clang-format on
+
+  // Bounding box and volume of each collector and, in the last entry, of the
+  // rest of the device.
+  unsigned int const n_regions = n_collectors + 1;
+  std::vector<double> local_lower(n_regions * dim,
+                                  std::numeric_limits<double>::max());
+  std::vector<double> local_upper(n_regions * dim,
+                                  std::numeric_limits<double>::lowest());
+  std::vector<double> local_volume(n_regions, 0.);
+  std::vector<double> local_conductivity(n_collectors,
+                                         std::numeric_limits<double>::max());
+  double local_resistivity_integral = 0.;
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+    {
+      unsigned int const region =
+          std::find(collector_ids.begin(), collector_ids.end(),
+                    cell->material_id()) -
+          collector_ids.begin();
+      for (unsigned int v = 0; v < dealii::GeometryInfo<dim>::vertices_per_cell;
+           ++v)
+        for (unsigned int d = 0; d < dim; ++d)
+        {
+          local_lower[region * dim + d] =
+              std::min(local_lower[region * dim + d], cell->vertex(v)[d]);
+          local_upper[region * dim + d] =
+              std::max(local_upper[region * dim + d], cell->vertex(v)[d]);
+        }
+      fe_values.reinit(cell);
+      unsigned int const index = cell->active_cell_index();
+      double const *solid_conductivity_values = mp_values_table.get_values(
+          solid_electrical_conductivity_handle, index);
+      double const *liquid_conductivity_values = mp_values_table.get_values(
+          liquid_electrical_conductivity_handle, index);
+      for (unsigned int q = 0; q < n_q_points; ++q)
+      {
+        double const dV =
+            fe_values.JxW(q) * parameters.geometry->get_measure_factor(
+                                   fe_values.quadrature_point(q));
+        local_volume[region] += dV;
+        if (region < n_collectors)
+          local_conductivity[region] = std::min(local_conductivity[region],
+                                                solid_conductivity_values[q]);
+        else
+          local_resistivity_integral += dV / (solid_conductivity_values[q] +
+                                              liquid_conductivity_values[q]);
+      }
+    }
+  std::vector<double> lower(n_regions * dim);
+  std::vector<double> upper(n_regions * dim);
+  std::vector<double> volume(n_regions);
+  std::vector<double> conductivity(n_collectors);
+  boost::mpi::all_reduce(mpi_communicator, local_lower.data(),
+                         n_regions * dim, lower.data(),
+                         boost::mpi::minimum<double>());
+  boost::mpi::all_reduce(mpi_communicator, local_upper.data(),
+                         n_regions * dim, upper.data(),
+                         boost::mpi::maximum<double>());
+  boost::mpi::all_reduce(mpi_communicator, local_volume.data(), n_regions,
+                         volume.data(), std::plus<double>());
+  boost::mpi::all_reduce(mpi_communicator, local_conductivity.data(),
+                         n_collectors, conductivity.data(),
+                         boost::mpi::minimum<double>());
+  double const resistivity_integral = boost::mpi::all_reduce(
+      mpi_communicator, local_resistivity_integral, std::plus<double>());
+
+  double ratio = 0.;
+  unsigned int const device = n_collectors;
+  for (unsigned int c = 0; c < n_collectors; ++c)
+  {
+    // The current flows along the largest side of the collector and across
+    // the device along the smallest one.
+    unsigned int length_direction = 0;
+    unsigned int thickness_direction = 0;
+    for (unsigned int d = 1; d < dim; ++d)
+    {
+      double const extent = upper[c * dim + d] - lower[c * dim + d];
+      if (extent > upper[c * dim + length_direction] -
+                       lower[c * dim + length_direction])
+        length_direction = d;
+      if (extent < upper[c * dim + thickness_direction] -
+                       lower[c * dim + thickness_direction])
+        thickness_direction = d;
+    }
+    double const length =
+        upper[c * dim + length_direction] - lower[c * dim + length_direction];
+    double const thickness = upper[device * dim + thickness_direction] -
+                             lower[device * dim + thickness_direction];
+    double const collector_resistance =
+        length * length / (2. * conductivity[c] * volume[c]);
+    double const device_resistance = thickness * thickness *
+                                     resistivity_integral /
+                                     (volume[device] * volume[device]);
+    ratio = std::max(ratio, collector_resistance / device_resistance);
+  }
+
+  unsigned int const verbose_lvl = parameters.database.get("verbosity", 0);
+  if ((verbose_lvl > 0) && (mpi_communicator.rank() == 0))
+    std::cout << "Equipotential collectors: estimated potential drop in the "
+                 "collectors relative to the rest of the device "
+              << ratio << std::endl;
+  if (ratio > max_ratio)
+    throw std::runtime_error(
+        "equipotential_collectors is not accurate: the estimated potential "
+        "drop in the collectors is " +
+        std::to_string(ratio) +
+        " times the potential drop across the rest of the device");
+
+  return ratio;
+}
 }
 
 #endif
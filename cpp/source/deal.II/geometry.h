@@ -9,6 +9,8 @@
 #define CAP_GEOMETRY_H
 
 #include <cap/types.h>
+#include <deal.II/base/numbers.h>
+#include <deal.II/base/point.h>
 #include <deal.II/base/types.h>
 #include <deal.II/distributed/tria.h>
 #include <boost/mpi.hpp>
@@ -17,6 +19,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
+#include <string>
 
 namespace cap
 {
@@ -59,6 +62,30 @@ public:
     return _triangulation;
   }
 
+  /**
+   * Return the number of cells of the stack represented by the mesh. When
+   * the option @c unit_cell is set, only one cell of a stack with @c
+   * n_repetitions repetitions is meshed and the current must be multiplied by
+   * this number. Otherwise, return one.
+   */
+  unsigned int get_n_unit_cells() const { return _n_unit_cells; }
+
+  /**
+   * Return true if the mesh is the (r, z) plane of an axisymmetric geometry.
+   * The first coordinate is the distance to the axis.
+   */
+  bool is_axisymmetric() const { return _axisymmetric; }
+
+  /**
+   * Return the factor that converts the measure of the mesh at @p point into
+   * the measure of the physical geometry: 2 pi r when the geometry is
+   * axisymmetric and 1 otherwise. It multiplies JxW in all the integrals.
+   */
+  double get_measure_factor(dealii::Point<dim> const &point) const
+  {
+    return _axisymmetric ? 2. * dealii::numbers::PI * point[0] : 1.;
+  }
+
   boost::mpi::communicator get_mpi_communicator() const
   {
     return _communicator;
@@ -121,36 +148,51 @@ private:
       std::shared_ptr<boost::property_tree::ptree> database);
 
   /**
-   * Merge a triangulation that is repeated multiple times with the current
-   * triangulation.
+   * Create a mesh from a property tree.
    */
-  void merge_repetition(dealii::distributed::Triangulation<dim> &repetition,
-                        double offset);
+  void mesh_generator(boost::property_tree::ptree const &database);
 
   /**
-   * Compute the length of the triangulation along @dimension. Cells which have
-   * material_id in the set @excluded_materials are skipped.
+   * Set the boundary IDs on the cathode and the anode.
    */
-  double compute_length(
-      dealii::distributed::Triangulation<dim> const &triangulation,
-      unsigned int dimension,
-      std::unordered_set<dealii::types::material_id> const &excluded_materials);
+  void set_boundary_ids(double const collector_top,
+                        double const collector_bottom);
 
   /**
-   * Create a mesh from a property tree.
+   * Return the smallest value of the first coordinate of the vertices of the
+   * coarse mesh, i.e., the distance to the axis for an axisymmetric geometry.
    */
-  void mesh_generator(boost::property_tree::ptree const &database);
+  double compute_min_radius() const;
 
   /**
-   * Set the boundary IDs on the cathode and the anode.
+   * Helper function that serialize and save the geometry in @p filename. If
+   * @p cache is true, the number of unit cells is saved too.
    */
-  void set_boundary_ids(double const collector_top,
-                        double const collector_bottom);
+  void output_coarse_mesh(std::string const &filename,
+                          bool const cache = false);
+
+  /**
+   * Return the prefix of the files of the cache of the geometry @p database,
+   * or an empty string if the option @c cache_directory is not set. The name
+   * contains a hash of the database, of @p mesh_file_content, of the
+   * dimension, and of the number of processors so that the cache is never
+   * used when one of them changes.
+   */
+  std::string compute_cache_filename(
+      boost::property_tree::ptree const &database,
+      std::string const &mesh_file_content) const;
+
+  /**
+   * Load the coarse mesh, the material and boundary maps, and the refinement
+   * from the cache. Return false if the cache does not exist.
+   */
+  bool load_from_cache(boost::property_tree::ptree const &database);
 
   /**
-   * Helper function that serialize and save the geometry in @p filename.
+   * Save the refinement in the cache and make the coarse mesh, which was
+   * saved in a temporary file before the refinement, visible.
    */
-  void output_coarse_mesh(std::string const &filename);
+  void save_to_cache();
 
   boost::mpi::communicator _communicator;
   std::shared_ptr<dealii::distributed::Triangulation<dim>> _triangulation;
@@ -159,6 +201,10 @@ private:
   std::shared_ptr<std::unordered_map<
       std::string, std::set<dealii::types::boundary_id>>> _boundaries;
   std::unordered_map<std::string, unsigned int> _weights = {};
+  bool _axisymmetric = false;
+  unsigned int _n_unit_cells = 1;
+  std::string _cache_filename;
+  std::string _cache_tmp_filename;
 };
 } // end namespace cap
 
@@ -11,17 +11,30 @@
 #include <deal.II/grid/filtered_iterator.h>
 #include <deal.II/grid/grid_generator.h>
 #include <deal.II/grid/grid_in.h>
+#include <deal.II/grid/grid_reordering.h>
 #include <deal.II/grid/grid_tools.h>
+#include <deal.II/grid/tria.h>
 #include <deal.II/base/geometry_info.h>
+#include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include <boost/filesystem.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#include <boost/mpi/collectives.hpp>
+#include <boost/property_tree/info_parser.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/string.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/set.hpp>
+#include <boost/serialization/vector.hpp>
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <fstream>
+#include <iomanip>
 #include <limits>
+#include <numeric>
+#include <sstream>
 #include <tuple>
 
 namespace cap
@@ -61,7 +74,7 @@ void check_no_overlap(std::unordered_map<std::string, std::set<T>> &map)
 
 template <int dim>
 void build_general_cell(std::vector<dealii::Point<dim>> const vertices,
-                        dealii::distributed::Triangulation<dim> &tria)
+                        dealii::Triangulation<dim> &tria)
 {
   BOOST_ASSERT_MSG(vertices.size() == std::pow(2, dim),
                    "Wrong number of vertices.");
@@ -79,7 +92,7 @@ void build_general_cell(std::vector<dealii::Point<dim>> const vertices,
 }
 
 void build_trapezoid_1(dealii::Point<2> const &dimensions, double const edge,
-                       dealii::distributed::Triangulation<2> &tria)
+                       dealii::Triangulation<2> &tria)
 {
   std::vector<dealii::Point<2>> vertices(4);
   vertices[1][0] = dimensions[0];
@@ -91,13 +104,13 @@ void build_trapezoid_1(dealii::Point<2> const &dimensions, double const edge,
 }
 
 void build_trapezoid_1(dealii::Point<3> const &, double const,
-                       dealii::distributed::Triangulation<3> &)
+                       dealii::Triangulation<3> &)
 {
   throw std::runtime_error("Not implemented.");
 }
 
 void build_trapezoid_2(dealii::Point<2> const &dimensions, double const edge,
-                       dealii::distributed::Triangulation<2> &tria)
+                       dealii::Triangulation<2> &tria)
 {
   std::vector<dealii::Point<2>> vertices(4);
   vertices[1][0] = dimensions[0] + 2. * edge;
@@ -110,13 +123,13 @@ void build_trapezoid_2(dealii::Point<2> const &dimensions, double const edge,
 }
 
 void build_trapezoid_2(dealii::Point<3> const &, double const,
-                       dealii::distributed::Triangulation<3> &)
+                       dealii::Triangulation<3> &)
 {
   throw std::runtime_error("Not implemented.");
 }
 
 void build_trapezoid_3(dealii::Point<2> const &dimensions, double const edge,
-                       dealii::distributed::Triangulation<2> &tria)
+                       dealii::Triangulation<2> &tria)
 {
   std::vector<dealii::Point<2>> vertices(4);
   vertices[0][0] = edge;
@@ -129,7 +142,7 @@ void build_trapezoid_3(dealii::Point<2> const &dimensions, double const edge,
 }
 
 void build_trapezoid_3(dealii::Point<3> const &, double const,
-                       dealii::distributed::Triangulation<3> &)
+                       dealii::Triangulation<3> &)
 {
   throw std::runtime_error("Not implemented.");
 }
@@ -138,20 +151,17 @@ template <int dim>
 struct Component
 {
 public:
-  Component(MPI_Comm mpi_communicator)
-      : mpi_communicator(mpi_communicator), shape("hyper_rectangle"),
-        offset(0.), box_dimensions(0), divisions(0),
-        triangulation(mpi_communicator), shift_vector()
+  Component()
+      : shape("hyper_rectangle"), offset(0.), box_dimensions(0), divisions(0),
+        triangulation(), shift_vector()
   {
   }
 
   Component(std::string const &shape,
             std::vector<dealii::Point<dim>> const &box,
-            std::vector<unsigned int> const &divisions,
-            MPI_Comm mpi_communicator)
-      : mpi_communicator(mpi_communicator), shape(shape), offset(0.),
-        box_dimensions(box), divisions(divisions),
-        triangulation(mpi_communicator), shift_vector()
+            std::vector<unsigned int> const &divisions)
+      : shape(shape), offset(0.), box_dimensions(box), divisions(divisions),
+        triangulation(), shift_vector()
   {
   }
 
@@ -162,13 +172,14 @@ public:
   void build_triangulation();
 
   static double &hyper_L_side();
-  MPI_Comm mpi_communicator;
   std::string shape;
   double offset;
   std::vector<dealii::Point<dim>> box_dimensions;
   std::vector<unsigned int> divisions;
-  dealii::distributed::Triangulation<dim> triangulation;
-  // The last shift that has been applied to the component.
+  // The components are only built on the first processor so their
+  // triangulations are serial.
+  dealii::Triangulation<dim> triangulation;
+  // Shift of the component in addition to its position in the stack.
   dealii::Tensor<1, dim> shift_vector;
 };
 
@@ -278,43 +289,222 @@ void read_component_database(boost::property_tree::ptree const &database,
         box_dimensions[0], box_dimensions[1], box_dimensions[2]));
 }
 
+/**
+ * Append the cells of the coarse mesh of the components in @p chain to @p
+ * vertices and @p cells. The components are placed one after the other along
+ * the first coordinate, starting at @p start, and they are moved by their
+ * shift_vector. Return the length of the chain.
+ */
 template <int dim>
-void merge_components(Component<dim> &component, double const offset,
-                      dealii::distributed::Triangulation<dim> &triangulation)
-{
-  // Move the component by the necessary desired
-  component.shift_vector[0] = offset;
-  dealii::GridTools::shift(component.shift_vector, component.triangulation);
-  // Merge the component with the current triangulation
-  dealii::distributed::Triangulation<dim> tmp_triangulation(
-      triangulation.get_communicator());
-  dealii::GridGenerator::merge_triangulations(
-      triangulation, component.triangulation, tmp_triangulation);
-  triangulation.clear();
-  triangulation.copy_triangulation(tmp_triangulation);
-  // collector_c only needs to be shifted vertically the first time
-  if (component.shift_vector[dim - 1] != 0.)
-    component.shift_vector[dim - 1] = 0.;
-
-  // Move the component back to its initial position
-  component.shift_vector[0] = -offset;
-  dealii::GridTools::shift(component.shift_vector, component.triangulation);
+double append_chain(std::vector<Component<dim> const *> const &chain,
+                    double const start,
+                    std::vector<dealii::Point<dim>> &vertices,
+                    std::vector<dealii::CellData<dim>> &cells)
+{
+  BOOST_ASSERT_MSG(chain.size() != 0, "Number of components is zero.");
+  double min_pos = std::numeric_limits<double>::max();
+  double max_pos = std::numeric_limits<double>::lowest();
+  double position = start;
+  for (auto const component : chain)
+  {
+    dealii::Tensor<1, dim> shift = component->shift_vector;
+    shift[0] += position;
+    unsigned int const first_vertex = vertices.size();
+    for (auto const &vertex : component->triangulation.get_vertices())
+    {
+      vertices.push_back(vertex + shift);
+      min_pos = std::min(min_pos, vertices.back()[0]);
+      max_pos = std::max(max_pos, vertices.back()[0]);
+    }
+    for (auto cell : component->triangulation.cell_iterators_on_level(0))
+    {
+      dealii::CellData<dim> cell_data;
+      for (unsigned int i = 0; i < dealii::GeometryInfo<dim>::vertices_per_cell;
+           ++i)
+        cell_data.vertices[i] = first_vertex + cell->vertex_index(i);
+      cell_data.material_id = cell->material_id();
+      cells.push_back(cell_data);
+    }
+    position += component->offset;
+  }
+
+  return max_pos - min_pos;
 }
 
+/**
+ * Merge the vertices whose coordinates differ by less than @p tolerance and
+ * renumber the vertices of @p cells accordingly. This is equivalent to
+ * dealii::GridTools::delete_duplicated_vertices but the vertices are sorted
+ * along the first coordinate so that only the vertices in the same plane are
+ * compared, instead of all the pairs of vertices.
+ */
 template <int dim>
-void build_triangulation(
-    std::vector<internal::Component<dim> *> const &components,
-    dealii::distributed::Triangulation<dim> &triangulation)
+void merge_duplicated_vertices(std::vector<dealii::Point<dim>> &vertices,
+                               std::vector<dealii::CellData<dim>> &cells,
+                               double const tolerance = 1e-12)
+{
+  unsigned int const n_vertices = vertices.size();
+  std::vector<unsigned int> order(n_vertices);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&](unsigned int const i, unsigned int const j)
+            {
+              return vertices[i][0] < vertices[j][0];
+            });
+
+  unsigned int const invalid = dealii::numbers::invalid_unsigned_int;
+  std::vector<unsigned int> new_index(n_vertices, invalid);
+  std::vector<dealii::Point<dim>> unique_vertices;
+  unique_vertices.reserve(n_vertices);
+  for (unsigned int k = 0; k < n_vertices; ++k)
+  {
+    unsigned int const i = order[k];
+    if (new_index[i] != invalid)
+      continue;
+    new_index[i] = unique_vertices.size();
+    for (unsigned int l = k + 1;
+         (l < n_vertices) &&
+         (vertices[order[l]][0] - vertices[i][0] < tolerance);
+         ++l)
+    {
+      unsigned int const j = order[l];
+      bool duplicate = (new_index[j] == invalid);
+      for (unsigned int d = 0; d < dim; ++d)
+        duplicate = duplicate &&
+                    (std::abs(vertices[j][d] - vertices[i][d]) < tolerance);
+      if (duplicate)
+        new_index[j] = new_index[i];
+    }
+    unique_vertices.push_back(vertices[i]);
+  }
+
+  for (auto &cell : cells)
+    for (unsigned int i = 0; i < dealii::GeometryInfo<dim>::vertices_per_cell;
+         ++i)
+      cell.vertices[i] = new_index[cell.vertices[i]];
+  vertices.swap(unique_vertices);
+}
+
+/**
+ * Return the 64-bit FNV-1a hash of @p data. Unlike std::hash, the value does
+ * not depend on the implementation of the standard library so it can be used
+ * to name files that outlive the program.
+ */
+inline std::uint64_t compute_hash(std::string const &data)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char const c : data)
+  {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/**
+ * Read the file @p filename on the first processor. The content is returned on
+ * the first processor only but all the processors throw if the file cannot be
+ * opened.
+ */
+inline std::string read_on_first_processor(std::string const &filename,
+                                           boost::mpi::communicator const &comm)
+{
+  std::string content;
+  bool file_is_good = true;
+  if (comm.rank() == 0)
+  {
+    std::ifstream fin(filename, std::ios::binary);
+    file_is_good = fin.good();
+    if (file_is_good)
+    {
+      std::ostringstream buffer;
+      buffer << fin.rdbuf();
+      content = buffer.str();
+    }
+  }
+  boost::mpi::broadcast(comm, file_is_good, 0);
+  if (!file_is_good)
+    throw std::runtime_error("Cannot open the mesh file " + filename);
 
+  return content;
+}
+
+/**
+ * Read the file @p filename on the first processor and broadcast its content
+ * to the other processors so that the file system is accessed only once.
+ */
+inline std::string read_and_broadcast(std::string const &filename,
+                                      boost::mpi::communicator const &comm)
+{
+  std::string content = read_on_first_processor(filename, comm);
+  boost::mpi::broadcast(comm, content, 0);
+
+  return content;
+}
+
+/**
+ * Return a name that is unique to this run and identical on all the
+ * processors.
+ */
+inline std::string make_unique_name(boost::mpi::communicator const &comm)
+{
+  std::string name;
+  if (comm.rank() == 0)
+    name = boost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%").string();
+  boost::mpi::broadcast(comm, name, 0);
+
+  return name;
+}
+
+/**
+ * Broadcast the vertices and the cells of the coarse mesh built by the first
+ * processor to the other processors. Points and CellData are flattened into
+ * arrays of built-in types before the communication.
+ */
+template <int dim>
+void broadcast_coarse_mesh(boost::mpi::communicator const &comm,
+                           std::vector<dealii::Point<dim>> &vertices,
+                           std::vector<dealii::CellData<dim>> &cells)
 {
-  BOOST_ASSERT_MSG(components.size() != 0, "Number of components is zero.");
-  triangulation.clear();
-  triangulation.copy_triangulation(components[0]->triangulation);
-  double offset = components[0]->offset;
-  for (unsigned int i = 1; i < components.size(); ++i)
+  unsigned int const vertices_per_cell =
+      dealii::GeometryInfo<dim>::vertices_per_cell;
+  std::vector<double> coordinates;
+  std::vector<unsigned int> cell_vertices;
+  std::vector<unsigned int> material_ids;
+  if (comm.rank() == 0)
+  {
+    coordinates.reserve(dim * vertices.size());
+    for (auto const &vertex : vertices)
+      for (unsigned int d = 0; d < dim; ++d)
+        coordinates.push_back(vertex[d]);
+    cell_vertices.reserve(vertices_per_cell * cells.size());
+    material_ids.reserve(cells.size());
+    for (auto const &cell : cells)
+    {
+      cell_vertices.insert(cell_vertices.end(), cell.vertices,
+                           cell.vertices + vertices_per_cell);
+      material_ids.push_back(cell.material_id);
+    }
+  }
+  boost::mpi::broadcast(comm, coordinates, 0);
+  boost::mpi::broadcast(comm, cell_vertices, 0);
+  boost::mpi::broadcast(comm, material_ids, 0);
+
+  if (comm.rank() != 0)
   {
-    internal::merge_components(*components[i], offset, triangulation);
-    offset += components[i]->offset;
+    vertices.resize(coordinates.size() / dim);
+    for (unsigned int i = 0; i < vertices.size(); ++i)
+      for (unsigned int d = 0; d < dim; ++d)
+        vertices[i][d] = coordinates[dim * i + d];
+    cells.resize(material_ids.size());
+    for (unsigned int i = 0; i < cells.size(); ++i)
+    {
+      std::copy(cell_vertices.begin() + vertices_per_cell * i,
+                cell_vertices.begin() + vertices_per_cell * (i + 1),
+                cells[i].vertices);
+      cells[i].material_id = material_ids[i];
+    }
   }
 }
 }
@@ -327,45 +517,75 @@ Geometry<dim>::Geometry(std::shared_ptr<boost::property_tree::ptree> database,
 {
   _triangulation = std::make_shared<dealii::distributed::Triangulation<dim>>(
       mpi_communicator);
+  _axisymmetric = database->get("axisymmetric", false);
+  if (_axisymmetric && (dim != 2))
+    throw std::runtime_error("Only two-dimensional geometries can be "
+                             "axisymmetric");
   std::string mesh_type = database->get<std::string>("type");
   if (mesh_type.compare("restart") == 0)
   {
-    // Do nothing. The mesh will be loaded when the save function is called.
+    // The mesh will be loaded when the save function is called. Only the
+    // number of cells represented by a unit cell is needed.
+    if (database->get("unit_cell", false))
+      _n_unit_cells = database->get("n_repetitions", 1) + 1;
   }
   else
   {
+    // The coarse mesh, the maps, and the refinement are loaded from the cache
+    // when it is enabled and it contains this geometry. The mesh file is read
+    // once by the first processor: its content is part of the key of the
+    // cache and it is broadcast only if the cache is not used.
+    std::string mesh_file_content;
+    if (mesh_type.compare("file") == 0)
+      mesh_file_content = internal::read_on_first_processor(
+          database->get<std::string>("mesh_file"), _communicator);
+    _cache_filename = compute_cache_filename(*database, mesh_file_content);
+    // The files of the cache are first written with a name unique to this
+    // run so that concurrent runs never write to the same file.
+    if (!_cache_filename.empty())
+      _cache_tmp_filename =
+          _cache_filename + "." + internal::make_unique_name(_communicator);
+    bool cache_hit = false;
     if (mesh_type.compare("file") == 0)
     {
-      std::string mesh_file = database->get<std::string>("mesh_file");
-      dealii::GridIn<dim> mesh_reader;
-      mesh_reader.attach_triangulation(*_triangulation);
-      std::fstream fin;
-      fin.open(mesh_file.c_str(), std::fstream::in);
-      std::string const file_extension =
-          mesh_file.substr(mesh_file.find_last_of(".") + 1);
       fill_material_and_boundary_maps(database);
-      if (file_extension.compare("ucd") == 0)
+      cache_hit = load_from_cache(*database);
+      if (!cache_hit)
       {
-        mesh_reader.read_ucd(fin);
-      }
-      else if (file_extension.compare("inp") == 0)
-      {
-        mesh_reader.read_abaqus(fin);
-      }
-      else
-      {
-        throw std::runtime_error("Bad mesh file extension ." + file_extension +
-                                 " in mesh file " + mesh_file);
-      }
-      fin.close();
+        std::string mesh_file = database->get<std::string>("mesh_file");
+        dealii::GridIn<dim> mesh_reader;
+        mesh_reader.attach_triangulation(*_triangulation);
+        std::string const file_extension =
+            mesh_file.substr(mesh_file.find_last_of(".") + 1);
+        if ((file_extension.compare("ucd") != 0) &&
+            (file_extension.compare("inp") != 0))
+          throw std::runtime_error("Bad mesh file extension ." +
+                                   file_extension + " in mesh file " +
+                                   mesh_file);
+        // Only the first processor reads the file. The other processors parse
+        // the content that it broadcasts.
+        boost::mpi::broadcast(_communicator, mesh_file_content, 0);
+        std::istringstream fin(mesh_file_content);
+        if (file_extension.compare("ucd") == 0)
+          mesh_reader.read_ucd(fin);
+        else
+          mesh_reader.read_abaqus(fin);
 
-      // If we want to do checkpoint/restart, we need to start from the coarse
-      // mesh.
-      if (database->get("checkpoint", false))
-      {
-        std::string const filename =
-            database->get<std::string>("coarse_mesh_filename");
-        output_coarse_mesh(filename);
+        if (_axisymmetric && (compute_min_radius() < 0.))
+          throw std::runtime_error("The first coordinate of the mesh " +
+                                   mesh_file +
+                                   " is the radius and cannot be negative");
+
+        // If we want to do checkpoint/restart, we need to start from the
+        // coarse mesh.
+        if (database->get("checkpoint", false))
+        {
+          std::string const filename =
+              database->get<std::string>("coarse_mesh_filename");
+          output_coarse_mesh(filename);
+        }
+        if (!_cache_filename.empty())
+          output_coarse_mesh(_cache_tmp_filename + ".coarse_mesh", true);
       }
     }
     else
@@ -376,43 +596,48 @@ Geometry<dim>::Geometry(std::shared_ptr<boost::property_tree::ptree> database,
       {
         _weights.emplace(m, database->get(m + ".weight", 0));
       }
-      convert_geometry_database(database);
-
-      // If the mesh type is supercapacitor, we provide a default mesh
-      if (mesh_type.compare("supercapacitor") == 0)
+      cache_hit = load_from_cache(*database);
+      if (!cache_hit)
       {
-        if (dim == 2)
-        {
-          std::string collector_div("1,6");
-          std::string anode_div("10,5");
-          std::string separator_div("5,5");
-          std::string cathode_div("10,5");
-          database->put("collector.divisions", collector_div);
-          database->put("anode.divisions", anode_div);
-          database->put("separator.divisions", separator_div);
-          database->put("cathode.divisions", cathode_div);
-        }
-        else
+        convert_geometry_database(database);
+
+        // If the mesh type is supercapacitor, we provide a default mesh
+        if (mesh_type.compare("supercapacitor") == 0)
         {
-          std::string collector_div("4,4,3");
-          std::string anode_div("4,4,2");
-          std::string separator_div("4,4,2");
-          std::string cathode_div("4,4,2");
-          database->put("collector.divisions", collector_div);
-          database->put("anode.divisions", anode_div);
-          database->put("separator.divisions", separator_div);
-          database->put("cathode.divisions", cathode_div);
+          if (dim == 2)
+          {
+            std::string collector_div("1,6");
+            std::string anode_div("10,5");
+            std::string separator_div("5,5");
+            std::string cathode_div("10,5");
+            database->put("collector.divisions", collector_div);
+            database->put("anode.divisions", anode_div);
+            database->put("separator.divisions", separator_div);
+            database->put("cathode.divisions", cathode_div);
+          }
+          else
+          {
+            std::string collector_div("4,4,3");
+            std::string anode_div("4,4,2");
+            std::string separator_div("4,4,2");
+            std::string cathode_div("4,4,2");
+            database->put("collector.divisions", collector_div);
+            database->put("anode.divisions", anode_div);
+            database->put("separator.divisions", separator_div);
+            database->put("cathode.divisions", cathode_div);
+          }
+
+          database->put("n_repetitions", 0);
+          // By default ``n_refinements`` is one but the user is able to
+          // refine further the triangulation if he likes to.
+          unsigned int n_refinements = 1;
+          if (auto extra =
+                  database->get_optional<unsigned int>("n_refinements"))
+            n_refinements += extra.get();
+          database->put("n_refinements", n_refinements);
         }
-
-        database->put("n_repetitions", 0);
-        // By default ``n_refinements`` is one but the user is able to refine
-        // further the triangulation if he likes to.
-        unsigned int n_refinements = 1;
-        if (auto extra = database->get_optional<unsigned int>("n_refinements"))
-          n_refinements += extra.get();
-        database->put("n_refinements", n_refinements);
+        mesh_generator(*database);
       }
-      mesh_generator(*database);
     }
     // Material and boundary map have been filled at this point. Let us check
     // that they are valid input.
@@ -422,6 +647,9 @@ Geometry<dim>::Geometry(std::shared_ptr<boost::property_tree::ptree> database,
     // We need to do load balancing because cells in the collectors and the
     // separator don't have both physics.
     repartition();
+
+    if (!_cache_filename.empty() && !cache_hit)
+      save_to_cache();
   }
 }
 
@@ -584,161 +812,152 @@ void Geometry<dim>::convert_geometry_database(
   }
 }
 
-template <int dim>
-void Geometry<dim>::merge_repetition(
-    dealii::distributed::Triangulation<dim> &repetition, double offset)
-{
-  dealii::Tensor<1, dim> shift_vector;
-  shift_vector[0] = offset;
-  dealii::GridTools::shift(shift_vector, repetition);
-  dealii::distributed::Triangulation<dim> tmp_triangulation(
-      _triangulation->get_communicator());
-  dealii::GridGenerator::merge_triangulations(*_triangulation, repetition,
-                                              tmp_triangulation);
-  _triangulation->clear();
-  _triangulation->copy_triangulation(tmp_triangulation);
-}
-
-template <int dim>
-double Geometry<dim>::compute_length(
-    dealii::distributed::Triangulation<dim> const &triangulation,
-    unsigned int dimension,
-    std::unordered_set<dealii::types::material_id> const &excluded_materials)
-{
-  // Since we are working on the coarse mesh, all the processors have the same
-  // mesh and thus there is no need for a reduction or any other communication.
-  double min_pos = std::numeric_limits<double>::max();
-  double max_pos = std::numeric_limits<double>::lowest();
-  for (auto cell : triangulation.active_cell_iterators())
-  {
-    if (excluded_materials.count(cell->material_id()) == 0)
-    {
-      for (unsigned int i = 0; i < dealii::GeometryInfo<dim>::vertices_per_cell;
-           ++i)
-      {
-        dealii::Point<dim> vertex = cell->vertex(i);
-        if (vertex[dimension] > max_pos)
-          max_pos = vertex[dimension];
-        if (vertex[dimension] < min_pos)
-          min_pos = vertex[dimension];
-      }
-    }
-  }
-
-  return max_pos - min_pos;
-}
-
 template <int dim>
 void Geometry<dim>::mesh_generator(boost::property_tree::ptree const &database)
 {
   // Read the data needed for the collectors
-  internal::Component<dim> collector_a(_communicator);
+  internal::Component<dim> collector_a;
   boost::property_tree::ptree collector_database =
       database.get_child("collector");
   internal::read_component_database(collector_database, collector_a);
-  internal::Component<dim> collector_c(collector_a.shape,
-                                       collector_a.box_dimensions,
-                                       collector_a.divisions, _communicator);
+  internal::Component<dim> collector_c(
+      collector_a.shape, collector_a.box_dimensions, collector_a.divisions);
 
   // Read the data needed for the anode
-  internal::Component<dim> anode(_communicator);
+  internal::Component<dim> anode;
   boost::property_tree::ptree anode_database = database.get_child("anode");
   internal::read_component_database(anode_database, anode);
 
   // Read the data needed for the cathode
-  internal::Component<dim> cathode(_communicator);
+  internal::Component<dim> cathode;
   boost::property_tree::ptree cathode_database = database.get_child("cathode");
   internal::read_component_database(cathode_database, cathode);
 
   // Read the data needed for the separator
-  internal::Component<dim> separator(_communicator);
+  internal::Component<dim> separator;
   boost::property_tree::ptree separator_database =
       database.get_child("separator");
   internal::read_component_database(separator_database, separator);
 
-  // For now, we assume that the user does not create hanging nodes with the
-  // divisions
-  // Create the triangulation for the anode.
-  anode.build_triangulation();
-  for (auto cell : anode.triangulation.cell_iterators())
-    cell->set_material_id(*(*_materials)["anode"].begin());
-  // Create the triangulation for the cathode.
-  cathode.build_triangulation();
-  for (auto cell : cathode.triangulation.cell_iterators())
-    cell->set_material_id(*(*_materials)["cathode"].begin());
-  // Create the triangulation for the seperator.
-  separator.build_triangulation();
-  for (auto cell : separator.triangulation.cell_iterators())
-    cell->set_material_id(*(*_materials)["separator"].begin());
-
-  // Create the triangulation for first collector.
   double const anode_dim = anode.box_dimensions[1][dim - 1];
   double const collector_dim = collector_a.box_dimensions[1][dim - 1];
-  double const delta_collector = collector_dim / collector_a.divisions[dim - 1];
-  collector_a.build_triangulation();
-  for (auto cell : collector_a.triangulation.cell_iterators())
-    cell->set_material_id(*(*_materials)["collector"].begin());
-  double const scale_factor_a = anode_dim / (collector_dim - delta_collector);
-  std::function<dealii::Point<dim>(dealii::Point<dim> const &)> transform_a =
-      std::bind(&internal::transform_coll_a<dim>, std::placeholders::_1,
-                scale_factor_a, collector_a.box_dimensions[1][dim - 1]);
-  dealii::GridTools::transform(transform_a, collector_a.triangulation);
-
-  // Create the triangulation for the second collector. For now, we assume
-  // that collector_a and collector_c have the same mesh.
-  collector_c.build_triangulation();
-  for (auto cell : collector_c.triangulation.cell_iterators())
-    cell->set_material_id(*std::next((*_materials)["collector"].begin()));
-  double const scale_factor_c = anode_dim / (collector_dim - delta_collector);
-  std::function<dealii::Point<dim>(dealii::Point<dim> const &)> transform_c =
-      std::bind(&internal::transform_coll_c<dim>, std::placeholders::_1,
-                scale_factor_c, collector_c.box_dimensions[1][dim - 1],
-                collector_dim - anode_dim - scale_factor_c * delta_collector);
-  dealii::GridTools::transform(transform_c, collector_c.triangulation);
-  collector_c.shift_vector[dim - 1] = -(collector_dim - anode_dim);
-
-  std::vector<internal::Component<dim> *> components = {
-      &collector_a, &anode, &separator, &cathode, &collector_c};
-  internal::build_triangulation(components, *_triangulation);
 
+  // Each repetition adds one cell to the stack. Under a uniform load, all the
+  // cells behave identically so, with the option unit_cell, only the first
+  // one is meshed and the current is scaled by the number of cells.
   unsigned int const n_repetitions = database.get("n_repetitions", 1);
-  if (n_repetitions != 0)
-  {
-    dealii::distributed::Triangulation<dim> repetition_1(_communicator);
-    dealii::distributed::Triangulation<dim> repetition_2(_communicator);
-    std::vector<internal::Component<dim> *> repetition_1_components = {
-        &cathode, &separator, &anode, &collector_a};
-    std::vector<internal::Component<dim> *> repetition_2_components = {
-        &anode, &separator, &cathode, &collector_c};
-    internal::build_triangulation(repetition_1_components, repetition_1);
-    internal::build_triangulation(repetition_2_components, repetition_2);
-    unsigned int dimension = 0;
-    std::unordered_set<dealii::types::material_id> excluded_materials;
-    double offset =
-        compute_length(*_triangulation, dimension, excluded_materials);
-    double const length_repetition_1 =
-        compute_length(repetition_1, dimension, excluded_materials);
-    double const length_repetition_2 =
-        compute_length(repetition_2, dimension, excluded_materials);
-    for (unsigned int i = 0; i < n_repetitions; ++i)
+  bool const unit_cell = database.get("unit_cell", false);
+  if (unit_cell)
+    _n_unit_cells = n_repetitions + 1;
+
+  // The coarse mesh is built by the first processor only and it is broadcast
+  // to the other ones. If something goes wrong, the error is broadcast too so
+  // that all the processors throw.
+  std::vector<dealii::Point<dim>> vertices;
+  std::vector<dealii::CellData<dim>> cells;
+  std::string error_message;
+  if (_communicator.rank() == 0)
+  {
+    try
+    {
+      // For now, we assume that the user does not create hanging nodes with
+      // the divisions
+      // Create the triangulation for the anode.
+      anode.build_triangulation();
+      for (auto cell : anode.triangulation.cell_iterators())
+        cell->set_material_id(*(*_materials)["anode"].begin());
+      // Create the triangulation for the cathode.
+      cathode.build_triangulation();
+      for (auto cell : cathode.triangulation.cell_iterators())
+        cell->set_material_id(*(*_materials)["cathode"].begin());
+      // Create the triangulation for the seperator.
+      separator.build_triangulation();
+      for (auto cell : separator.triangulation.cell_iterators())
+        cell->set_material_id(*(*_materials)["separator"].begin());
+
+      // Create the triangulation for first collector.
+      double const delta_collector =
+          collector_dim / collector_a.divisions[dim - 1];
+      collector_a.build_triangulation();
+      for (auto cell : collector_a.triangulation.cell_iterators())
+        cell->set_material_id(*(*_materials)["collector"].begin());
+      double const scale_factor_a =
+          anode_dim / (collector_dim - delta_collector);
+      std::function<dealii::Point<dim>(dealii::Point<dim> const &)>
+          transform_a = std::bind(&internal::transform_coll_a<dim>,
+                                  std::placeholders::_1, scale_factor_a,
+                                  collector_a.box_dimensions[1][dim - 1]);
+      dealii::GridTools::transform(transform_a, collector_a.triangulation);
+
+      // Create the triangulation for the second collector. For now, we assume
+      // that collector_a and collector_c have the same mesh.
+      collector_c.build_triangulation();
+      for (auto cell : collector_c.triangulation.cell_iterators())
+        cell->set_material_id(*std::next((*_materials)["collector"].begin()));
+      double const scale_factor_c =
+          anode_dim / (collector_dim - delta_collector);
+      std::function<dealii::Point<dim>(dealii::Point<dim> const &)>
+          transform_c = std::bind(
+              &internal::transform_coll_c<dim>, std::placeholders::_1,
+              scale_factor_c, collector_c.box_dimensions[1][dim - 1],
+              collector_dim - anode_dim - scale_factor_c * delta_collector);
+      dealii::GridTools::transform(transform_c, collector_c.triangulation);
+      collector_c.shift_vector[dim - 1] = -(collector_dim - anode_dim);
+
+      // Gather the vertices and the cells of the whole stack and create the
+      // triangulation once. Merging the components one by one would copy the
+      // triangulation for each of them.
+      std::vector<internal::Component<dim> const *> const components = {
+          &collector_a, &anode, &separator, &cathode, &collector_c};
+      double position =
+          internal::append_chain(components, 0., vertices, cells);
+
+      if (!unit_cell)
+      {
+        // The repetitions alternate between the two orientations of the cell.
+        std::array<std::vector<internal::Component<dim> const *>, 2> const
+            repetition_components = {
+                {{&cathode, &separator, &anode, &collector_a},
+                 {&anode, &separator, &cathode, &collector_c}}};
+        for (unsigned int i = 0; i < n_repetitions; ++i)
+          position += internal::append_chain(repetition_components[i % 2],
+                                             position, vertices, cells);
+      }
+
+      internal::merge_duplicated_vertices(vertices, cells);
+      dealii::GridReordering<dim>::reorder_cells(cells, true);
+    }
+    catch (std::exception const &exception)
     {
-      if ((i % 2) == 0)
-        merge_repetition(repetition_1, offset);
-      else
-        merge_repetition(repetition_2, offset);
-
-      if (i == 0)
-        offset += length_repetition_1;
-      else
-        offset = length_repetition_1 + length_repetition_2;
+      error_message = exception.what();
+      if (error_message.empty())
+        error_message = "Construction of the coarse mesh failed.";
     }
   }
+  boost::mpi::broadcast(_communicator, error_message, 0);
+  if (!error_message.empty())
+    throw std::runtime_error(error_message);
+
+  internal::broadcast_coarse_mesh(_communicator, vertices, cells);
+  _triangulation->create_triangulation(vertices, cells, dealii::SubCellData());
 
-  // Apply boundary conditions. This needs to be done after the merging
-  // because the merging loses the boundary id
+  // Apply boundary conditions. This needs to be done after the
+  // triangulation is created because the cells do not carry boundary ids
   set_boundary_ids(collector_a.box_dimensions[1][dim - 1],
                    -(collector_dim - anode_dim));
 
+  // For an axisymmetric geometry, the sandwich is stacked along the radius
+  // (wound cell). Move it so that its inner face is at inner_radius [cm] from
+  // the axis.
+  if (_axisymmetric)
+  {
+    double const cm_to_m = 0.01;
+    dealii::Tensor<1, dim> shift_vector;
+    shift_vector[0] = database.get<double>("inner_radius") * cm_to_m -
+                      compute_min_radius();
+    dealii::GridTools::shift(shift_vector, *_triangulation);
+  }
+
   // If we want to do checkpoint/restart, we need to start from the coarse
   // mesh.
   if (database.get("checkpoint", false))
@@ -747,6 +966,8 @@ void Geometry<dim>::mesh_generator(boost::property_tree::ptree const &database)
         database.get<std::string>("coarse_mesh_filename");
     output_coarse_mesh(filename);
   }
+  if (!_cache_filename.empty())
+    output_coarse_mesh(_cache_tmp_filename + ".coarse_mesh", true);
 
   // Apply global refinement
   unsigned int const n_refinements =
@@ -818,7 +1039,21 @@ void Geometry<dim>::set_boundary_ids(double const collector_top,
 }
 
 template <int dim>
-void Geometry<dim>::output_coarse_mesh(std::string const &filename)
+double Geometry<dim>::compute_min_radius() const
+{
+  // The coarse mesh is the same on all the processors.
+  double min_radius = std::numeric_limits<double>::max();
+  for (auto cell : _triangulation->cell_iterators_on_level(0))
+    for (unsigned int i = 0; i < dealii::GeometryInfo<dim>::vertices_per_cell;
+         ++i)
+      min_radius = std::min(min_radius, cell->vertex(i)[0]);
+
+  return min_radius;
+}
+
+template <int dim>
+void Geometry<dim>::output_coarse_mesh(std::string const &filename,
+                                       bool const cache)
 {
   if (_communicator.rank() == 0)
   {
@@ -841,6 +1076,115 @@ void Geometry<dim>::output_coarse_mesh(std::string const &filename)
     // Save _materials and _boundaries.
     oa << _materials;
     oa << _boundaries;
+
+    // The number of unit cells is only part of the format of the cache.
+    if (cache)
+      oa << _n_unit_cells;
+  }
+}
+
+template <int dim>
+std::string Geometry<dim>::compute_cache_filename(
+    boost::property_tree::ptree const &database,
+    std::string const &mesh_file_content) const
+{
+  std::string const cache_directory = database.get("cache_directory", "");
+  if (cache_directory.empty())
+    return cache_directory;
+
+  std::string cache_filename;
+  if (_communicator.rank() == 0)
+  {
+    // The options that only control the output do not change the mesh.
+    boost::property_tree::ptree key_database = database;
+    for (std::string const &option :
+         {"cache_directory", "checkpoint", "coarse_mesh_filename"})
+      key_database.erase(option);
+    std::ostringstream key;
+    boost::property_tree::info_parser::write_info(key, key_database);
+    key << "dim " << dim << "\n"
+        << "n_processors " << _communicator.size() << "\n";
+    // The cache of a mesh file is invalid if the file has been modified.
+    key << mesh_file_content;
+
+    std::ostringstream hash;
+    hash << std::hex << std::setw(16) << std::setfill('0')
+         << internal::compute_hash(key.str());
+    boost::filesystem::create_directories(cache_directory);
+    cache_filename =
+        (boost::filesystem::path(cache_directory) / ("geometry_" + hash.str()))
+            .string();
+  }
+  boost::mpi::broadcast(_communicator, cache_filename, 0);
+
+  return cache_filename;
+}
+
+template <int dim>
+bool Geometry<dim>::load_from_cache(boost::property_tree::ptree const &database)
+{
+  if (_cache_filename.empty())
+    return false;
+
+  // The coarse mesh is renamed after the refinement, so the cache is complete
+  // if it exists.
+  std::string const coarse_mesh_filename = _cache_filename + ".coarse_mesh";
+  bool cache_hit = false;
+  if (_communicator.rank() == 0)
+    cache_hit = boost::filesystem::exists(coarse_mesh_filename);
+  boost::mpi::broadcast(_communicator, cache_hit, 0);
+  if (!cache_hit)
+    return false;
+
+  // Load the coarse mesh. As in SuperCapacitor::load, it is deserialized in a
+  // dealii::Triangulation and copied in the distributed triangulation.
+  namespace boost_io = boost::iostreams;
+  std::istringstream is(
+      internal::read_and_broadcast(coarse_mesh_filename, _communicator));
+  boost_io::filtering_streambuf<boost_io::input> compressed_in;
+  compressed_in.push(boost_io::zlib_decompressor());
+  compressed_in.push(is);
+  boost::archive::binary_iarchive ia(compressed_in);
+  dealii::Triangulation<dim> coarse_triangulation;
+  ia >> coarse_triangulation;
+  ia >> _materials;
+  ia >> _boundaries;
+  ia >> _n_unit_cells;
+  _triangulation->copy_triangulation(coarse_triangulation);
+
+  if (database.get("checkpoint", false))
+  {
+    std::string const filename =
+        database.get<std::string>("coarse_mesh_filename");
+    output_coarse_mesh(filename);
+  }
+
+  // Load the refinement
+  _triangulation->load((_cache_filename + ".refinement").c_str());
+
+  return true;
+}
+
+template <int dim>
+void Geometry<dim>::save_to_cache()
+{
+  // The files written by this run are renamed in the cache. A rename is
+  // atomic so another run never reads a partially written file and, since
+  // runs with the same key write the same content, it does not matter which
+  // run renames last. The coarse mesh is renamed last because its existence
+  // marks the cache as complete.
+  _triangulation->save((_cache_tmp_filename + ".refinement").c_str());
+  _communicator.barrier();
+  if (_communicator.rank() == 0)
+  {
+    // dealii::distributed::Triangulation::save writes the forest and an .info
+    // file that is read back first by load.
+    for (std::string const &extension : {"", ".info"})
+      boost::filesystem::rename(
+          _cache_tmp_filename + ".refinement" + extension,
+          _cache_filename + ".refinement" + extension);
+    boost::filesystem::rename(_cache_tmp_filename + ".coarse_mesh",
+                              _cache_filename + ".coarse_mesh");
   }
 }
 
@@ -31,5 +31,7 @@ template class UniformConstantMPValues<2>;
 template class UniformConstantMPValues<3>;
 template class FunctionSpaceMPValues<2>;
 template class FunctionSpaceMPValues<3>;
+template class MPValuesTable<2>;
+template class MPValuesTable<3>;
 
 } // end samespace cap
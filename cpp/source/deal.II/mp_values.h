@@ -10,6 +10,7 @@
 
 #include <cap/geometry.h>
 #include <deal.II/grid/cell_id.h>
+#include <deal.II/dofs/dof_handler.h>
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/base/function.h>
 #include <boost/property_tree/ptree.hpp>
@@ -42,8 +43,14 @@ public:
 
   virtual ~MPValues() = default;
 
+  /**
+   * Fill @p values with the property @p key at the quadrature points of @p
+   * fe_values. @p fe_values is either a dealii::FEValues or a
+   * dealii::FEFaceValues; the size of @p values must match its number of
+   * quadrature points.
+   */
   virtual void get_values(std::string const &key,
-                          dealii::FEValues<dim> const &fe_values,
+                          dealii::FEValuesBase<dim> const &fe_values,
                           std::vector<double> &values) const = 0;
 };
 
@@ -54,7 +61,7 @@ public:
   CompositeMat() = default;
 
   void get_values(std::string const &key,
-                  dealii::FEValues<dim> const &fe_values,
+                  dealii::FEValuesBase<dim> const &fe_values,
                   std::vector<double> &values) const override;
 
 protected:
@@ -69,7 +76,7 @@ public:
   CompositePro() = default;
 
   void get_values(std::string const &key,
-                  dealii::FEValues<dim> const &fe_values,
+                  dealii::FEValuesBase<dim> const &fe_values,
                   std::vector<double> &values) const override;
 
 protected:
@@ -84,7 +91,7 @@ public:
   UniformConstantMPValues(double const &val);
 
   void get_values(std::string const &key,
-                  dealii::FEValues<dim> const &fe_values,
+                  dealii::FEValuesBase<dim> const &fe_values,
                   std::vector<double> &values) const override;
 
 protected:
@@ -107,7 +114,7 @@ public:
     dealii::update_quadrature_points.
   */
   void get_values(std::string const &key,
-                  dealii::FEValues<dim> const &fe_values,
+                  dealii::FEValuesBase<dim> const &fe_values,
                   std::vector<double> &values) const override;
 
 private:
@@ -136,11 +143,17 @@ public:
   InhomogeneousSuperCapacitorMPValues(MPValuesParameters<dim> const &params);
 
   void get_values(std::string const &key,
-                  dealii::FEValues<dim> const &fe_values,
+                  dealii::FEValuesBase<dim> const &fe_values,
                   std::vector<double> &values) const override;
 
 protected:
-  std::map<dealii::CellId, std::shared_ptr<MPValues<dim>>> _map = {};
+  std::map<dealii::types::material_id, std::string> _material_names = {};
+  // _values[key][active_cell_index] is the value of the property key in the
+  // cell.
+  std::unordered_map<std::string, std::vector<double>> _values = {};
+  std::vector<bool> _locally_owned = {};
+  std::unordered_map<std::string, std::shared_ptr<MPValues<dim>>>
+      _custom_liquid_electrical_conductivity = {};
 };
 
 template <int dim>
@@ -159,6 +172,47 @@ public:
                     MPValuesParameters<dim> const &params);
 };
 
+/**
+ * Table of material properties evaluated once at the quadrature points of the
+ * locally owned cells. Each property is stored in its own contiguous array
+ * indexed by the active cell index. The properties are referred to by an
+ * integer handle obtained with get_handle() before looping over the cells so
+ * that the string lookups and the virtual calls of MPValues::get_values() are
+ * not repeated every time the system is assembled.
+ */
+template <int dim>
+class MPValuesTable
+{
+public:
+  MPValuesTable(MPValues<dim> const &mp_values,
+                std::vector<std::string> const &keys,
+                dealii::DoFHandler<dim> const &dof_handler,
+                dealii::Quadrature<dim> const &quadrature);
+
+  /**
+   * Return the handle of the property @p key. Throw an exception if the
+   * property was not evaluated.
+   */
+  unsigned int get_handle(std::string const &key) const;
+
+  unsigned int n_quadrature_points() const { return _n_q_points; }
+
+  /**
+   * Return a pointer to the values of the property @p handle at the
+   * quadrature points of the cell @p active_cell_index.
+   */
+  double const *get_values(unsigned int const handle,
+                           unsigned int const active_cell_index) const
+  {
+    return _values[handle].data() + active_cell_index * _n_q_points;
+  }
+
+private:
+  std::vector<std::string> _keys;
+  unsigned int _n_q_points;
+  std::vector<std::vector<double>> _values;
+};
+
 } // end namespace cap
 
 #endif // CAP_MP_VALUES_H
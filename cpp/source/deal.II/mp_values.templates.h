@@ -6,9 +6,14 @@
  */
 
 #include <cap/mp_values.h>
+#include <cap/material_properties.h>
 #include <cap/utils.h>
 #include <deal.II/base/function_parser.h>
-#include <random>
+#include <deal.II/base/parallel.h>
+#include <boost/math/constants/constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <tuple>
 #include <stdexcept>
 
@@ -17,9 +22,9 @@ namespace cap
 
 //////////////////////// COMPOSITE MAT /////////////////////////////////////////
 template <int dim>
-void CompositeMat<dim>::get_values(std::string const &key,
-                                   dealii::FEValues<dim> const &fe_values,
-                                   std::vector<double> &values) const
+void CompositeMat<dim>::get_values(
+    std::string const &key, dealii::FEValuesBase<dim> const &fe_values,
+    std::vector<double> &values) const
 
 {
   auto cell = fe_values.get_cell();
@@ -34,9 +39,9 @@ void CompositeMat<dim>::get_values(std::string const &key,
 
 //////////////////////// COMPOSITE PRO /////////////////////////////////////////
 template <int dim>
-void CompositePro<dim>::get_values(std::string const &key,
-                                   dealii::FEValues<dim> const &fe_values,
-                                   std::vector<double> &values) const
+void CompositePro<dim>::get_values(
+    std::string const &key, dealii::FEValuesBase<dim> const &fe_values,
+    std::vector<double> &values) const
 {
   auto got = _properties.find(key);
   if (got == _properties.end())
@@ -54,12 +59,12 @@ UniformConstantMPValues<dim>::UniformConstantMPValues(double const &val)
 
 template <int dim>
 void UniformConstantMPValues<dim>::get_values(
-    std::string const &key, dealii::FEValues<dim> const &fe_values,
+    std::string const &key, dealii::FEValuesBase<dim> const &fe_values,
     std::vector<double> &values) const
 {
   std::ignore = key;
   std::ignore = fe_values;
-  BOOST_ASSERT_MSG(fe_values.get_quadrature().size() == values.size(),
+  BOOST_ASSERT_MSG(fe_values.n_quadrature_points == values.size(),
                    "values must be the same size as the quadrature rule"
                    "in MPValues::get_values()");
   std::fill(values.begin(), values.end(), _val);
@@ -68,8 +73,59 @@ void UniformConstantMPValues<dim>::get_values(
 //////////////////////// SUPERCAPACITOR ////////////////////////////////////////
 namespace internal
 {
+// Counter-based random number generator. The numbers only depend on the key
+// and on how many numbers have been drawn, so that the parameters of a cell
+// do not depend on the order in which the cells are visited nor on the
+// partition of the mesh.
+class CounterBasedGenerator
+{
+public:
+  CounterBasedGenerator(std::uint64_t const key) : _key(key), _counter(0) {}
+
+  // Return a number uniformly distributed in (0, 1).
+  double operator()()
+  {
+    std::uint64_t const x = mix(_key ^ mix(++_counter));
+    return (static_cast<double>(x >> 11) + 0.5) / 9007199254740992.0;
+  }
+
+  // SplitMix64 finalizer
+  static std::uint64_t mix(std::uint64_t x)
+  {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  // FNV-1a hash, unlike std::hash it is the same on every platform
+  static std::uint64_t hash(std::string const &str)
+  {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (char const c : str)
+    {
+      h ^= static_cast<unsigned char>(c);
+      h *= 0x100000001b3ULL;
+    }
+    return h;
+  }
+
+private:
+  std::uint64_t _key;
+  std::uint64_t _counter;
+};
+
+double normal_deviate(CounterBasedGenerator &generator)
+{
+  // Box-Muller transform
+  double const u = generator();
+  double const v = generator();
+  return std::sqrt(-2.0 * std::log(u)) *
+         std::cos(2.0 * boost::math::constants::pi<double>() * v);
+}
+
 // helper function to build parameter distributions
-std::function<double(std::default_random_engine &)>
+std::function<double(CounterBasedGenerator &)>
 build_parameter(boost::property_tree::ptree const &parameter_database)
 {
   auto const distribution_type =
@@ -80,13 +136,11 @@ build_parameter(boost::property_tree::ptree const &parameter_database)
         to_vector<double>(parameter_database.get<std::string>("range"));
     BOOST_ASSERT_MSG(range.size() == 2,
                      "Invalid range for constructing an uniform distribution");
-    std::uniform_real_distribution<double> distribution(range[0], range[1]);
-    // ``mutable`` is required to allow the body to modify the distribution
-    // because the operator() is non-const.
-    return
-        [distribution](std::default_random_engine &generator) mutable -> double
+    double const a = range[0];
+    double const b = range[1];
+    return [a, b](CounterBasedGenerator &generator)
     {
-      return distribution(generator);
+      return a + (b - a) * generator();
     };
   }
   else if (distribution_type.compare("normal") == 0)
@@ -94,26 +148,18 @@ build_parameter(boost::property_tree::ptree const &parameter_database)
     auto const mean = parameter_database.get<double>("mean");
     auto const standard_deviation =
         parameter_database.get<double>("standard_deviation");
-    std::normal_distribution<double> distribution(mean, standard_deviation);
-    // ``mutable`` is required to allow the body to modify the distribution
-    // because the operator() is non-const.
-    return
-        [distribution](std::default_random_engine &generator) mutable -> double
+    return [mean, standard_deviation](CounterBasedGenerator &generator)
     {
-      return distribution(generator);
+      return mean + standard_deviation * normal_deviate(generator);
     };
   }
   else if (distribution_type.compare("lognormal") == 0)
   {
     auto const location = parameter_database.get<double>("location");
     auto const scale = parameter_database.get<double>("scale");
-    std::lognormal_distribution<double> distribution(location, scale);
-    // ``mutable`` is required to allow the body to modify the distribution
-    // because the operator() is non-const.
-    return
-        [distribution](std::default_random_engine &generator) mutable -> double
+    return [location, scale](CounterBasedGenerator &generator)
     {
-      return distribution(generator);
+      return std::exp(location + scale * normal_deviate(generator));
     };
   }
   else
@@ -138,22 +184,11 @@ build_material_properties(std::string const &material_name,
   }
   else if (type.compare("permeable_membrane") == 0)
   {
-    std::string const matrix_phase =
-        database.get<std::string>(material_name + "." + "matrix_phase");
     // There is no separate class for a permeable membrane, we just reuse the
-    // porous electrode one but it expects parameters that do not make sense for
-    // the separator. We make a copy of the original ptree and add the missing
-    // parameters that are required for the electrode.
-    auto dummy_database =
-        std::make_shared<boost::property_tree::ptree>(*params.database);
-    dummy_database->put(matrix_phase + "." + "differential_capacitance", 0.0);
-    dummy_database->put(matrix_phase + "." + "exchange_current_density", 0.0);
-    dummy_database->put(matrix_phase + "." + "electrical_resistivity",
-                        std::numeric_limits<double>::max());
-    MPValuesParameters<dim> dummy_params = params;
-    dummy_params.database = dummy_database;
+    // porous electrode one. compute_material_properties(...) knows that the
+    // matrix phase of the membrane is inert.
     return std::make_unique<PorousElectrodeMPValues<dim>>(material_name,
-                                                          dummy_params);
+                                                          params);
   }
   else if (type.compare("current_collector") == 0)
   {
@@ -192,10 +227,11 @@ InhomogeneousSuperCapacitorMPValues<dim>::InhomogeneousSuperCapacitorMPValues(
   auto const parameters = database.get<int>("parameters");
   // Build a map material_id -> parameters
   // TODO: For simplicity let's perturb all parameters for now
-  // The map is only a map parameter path in the ptree -> object that emulates
-  // the std random distribution (i.e. takes a generator object as argument and
+  // The map is only a map parameter path in the ptree -> object that draws a
+  // value from the distribution (i.e. takes a generator object as argument and
   // returns a double)
-  std::map<std::string, std::function<double(std::default_random_engine &)>>
+  std::map<std::string,
+           std::function<double(internal::CounterBasedGenerator &)>>
       parameter_map;
   for (int p = 0; p < parameters; ++p)
   {
@@ -212,44 +248,92 @@ InhomogeneousSuperCapacitorMPValues<dim>::InhomogeneousSuperCapacitorMPValues(
       throw std::runtime_error("Parameter " + parameter_path +
                                "  is present multiple times");
   }
-  // Make a copy of the material database so that the original database is not
-  // changed.
-  auto perturbed_database =
-      std::make_shared<boost::property_tree::ptree>(*params.database);
-  MPValuesParameters<dim> perturbed_params = params;
-  perturbed_params.database = perturbed_database;
-  // Traverse the triangulation and build material properties with perturbed
-  // parameters in each cell.
-  // Construct a random number generator and use the MPI rank as a seed.
-  std::default_random_engine generator(
-      params.geometry->get_mpi_communicator().rank());
-  auto const &triangulation = *params.geometry->get_triangulation();
+  // The custom liquid electrical conductivity is not perturbed.
+  for (auto const &m : material_map)
+  {
+    auto const matrix_phase =
+        database.get_optional<std::string>(m.second + ".matrix_phase");
+    if (!matrix_phase)
+      continue;
+    auto custom = database.get_child(*matrix_phase).get_child_optional(
+        "custom_liquid_electrical_conductivity");
+    if (custom)
+      _custom_liquid_electrical_conductivity[m.second] =
+          std::make_shared<FunctionSpaceMPValues<dim>>(*custom);
+  }
 
+  // Traverse the triangulation and compute the material properties with
+  // perturbed parameters in each cell. The values are stored by active cell
+  // index, one array per property.
+  auto const &triangulation = *params.geometry->get_triangulation();
+  std::vector<typename dealii::Triangulation<dim>::active_cell_iterator>
+      locally_owned_cells;
   for (auto cell : triangulation.active_cell_iterators())
-  {
     if (cell->is_locally_owned())
-    {
-      // Perturb the parameters in the copy of the database
-      for (auto const &x : parameter_map)
-        perturbed_database->put(x.first, x.second(generator));
-      _map.emplace(cell->id(),
-                   internal::build_material_properties(
-                       material_map[cell->material_id()], perturbed_params));
-    }
-  }
+      locally_owned_cells.push_back(cell);
+  unsigned int const n_active_cells = triangulation.n_active_cells();
+  for (auto const &m : material_map)
+    for (auto const &property :
+         compute_material_properties(database, m.second))
+      _values[property.first].resize(n_active_cells);
+  _material_names = material_map;
+  _locally_owned.assign(n_active_cells, false);
+  for (auto const &cell : locally_owned_cells)
+    _locally_owned[cell->active_cell_index()] = true;
+
+  std::uint64_t const seed = internal::CounterBasedGenerator::mix(
+      database.get<std::uint64_t>("seed", 0));
+  // The threads only write to distinct entries of the arrays. Each of them
+  // perturbs its own copy of the database.
+  dealii::parallel::apply_to_subranges(
+      0u, static_cast<unsigned int>(locally_owned_cells.size()),
+      [&](unsigned int const begin, unsigned int const end)
+      {
+        boost::property_tree::ptree perturbed_database = database;
+        for (unsigned int i = begin; i < end; ++i)
+        {
+          auto const &cell = locally_owned_cells[i];
+          internal::CounterBasedGenerator generator(
+              seed ^
+              internal::CounterBasedGenerator::hash(cell->id().to_string()));
+          for (auto const &x : parameter_map)
+            perturbed_database.put(x.first, x.second(generator));
+          unsigned int const index = cell->active_cell_index();
+          for (auto const &property : compute_material_properties(
+                   perturbed_database, material_map.at(cell->material_id())))
+            _values.at(property.first)[index] = property.second;
+        }
+      },
+      64);
 }
 
 template <int dim>
 void InhomogeneousSuperCapacitorMPValues<dim>::get_values(
-    std::string const &key, dealii::FEValues<dim> const &fe_values,
+    std::string const &key, dealii::FEValuesBase<dim> const &fe_values,
     std::vector<double> &values) const
 {
   auto cell = fe_values.get_cell();
-  auto got = _map.find(cell->id());
-  if (got == _map.end())
+  unsigned int const index = cell->active_cell_index();
+  if ((index >= _locally_owned.size()) || (!_locally_owned[index]))
     throw std::runtime_error("Invalid cell property " + cell->id().to_string());
-  auto property = got->second;
-  property->get_values(key, fe_values, values);
+  auto const material = _material_names.find(cell->material_id());
+  if (material == _material_names.end())
+    throw std::runtime_error("Invalid material id " +
+                             std::to_string(cell->material_id()));
+  if (key.compare("liquid_electrical_conductivity") == 0)
+  {
+    auto const custom =
+        _custom_liquid_electrical_conductivity.find(material->second);
+    if (custom != _custom_liquid_electrical_conductivity.end())
+    {
+      custom->second->get_values(key, fe_values, values);
+      return;
+    }
+  }
+  auto const got = _values.find(key);
+  if (got == _values.end())
+    throw std::runtime_error("Invalid material property " + key);
+  std::fill(values.begin(), values.end(), got->second[index]);
 }
 
 //////////////////////// SUPERCAPACITOR ////////////////////////////////////////
@@ -291,123 +375,20 @@ SuperCapacitorMPValues<dim>::SuperCapacitorMPValues(
 }
 
 //////////////////////// POROUS ELECTRODE //////////////////////////////////////
-// helpers to convert units
-auto to_meters = [](double const &cm)
-{
-  return 1e-2 * cm;
-};
-auto to_kilograms_per_cubic_meter = [](double const &g_per_cm3)
-{
-  return 1e3 * g_per_cm3;
-};
-auto to_farads_per_square_meter = [](double const &uF_per_cm2)
-{
-  return 1e-2 * uF_per_cm2;
-};
-auto to_amperes_per_square_meter = [](double const &A_per_cm2)
-{
-  return 1e4 * A_per_cm2;
-};
-auto to_ohm_meter = [](double const &o_cm)
-{
-  return 1e-2 * o_cm;
-};
-
 template <int dim>
 PorousElectrodeMPValues<dim>::PorousElectrodeMPValues(
     std::string const &material_name, MPValuesParameters<dim> const &parameters)
 {
-  std::shared_ptr<boost::property_tree::ptree const> database =
-      parameters.database;
-  std::shared_ptr<boost::property_tree::ptree const> material_database =
-      std::make_shared<boost::property_tree::ptree>(
-          database->get_child(material_name));
+  boost::property_tree::ptree const &database = *parameters.database;
+  for (auto const &property :
+       compute_material_properties(database, material_name))
+    (this->_properties)
+        .emplace(property.first, std::make_shared<UniformConstantMPValues<dim>>(
+                                     property.second));
 
   std::string const matrix_phase =
-      material_database->get<std::string>("matrix_phase");
-  std::shared_ptr<boost::property_tree::ptree const> matrix_phase_database =
-      std::make_shared<boost::property_tree::ptree>(
-          database->get_child(matrix_phase));
-
-  // from the matrix_phase database
-  // clang-format off
-  double const differential_capacitance       = to_farads_per_square_meter(matrix_phase_database->get<double>("differential_capacitance"));
-  double const exchange_current_density       = to_amperes_per_square_meter(matrix_phase_database->get<double>("exchange_current_density"));
-  double const void_volume_fraction           = matrix_phase_database->get<double>("void_volume_fraction");
-  double const tortuosity_factor              = matrix_phase_database->get<double>("tortuosity_factor");
-  double const pores_characteristic_dimension = to_meters(matrix_phase_database->get<double>("pores_characteristic_dimension"));
-  double const pores_geometry_factor          = matrix_phase_database->get<double>("pores_geometry_factor");
-  double const mass_density                   = to_kilograms_per_cubic_meter(matrix_phase_database->get<double>("mass_density"));
-  double const electrical_resistivity         = to_ohm_meter(matrix_phase_database->get<double>("electrical_resistivity"));
-  double const electrical_conductivity        = (electrical_resistivity>1e300) ? 0. : 1.0/electrical_resistivity;
-  double const heat_capacity                  = matrix_phase_database->get<double>("heat_capacity");
-  double const thermal_conductivity           = matrix_phase_database->get<double>("thermal_conductivity");
-  // clang-format on
-  double const specific_surface_area_per_unit_volume =
-      (1.0 + pores_geometry_factor) * void_volume_fraction /
-      pores_characteristic_dimension;
-  (this->_properties)
-      .emplace("specific_surface_area",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   specific_surface_area_per_unit_volume));
-  (this->_properties)
-      .emplace("specific_capacitance",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   specific_surface_area_per_unit_volume *
-                   differential_capacitance));
-  (this->_properties)
-      .emplace("solid_electrical_conductivity",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   (1.0 - void_volume_fraction) * electrical_conductivity));
-
-  // from the solution_phase datatabase
-  std::string const solution_phase =
-      material_database->get<std::string>("solution_phase");
-  std::shared_ptr<boost::property_tree::ptree const> solution_phase_database =
-      std::make_shared<boost::property_tree::ptree>(
-          database->get_child(solution_phase));
-  double const electrolyte_conductivity =
-      1.0 / to_ohm_meter(
-                solution_phase_database->get<double>("electrical_resistivity"));
-  double const electrolyte_mass_density = to_kilograms_per_cubic_meter(
-      solution_phase_database->get<double>("mass_density"));
-  (this->_properties)
-      .emplace("liquid_electrical_conductivity",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   void_volume_fraction * electrolyte_conductivity /
-                   tortuosity_factor));
-  // TODO: not sure where to pull this from
-  // clang-format off
-  double const anodic_charge_transfer_coefficient   = database->get<double>("anodic_charge_transfer_coefficient", 0.5);
-  double const cathodic_charge_transfer_coefficient = database->get<double>("cathodic_charge_transfer_coefficient", 0.5);
-  double const faraday_constant                     = database->get<double>("faraday_constant", 9.64853365e4);
-  double const gas_constant                         = database->get<double>("gas_constant", 8.3144621);
-  double const temperature                          = database->get<double>("temperature", 300.0);
-  // clang-format on
-  (this->_properties)
-      .emplace("faradaic_reaction_coefficient",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   specific_surface_area_per_unit_volume *
-                   exchange_current_density *
-                   (anodic_charge_transfer_coefficient +
-                    cathodic_charge_transfer_coefficient) *
-                   faraday_constant / (gas_constant * temperature)));
-  (this->_properties)
-      .emplace("electron_thermal_voltage",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   gas_constant * temperature / faraday_constant));
-  std::ignore = heat_capacity;
-  std::ignore = thermal_conductivity;
-  (this->_properties)
-      .emplace("density", std::make_shared<UniformConstantMPValues<dim>>(
-                              void_volume_fraction * electrolyte_mass_density +
-                              (1.0 - void_volume_fraction) * mass_density));
-  (this->_properties)
-      .emplace("density_of_active_material",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   (1.0 - void_volume_fraction) * mass_density));
-
-  auto custom = matrix_phase_database->get_child_optional(
+      database.get<std::string>(material_name + ".matrix_phase");
+  auto custom = database.get_child(matrix_phase).get_child_optional(
       "custom_liquid_electrical_conductivity");
   if (custom)
     (this->_properties)["liquid_electrical_conductivity"] =
@@ -419,41 +400,11 @@ template <int dim>
 MetalFoilMPValues<dim>::MetalFoilMPValues(
     std::string const &material_name, MPValuesParameters<dim> const &parameters)
 {
-  std::shared_ptr<boost::property_tree::ptree const> database =
-      parameters.database;
-  std::shared_ptr<boost::property_tree::ptree const> material_database =
-      std::make_shared<boost::property_tree::ptree>(
-          database->get_child(material_name));
-
-  std::string const metal_foil =
-      material_database->get<std::string>("metal_foil");
-  std::shared_ptr<boost::property_tree::ptree const> metal_foil_database =
-      std::make_shared<boost::property_tree::ptree>(
-          database->get_child(metal_foil));
-
-  // clang-format off
-  double const mass_density           = to_kilograms_per_cubic_meter(metal_foil_database->get<double>("mass_density"));
-  double const electrical_resistivity = to_ohm_meter(metal_foil_database->get<double>("electrical_resistivity"));
-  double const heat_capacity          = metal_foil_database->get<double>("heat_capacity");
-  double const thermal_conductivity   = metal_foil_database->get<double>("thermal_conductivity");
-  // clang-format on
-
-  auto null_property = std::make_shared<UniformConstantMPValues<dim>>(0.0);
-
-  (this->_properties).emplace("density_of_active_material", null_property);
-  (this->_properties).emplace("specific_surface_area", null_property);
-  (this->_properties).emplace("specific_capacitance", null_property);
-  (this->_properties).emplace("faradaic_reaction_coefficient", null_property);
-  (this->_properties).emplace("liquid_electrical_conductivity", null_property);
-  (this->_properties)
-      .emplace("solid_electrical_conductivity",
-               std::make_shared<UniformConstantMPValues<dim>>(
-                   1.0 / electrical_resistivity));
-  (this->_properties)
-      .emplace("density",
-               std::make_shared<UniformConstantMPValues<dim>>(mass_density));
-  std::ignore = heat_capacity;
-  std::ignore = thermal_conductivity;
+  for (auto const &property :
+       compute_material_properties(*parameters.database, material_name))
+    (this->_properties)
+        .emplace(property.first, std::make_shared<UniformConstantMPValues<dim>>(
+                                     property.second));
 }
 
 template <int dim>
@@ -481,19 +432,57 @@ FunctionSpaceMPValues<dim>::FunctionSpaceMPValues(
 
 template <int dim>
 void FunctionSpaceMPValues<dim>::get_values(
-    std::string const &key, dealii::FEValues<dim> const &fe_values,
+    std::string const &key, dealii::FEValuesBase<dim> const &fe_values,
     std::vector<double> &values) const
 {
   std::ignore = key;
-  unsigned int n_q_points = fe_values.n_quadrature_points;
   auto const &points = fe_values.get_quadrature_points();
   BOOST_ASSERT_MSG(points.size() == values.size(),
                    "values must be the same size as the quadrature rule"
                    "in MPValues::get_values()");
-  for (unsigned int q = 0; q < n_q_points; ++q)
-  {
-    values[q] = _function->value(points[q]);
-  }
+  // The values are evaluated once per mesh by MPValuesTable, so there is no
+  // need to keep them here.
+  _function->value_list(points, values);
+}
+
+//////////////////////// MP VALUES TABLE ///////////////////////////////////////
+template <int dim>
+MPValuesTable<dim>::MPValuesTable(MPValues<dim> const &mp_values,
+                                  std::vector<std::string> const &keys,
+                                  dealii::DoFHandler<dim> const &dof_handler,
+                                  dealii::Quadrature<dim> const &quadrature)
+    : _keys(keys), _n_q_points(quadrature.size()), _values(keys.size())
+{
+  unsigned int const n_active_cells =
+      dof_handler.get_triangulation().n_active_cells();
+  for (auto &values : _values)
+    values.resize(n_active_cells * _n_q_points);
+
+  // FunctionSpaceMPValues needs the position of the quadrature points.
+  dealii::FEValues<dim> fe_values(dof_handler.get_fe(), quadrature,
+                                  dealii::update_quadrature_points);
+  std::vector<double> values(_n_q_points);
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+    {
+      fe_values.reinit(cell);
+      unsigned int const offset = cell->active_cell_index() * _n_q_points;
+      for (unsigned int k = 0; k < _keys.size(); ++k)
+      {
+        mp_values.get_values(_keys[k], fe_values, values);
+        std::copy(values.begin(), values.end(), _values[k].begin() + offset);
+      }
+    }
+}
+
+template <int dim>
+unsigned int MPValuesTable<dim>::get_handle(std::string const &key) const
+{
+  auto const it = std::find(_keys.begin(), _keys.end(), key);
+  if (it == _keys.end())
+    throw std::runtime_error("Material property " + key +
+                             " is not in the table");
+  return static_cast<unsigned int>(it - _keys.begin());
 }
 
 } // end namespace cap
@@ -21,7 +21,8 @@ class PhysicsParameters
 {
 public:
   PhysicsParameters(boost::property_tree::ptree const &d)
-      : geometry(nullptr), dof_handler(nullptr), mp_values(nullptr), database(d)
+      : geometry(nullptr), dof_handler(nullptr), mp_values(nullptr),
+        mp_values_table(nullptr), database(d)
   {
   }
 
@@ -30,6 +31,8 @@ public:
   std::shared_ptr<Geometry<dim> const> geometry;
   std::shared_ptr<dealii::DoFHandler<dim>> dof_handler;
   std::shared_ptr<MPValues<dim> const> mp_values;
+  // optional, the material properties evaluated once for all the cells
+  std::shared_ptr<MPValuesTable<dim> const> mp_values_table;
   boost::property_tree::ptree const database;
 };
 
@@ -87,6 +90,7 @@ protected:
   dealii::Trilinos::SparseMatrix mass_matrix;
   dealii::Trilinos::MPI::Vector system_rhs;
   std::shared_ptr<MPValues<dim> const> mp_values;
+  std::shared_ptr<MPValuesTable<dim> const> mp_values_table;
   std::shared_ptr<Geometry<dim> const> geometry;
 };
 }
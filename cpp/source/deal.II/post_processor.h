@@ -14,7 +14,10 @@
 #include <deal.II/lac/trilinos_parallel_block_vector.h>
 #include <boost/property_tree/ptree.hpp>
 #include <memory>
+#include <set>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
 
 namespace cap
 {
@@ -28,7 +31,7 @@ public:
       std::shared_ptr<boost::property_tree::ptree const> d,
       std::shared_ptr<dealii::DoFHandler<dim>> const dof_handler)
       : dof_handler(dof_handler), solution(nullptr), mp_values(nullptr),
-        database(d)
+        mp_values_table(nullptr), database(d)
   {
     BOOST_ASSERT_MSG(dof_handler != nullptr, "Invalid DoFHandler.");
     BOOST_ASSERT_MSG(database != nullptr, "Invalid database.");
@@ -39,6 +42,8 @@ public:
   std::shared_ptr<dealii::Trilinos::MPI::BlockVector const> solution;
 
   std::shared_ptr<MPValues<dim> const> mp_values;
+  // optional, the material properties evaluated once for all the cells
+  std::shared_ptr<MPValuesTable<dim> const> mp_values_table;
 
   std::shared_ptr<boost::property_tree::ptree const> database;
 };
@@ -53,11 +58,39 @@ public:
   virtual ~Postprocessor() = default;
   virtual void reset(std::shared_ptr<PostprocessorParameters<dim> const>) {}
 
-  dealii::Vector<double> const &get(std::string const &key) const;
+  /**
+   * Return the quantity @p key. Some quantities are only computed the first
+   * time they are requested after reset() so get() may involve collective
+   * communications. These keys must be requested on every processor, in the
+   * same order; requesting them on a single processor, e.g. to print them on
+   * the first one, deadlocks.
+   *
+   * The fields only contain the values of the locally owned cells, in the
+   * order in which they are traversed by active_cell_iterators().
+   */
+  dealii::Vector<float> const &get(std::string const &key) const;
   void get(std::string const &key, double &value) const;
   std::vector<std::string> get_vector_keys() const;
 
 protected:
+  /**
+   * Make sure that the value @p key is up to date before it is returned by
+   * get(). Does nothing by default.
+   */
+  virtual void evaluate_value(std::string const &key) const
+  {
+    std::ignore = key;
+  }
+
+  /**
+   * Make sure that the field @p key is up to date before it is returned by
+   * get(). Does nothing by default.
+   */
+  virtual void evaluate_vector(std::string const &key) const
+  {
+    std::ignore = key;
+  }
+
   boost::mpi::communicator _communicator;
   std::shared_ptr<dealii::DoFHandler<dim> const> dof_handler;
   std::shared_ptr<dealii::Trilinos::MPI::BlockVector const> solution;
@@ -65,9 +98,10 @@ protected:
   std::shared_ptr<MPValues<dim> const> mp_values;
 
   // This values are only local to a processor, so we don't use
-  // Trilinos::MPI::Vector.
-  std::unordered_map<std::string, dealii::Vector<double>> vectors;
-  std::unordered_map<std::string, double> values;
+  // Trilinos::MPI::Vector. They are mutable because they can be computed
+  // lazily in get().
+  mutable std::unordered_map<std::string, dealii::Vector<float>> vectors;
+  mutable std::unordered_map<std::string, double> values;
 };
 
 //////////////////////// SUPERCAPACITOR POSTPROCESSOR PARAMETERS ////
@@ -82,6 +116,19 @@ public:
 };
 
 //////////////////////// SUPERCAPACITOR POSTPROCESSOR ///////////////
+/**
+ * When the mesh is a unit cell of a stack (Geometry::get_n_unit_cells() > 1),
+ * the extensive values (current, joule_heating, surface_area, volume, mass,
+ * and the interfacial surface areas and masses of active material of the
+ * electrodes) are the ones of the whole stack. The fields are the ones of the
+ * unit cell.
+ *
+ * joule_heating, anode_potential, cathode_potential, and the debug solution
+ * fields and fluxes are computed by a loop over the cells the first time one
+ * of them is requested after reset(). The loop imports the ghost entries of
+ * the solution and reduces the values over all the processors, so these keys
+ * must be requested on every processor in the same order.
+ */
 template <int dim>
 class SuperCapacitorPostprocessor : public Postprocessor<dim>
 {
@@ -90,16 +137,113 @@ public:
       std::shared_ptr<PostprocessorParameters<dim> const> parameters,
       std::shared_ptr<Geometry<dim> const> _geometry,
       boost::mpi::communicator mpi_communicator);
+  ~SuperCapacitorPostprocessor() override;
   void reset(
       std::shared_ptr<PostprocessorParameters<dim> const> parameters) override;
 
+  /**
+   * Return the position of the probes: first the points @c probes.point_X,
+   * then the points of the lines @c probes.line_X.
+   */
+  std::vector<dealii::Point<dim>> const &get_probe_positions() const;
+
+  /**
+   * Return the value of @p key (solid_potential, liquid_potential, or
+   * overpotential) at the probes. The cell containing each probe and the
+   * weights of the degrees of freedom are computed once when the
+   * postprocessor is built; the values are updated by reset().
+   */
+  std::vector<double> const &get_probe_values(std::string const &key) const;
+
+protected:
+  void evaluate_value(std::string const &key) const override;
+  void evaluate_vector(std::string const &key) const override;
+
 private:
+  /**
+   * Compute the quantities that do not depend on the solution: the volume,
+   * the mass, the surface area, etc. Also store the faces of the cathode.
+   */
+  void compute_static_quantities();
+
+  /**
+   * Compute the weights of the linear functionals of the solution that give
+   * the voltage and the current.
+   */
+  void compute_linear_functionals();
+
+  /**
+   * Read the position of the probes in @p database and compute their
+   * weights.
+   */
+  void setup_probes(boost::property_tree::ptree const &database);
+
+  /**
+   * Compute the debug fields that do not depend on the solution: the
+   * material ids and the material properties.
+   */
+  void compute_static_fields() const;
+
+  /**
+   * Compute the quantities that require a loop over all the cells: the Joule
+   * heating and the potential of the electrodes. The debug fields that
+   * depend on the solution are also computed if @p fields is true.
+   */
+  void compute_cell_quantities(bool const fields) const;
+
+  /**
+   * Wait for the reduction of the voltage and the current posted by reset()
+   * and store the result.
+   */
+  void complete_reduction() const;
+
+  /**
+   * Copy the result of the reduction in values and in _probe_values.
+   */
+  void store_reduction() const;
+
   bool _debug_material_ids;
   bool _debug_boundary_ids;
   std::vector<std::string> _debug_material_properties;
   std::vector<std::string> _debug_solution_fields;
   std::vector<std::string> _debug_solution_fluxes;
   std::shared_ptr<Geometry<dim> const> _geometry;
+  std::shared_ptr<MPValuesTable<dim> const> _mp_values_table;
+  unsigned int _solid_potential_component;
+  unsigned int _liquid_potential_component;
+  // faces of the cathode owned by this processor
+  std::vector<std::pair<typename dealii::DoFHandler<dim>::active_cell_iterator,
+                        unsigned int>>
+      _cathode_faces;
+  // area of the cathode of the mesh, i.e. of the unit cell
+  double _unit_cell_surface_area;
+  // voltage = _voltage_weights * solution and current = _current_weights *
+  // solution
+  dealii::Trilinos::MPI::Vector _voltage_weights;
+  dealii::Trilinos::MPI::Vector _current_weights;
+  std::vector<dealii::Point<dim>> _probe_positions;
+  // (local index of the degree of freedom, index in _local_functionals,
+  // weight) for the locally owned degrees of freedom
+  std::vector<std::tuple<unsigned int, unsigned int, double>> _probe_weights;
+  mutable std::unordered_map<std::string, std::vector<double>> _probe_values;
+  // When _non_blocking_reduction is true, reset() does not wait for the
+  // reduction of the voltage, the current, and the probes. It is completed
+  // the first time one of them is requested.
+  bool _non_blocking_reduction;
+  std::vector<double> _local_functionals;
+  mutable std::vector<double> _global_functionals;
+  mutable MPI_Request _request;
+  mutable bool _reduction_pending;
+  // solution with ghost entries imported by compute_cell_quantities()
+  mutable dealii::Trilinos::MPI::BlockVector _relevant_solution;
+  // keys of the fields computed by compute_static_fields()
+  std::set<std::string> _static_fields;
+  // keys of the values and of the fields computed by compute_cell_quantities()
+  std::set<std::string> _cell_quantities;
+  std::set<std::string> _cell_fields;
+  mutable bool _static_fields_up_to_date;
+  mutable bool _cell_quantities_up_to_date;
+  mutable bool _cell_fields_up_to_date;
 };
 
 //////////////////////// MOVE SOMEWHERE ELSE LATER /////////////////////
@@ -10,12 +10,37 @@
 #include <deal.II/base/quadrature_lib.h>
 #include <deal.II/dofs/dof_tools.h>
 #include <deal.II/fe/fe_values.h>
+#include <deal.II/fe/mapping_q1.h>
+#include <deal.II/grid/grid_tools.h>
+#include <boost/mpi/collectives.hpp>
+#include <boost/serialization/vector.hpp>
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <limits>
+#include <numeric>
 
 namespace cap
 {
+namespace internal
+{
+// Weight of a degree of freedom in the value of a probe. It is computed by the
+// processor that owns the cell containing the probe and it is sent to the
+// processor that owns the degree of freedom.
+struct ProbeWeight
+{
+  dealii::types::global_dof_index dof;
+  unsigned int value;
+  double weight;
+
+  template <class Archive>
+  void serialize(Archive &ar, unsigned int const version)
+  {
+    std::ignore = version;
+    ar &dof &value &weight;
+  }
+};
+} // end namespace internal
 
 //////////////////////// POSTPROCESSOR ////////////////////////////
 template <int dim>
@@ -32,10 +57,11 @@ Postprocessor<dim>::Postprocessor(
 }
 
 template <int dim>
-dealii::Vector<double> const &
+dealii::Vector<float> const &
 Postprocessor<dim>::get(std::string const &key) const
 {
-  std::unordered_map<std::string, dealii::Vector<double>>::const_iterator it =
+  evaluate_vector(key);
+  std::unordered_map<std::string, dealii::Vector<float>>::const_iterator it =
       this->vectors.find(key);
   AssertThrow(it != this->vectors.end(), dealii::StandardExceptions::ExcMessage(
                                              "Key " + key + " doesn't exist"));
@@ -45,6 +71,7 @@ Postprocessor<dim>::get(std::string const &key) const
 template <int dim>
 void Postprocessor<dim>::get(std::string const &key, double &value) const
 {
+  evaluate_value(key);
   std::unordered_map<std::string, double>::const_iterator it =
       this->values.find(key);
   AssertThrow(it != this->values.end(), dealii::StandardExceptions::ExcMessage(
@@ -56,9 +83,9 @@ template <int dim>
 std::vector<std::string> Postprocessor<dim>::get_vector_keys() const
 {
   std::vector<std::string> keys;
-  std::unordered_map<std::string, dealii::Vector<double>>::const_iterator it =
+  std::unordered_map<std::string, dealii::Vector<float>>::const_iterator it =
       this->vectors.begin();
-  std::unordered_map<std::string, dealii::Vector<double>>::const_iterator
+  std::unordered_map<std::string, dealii::Vector<float>>::const_iterator
       end_it = this->vectors.end();
   for (; it != end_it; ++it)
     keys.push_back(it->first);
@@ -84,7 +111,11 @@ SuperCapacitorPostprocessor<dim>::SuperCapacitorPostprocessor(
     : Postprocessor<dim>(parameters, mpi_communicator),
       _debug_material_ids(false), _debug_boundary_ids(false),
       _debug_material_properties(), _debug_solution_fields(),
-      _debug_solution_fluxes(), _geometry(geometry)
+      _debug_solution_fluxes(), _geometry(geometry),
+      _mp_values_table(parameters->mp_values_table),
+      _unit_cell_surface_area(0.), _non_blocking_reduction(false),
+      _reduction_pending(false), _static_fields_up_to_date(false),
+      _cell_quantities_up_to_date(false), _cell_fields_up_to_date(false)
 {
   dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
   this->values["voltage"] = 0.0;
@@ -97,11 +128,18 @@ SuperCapacitorPostprocessor<dim>::SuperCapacitorPostprocessor(
   this->values["anode_electrode_mass_of_active_material"] = 0.0;
   this->values["cathode_electrode_interfacial_surface_area"] = 0.0;
   this->values["cathode_electrode_mass_of_active_material"] = 0.0;
+  this->values["anode_potential"] = 0.0;
+  this->values["cathode_potential"] = 0.0;
   this->values["n_dofs"] = static_cast<double>(dof_handler.n_dofs());
 
   std::shared_ptr<boost::property_tree::ptree const> database =
       parameters->database;
 
+  // clang-format off
+  _solid_potential_component  = database->get<unsigned int>("solid_potential_component");
+  _liquid_potential_component = database->get<unsigned int>("liquid_potential_component");
+  // clang-format on
+
   this->_debug_material_properties = cap::to_vector<std::string>(
       database->get("debug.material_properties", ""));
   this->_debug_solution_fields =
@@ -110,223 +148,754 @@ SuperCapacitorPostprocessor<dim>::SuperCapacitorPostprocessor(
       cap::to_vector<std::string>(database->get("debug.solution_fluxes", ""));
   this->_debug_boundary_ids = database->get("debug.boundary_ids", false);
   this->_debug_material_ids = database->get("debug.material_ids", false);
+  _non_blocking_reduction =
+      database->get("post_processor.non_blocking_reduction", false);
 
-  // n_active_cells is the total number of locally owned cells. This includes
-  // the ghost cells and the artificial cells. They are filtered out by DataOut.
-  unsigned int const n_active_cells =
-      dof_handler.get_triangulation().n_active_cells();
-  if (this->_debug_material_ids)
-    this->vectors["material_id"] = dealii::Vector<double>(n_active_cells);
+  // The fields only store the values of the locally owned cells. They are
+  // computed when they are requested.
+  unsigned int const n_locally_owned_cells =
+      dof_handler.get_triangulation().n_locally_owned_active_cells();
   if (this->_debug_boundary_ids)
     throw dealii::StandardExceptions::ExcMessage("not implemented yet");
-  for (std::vector<std::string>::const_iterator it =
-           this->_debug_material_properties.begin();
-       it != this->_debug_material_properties.end(); ++it)
-    this->vectors[*it] = dealii::Vector<double>(n_active_cells);
-  for (std::vector<std::string>::const_iterator it =
-           this->_debug_solution_fields.begin();
-       it != this->_debug_solution_fields.end(); ++it)
-    this->vectors[*it] = dealii::Vector<double>(n_active_cells);
-  for (std::vector<std::string>::const_iterator it =
-           this->_debug_solution_fluxes.begin();
-       it != this->_debug_solution_fluxes.end(); ++it)
+  if (this->_debug_material_ids)
+    _static_fields.insert("material_id");
+  for (auto const &key : this->_debug_material_properties)
+    _static_fields.insert(key);
+  for (auto const &field : this->_debug_solution_fields)
+  {
+    if ((field.compare("solid_potential") != 0) &&
+        (field.compare("liquid_potential") != 0) &&
+        (field.compare("overpotential") != 0) &&
+        (field.compare("joule_heating") != 0))
+      throw dealii::StandardExceptions::ExcMessage(
+          "Solution field '" + field + "' is not recognized");
+    _cell_fields.insert(field);
+  }
+  for (auto const &flux : this->_debug_solution_fluxes)
+  {
+    if ((flux.compare("solid_current_density") != 0) &&
+        (flux.compare("liquid_current_density") != 0))
+      throw dealii::StandardExceptions::ExcMessage(
+          "Solution flux '" + flux + "' is not recognized");
     for (int d = 0; d < dim; ++d)
-      this->vectors[(*it) + "_" + std::to_string(d)] =
-          dealii::Vector<double>(n_active_cells);
+      _cell_fields.insert(flux + "_" + std::to_string(d));
+  }
+  for (auto const &key : _static_fields)
+    this->vectors[key] = dealii::Vector<float>(n_locally_owned_cells);
+  for (auto const &key : _cell_fields)
+    this->vectors[key] = dealii::Vector<float>(n_locally_owned_cells);
+  _cell_quantities.insert("joule_heating");
+  _cell_quantities.insert("anode_potential");
+  _cell_quantities.insert("cathode_potential");
+
+  // Ghosted copy of the solution used by compute_cell_quantities().
+  dealii::IndexSet locally_relevant_dofs;
+  dealii::DoFTools::extract_locally_relevant_dofs(dof_handler,
+                                                  locally_relevant_dofs);
+  std::vector<dealii::IndexSet> index_sets(1, locally_relevant_dofs);
+  _relevant_solution.reinit(index_sets, this->_communicator);
+
+  compute_static_quantities();
+  compute_linear_functionals();
+  setup_probes(*database);
 }
 
 template <int dim>
-void SuperCapacitorPostprocessor<dim>::reset(
-    std::shared_ptr<PostprocessorParameters<dim> const> parameters)
+void SuperCapacitorPostprocessor<dim>::compute_static_quantities()
 {
   dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
-  dealii::Trilinos::MPI::BlockVector const &solution = *(this->solution);
-
-  std::for_each(this->values.begin(), this->values.end(),
-                [](std::unordered_map<std::string, double>::value_type &p)
-                {
-                  p.second = 0.0;
-                });
-
-  // Set the number of dofs since it was erased just before.
-  this->values["n_dofs"] = static_cast<double>(dof_handler.n_dofs());
-
-  std::shared_ptr<boost::property_tree::ptree const> database =
-      parameters->database;
 
   // NOTE: cannot be const if we want to use the square brackets operator.
   auto materials = *(_geometry->get_materials());
   auto boundaries = *(_geometry->get_boundaries());
+
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  dealii::QGauss<dim> quadrature_rule(fe.degree + 1);
+  dealii::QGauss<dim - 1> face_quadrature_rule(fe.degree + 1);
+  // FunctionSpaceMPValues needs the position of the quadrature points.
+  dealii::FEValues<dim> fe_values(fe, quadrature_rule,
+                                  dealii::update_JxW_values |
+                                      dealii::update_quadrature_points);
+  dealii::FEFaceValues<dim> fe_face_values(
+      fe, face_quadrature_rule,
+      dealii::update_JxW_values | dealii::update_quadrature_points);
+  unsigned int const n_q_points = quadrature_rule.size();
+  unsigned int const n_face_q_points = face_quadrature_rule.size();
+
+  // The material properties are static. Evaluate them once unless they have
+  // been provided with the parameters.
+  if (!_mp_values_table)
+    _mp_values_table = std::make_shared<MPValuesTable<dim>>(
+        *(this->mp_values),
+        std::vector<std::string>{
+            "solid_electrical_conductivity", "liquid_electrical_conductivity",
+            "density", "density_of_active_material", "specific_surface_area"},
+        dof_handler, quadrature_rule);
+  BOOST_ASSERT_MSG(_mp_values_table->n_quadrature_points() == n_q_points,
+                   "The table of material properties does not match the "
+                   "quadrature rule");
+  // clang-format off
+  unsigned int const density_handle                    = _mp_values_table->get_handle("density");
+  unsigned int const density_of_active_material_handle = _mp_values_table->get_handle("density_of_active_material");
+  unsigned int const specific_surface_area_handle      = _mp_values_table->get_handle("specific_surface_area");
+  // clang-format on
+
+  double volume = 0.0;
+  double mass = 0.0;
+  double anode_interfacial_surface_area = 0.0;
+  double anode_mass_of_active_material = 0.0;
+  double cathode_interfacial_surface_area = 0.0;
+  double cathode_mass_of_active_material = 0.0;
+  double collector_volume = 0.0;
+  double collector_mass = 0.0;
+  double surface_area = 0.0;
+  _cathode_faces.clear();
+  for (auto cell : dof_handler.active_cell_iterators())
+  {
+    if (cell->is_locally_owned())
+    {
+      fe_values.reinit(cell);
+      unsigned int const index = cell->active_cell_index();
+      // clang-format off
+      double const *density_values                    = _mp_values_table->get_values(density_handle,                    index);
+      double const *density_of_active_material_values = _mp_values_table->get_values(density_of_active_material_handle, index);
+      double const *specific_surface_area_values      = _mp_values_table->get_values(specific_surface_area_handle,      index);
+      // clang-format on
+      bool const anode = materials["anode"].count(cell->material_id()) > 0;
+      bool const cathode = materials["cathode"].count(cell->material_id()) > 0;
+      bool const collector =
+          materials["collector"].count(cell->material_id()) > 0;
+      for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
+      {
+        double const JxW =
+            fe_values.JxW(q_point) *
+            _geometry->get_measure_factor(fe_values.quadrature_point(q_point));
+        volume += JxW;
+        mass += density_values[q_point] * JxW;
+        if (collector)
+        {
+          collector_volume += JxW;
+          collector_mass += density_values[q_point] * JxW;
+        }
+        if (anode)
+        {
+          anode_interfacial_surface_area +=
+              specific_surface_area_values[q_point] * JxW;
+          anode_mass_of_active_material +=
+              density_of_active_material_values[q_point] * JxW;
+        }
+        else if (cathode)
+        {
+          cathode_interfacial_surface_area +=
+              specific_surface_area_values[q_point] * JxW;
+          cathode_mass_of_active_material +=
+              density_of_active_material_values[q_point] * JxW;
+        }
+      }
+      // Store the faces on the cathode, the voltage and the current are
+      // computed on these faces only.
+      if (cell->at_boundary())
+        for (unsigned int face = 0;
+             face < dealii::GeometryInfo<dim>::faces_per_cell; ++face)
+          if ((cell->face(face)->at_boundary()) &&
+              (boundaries["cathode"].count(cell->face(face)->boundary_id()) >
+               0))
+          {
+            _cathode_faces.emplace_back(cell, face);
+            fe_face_values.reinit(cell, face);
+            for (unsigned int face_q_point = 0; face_q_point < n_face_q_points;
+                 ++face_q_point)
+              surface_area += fe_face_values.JxW(face_q_point) *
+                              _geometry->get_measure_factor(
+                                  fe_face_values.quadrature_point(
+                                      face_q_point));
+          }
+    }
+  }
+
+  // Report the values of the whole stack when only a unit cell is meshed.
+  // The cells of a stack share their collectors: the stack has one more
+  // collector than it has cells while the unit cell has two of them.
+  double const n_unit_cells = _geometry->get_n_unit_cells();
+  double const n_shared_collectors = 0.5 * (n_unit_cells - 1.);
+  this->values["volume"] =
+      n_unit_cells * volume - n_shared_collectors * collector_volume;
+  this->values["mass"] =
+      n_unit_cells * mass - n_shared_collectors * collector_mass;
   // clang-format off
-  dealii::FEValuesExtractors::Scalar const solid_potential (database->get<unsigned int>("solid_potential_component"));
-  dealii::FEValuesExtractors::Scalar const liquid_potential(database->get<unsigned int>("liquid_potential_component"));
+  this->values["anode_electrode_interfacial_surface_area"]   = n_unit_cells * anode_interfacial_surface_area;
+  this->values["anode_electrode_mass_of_active_material"]    = n_unit_cells * anode_mass_of_active_material;
+  this->values["cathode_electrode_interfacial_surface_area"] = n_unit_cells * cathode_interfacial_surface_area;
+  this->values["cathode_electrode_mass_of_active_material"]  = n_unit_cells * cathode_mass_of_active_material;
   // clang-format on
+  _unit_cell_surface_area =
+      dealii::Utilities::MPI::sum(surface_area, this->_communicator);
+  this->values["surface_area"] = n_unit_cells * _unit_cell_surface_area;
 
-  dealii::Vector<double> joule_heating(
-      dof_handler.get_triangulation().n_active_cells());
+  // The debug material properties are only computed when they are
+  // requested. Check now that they exist.
+  std::vector<double> values(n_q_points);
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+    {
+      fe_values.reinit(cell);
+      for (auto const &key : this->_debug_material_properties)
+        this->mp_values->get_values(key, fe_values, values);
+      break;
+    }
+}
 
-  dealii::FiniteElement<dim> const &fe =
-      dof_handler.get_fe(); // TODO: don't want to use directly fe because we
-                            // might create postprocessor that will only know
-                            // about dof_handler
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::compute_static_fields() const
+{
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  dealii::QGauss<dim> quadrature_rule(fe.degree + 1);
+  // FunctionSpaceMPValues needs the position of the quadrature points.
+  dealii::FEValues<dim> fe_values(fe, quadrature_rule,
+                                  dealii::update_JxW_values |
+                                      dealii::update_quadrature_points);
+  unsigned int const n_q_points = quadrature_rule.size();
+  std::vector<double> values(n_q_points);
+  unsigned int k = 0;
+  for (auto cell : dof_handler.active_cell_iterators())
+  {
+    if (cell->is_locally_owned())
+    {
+      if (this->_debug_material_ids)
+        this->vectors["material_id"][k] =
+            static_cast<float>(cell->material_id());
+      if (!this->_debug_material_properties.empty())
+        fe_values.reinit(cell);
+      for (auto const &key : this->_debug_material_properties)
+      {
+        this->mp_values->get_values(key, fe_values, values);
+        double cell_averaged_value = 0.0;
+        for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
+          cell_averaged_value += values[q_point] * fe_values.JxW(q_point);
+        cell_averaged_value /= cell->measure();
+        this->vectors[key][k] = cell_averaged_value;
+      }
+      ++k;
+    }
+  }
+  _static_fields_up_to_date = true;
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::compute_linear_functionals()
+{
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  unsigned int const dofs_per_cell = fe.dofs_per_cell;
+  dealii::FEValuesExtractors::Scalar const solid_potential(
+      _solid_potential_component);
   dealii::QGauss<dim> quadrature_rule(fe.degree + 1);
   dealii::QGauss<dim - 1> face_quadrature_rule(fe.degree + 1);
-  dealii::FEValues<dim> fe_values(
-      fe, quadrature_rule, dealii::update_values | dealii::update_gradients |
-                               dealii::update_JxW_values |
-                               dealii::update_quadrature_points);
+  dealii::FEValues<dim> fe_values(fe, quadrature_rule,
+                                  dealii::update_gradients |
+                                      dealii::update_JxW_values |
+                                      dealii::update_quadrature_points);
   dealii::FEFaceValues<dim> fe_face_values(
       fe, face_quadrature_rule,
       dealii::update_values | dealii::update_gradients |
           dealii::update_JxW_values | dealii::update_normal_vectors |
           dealii::update_quadrature_points);
-  //    unsigned int const dofs_per_cell   = fe.dofs_per_cell;
   unsigned int const n_q_points = quadrature_rule.size();
   unsigned int const n_face_q_points = face_quadrature_rule.size();
+  std::vector<dealii::types::global_dof_index> local_dof_indices(
+      dofs_per_cell);
+  dealii::Vector<double> cell_weights(dofs_per_cell);
+
+  dealii::IndexSet const locally_owned_dofs = dof_handler.locally_owned_dofs();
+  _voltage_weights.reinit(locally_owned_dofs, this->_communicator);
+  _current_weights.reinit(locally_owned_dofs, this->_communicator);
+
+  // The voltage is the average of the solid potential on the cathode.
+  double const surface_area = _unit_cell_surface_area;
+  for (auto const &cell_face : _cathode_faces)
+  {
+    fe_face_values.reinit(cell_face.first, cell_face.second);
+    cell_weights = 0.;
+    for (unsigned int face_q_point = 0; face_q_point < n_face_q_points;
+         ++face_q_point)
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+        cell_weights[i] +=
+            fe_face_values[solid_potential].value(i, face_q_point) *
+            fe_face_values.JxW(face_q_point) *
+            _geometry->get_measure_factor(
+                fe_face_values.quadrature_point(face_q_point)) /
+            surface_area;
+    cell_face.first->get_dof_indices(local_dof_indices);
+    _voltage_weights.add(local_dof_indices, cell_weights);
+  }
+  _voltage_weights.compress(dealii::VectorOperation::add);
+
+  // The current is the reaction at the cathode, i.e. the residual of the
+  // conduction equation tested with the function g that is equal to one at
+  // the degrees of freedom of the cathode and zero elsewhere:
+  //   current = \int sigma grad(phi) . grad(g).
+  // When the cells touching the cathode do not store or produce charges
+  // (e.g. they belong to a current collector), this is the flux through the
+  // cathode. Unlike the flux computed from the gradient on the faces, it is
+  // consistent with the discrete system and it recovers the imposed current
+  // exactly.
+  auto boundaries = *(_geometry->get_boundaries());
+  std::vector<bool> mask(fe.n_components(), false);
+  mask[_solid_potential_component] = true;
+  dealii::IndexSet cathode_dofs;
+  dealii::DoFTools::extract_boundary_dofs(dof_handler,
+                                          dealii::ComponentMask(mask),
+                                          cathode_dofs, boundaries["cathode"]);
   std::vector<double> solid_electrical_conductivity_values(n_q_points);
-  std::vector<double> liquid_electrical_conductivity_values(n_q_points);
-  std::vector<double> density_values(n_q_points);
-  std::vector<double> density_of_active_material_values(n_q_points);
-  std::vector<double> specific_surface_area_values(n_q_points);
+  std::vector<double> specific_capacitance_values(n_q_points);
+  std::vector<double> faradaic_reaction_coefficient_values(n_q_points);
+  std::vector<bool> on_cathode(dofs_per_cell);
+  int sources = 0;
+  for (auto cell : dof_handler.active_cell_iterators())
+  {
+    if (cell->is_locally_owned())
+    {
+      cell->get_dof_indices(local_dof_indices);
+      bool touch_cathode = false;
+      for (unsigned int i = 0; i < dofs_per_cell; ++i)
+      {
+        on_cathode[i] = cathode_dofs.is_element(local_dof_indices[i]);
+        touch_cathode = touch_cathode || on_cathode[i];
+      }
+      if (!touch_cathode)
+        continue;
+
+      fe_values.reinit(cell);
+      // clang-format off
+      this->mp_values->get_values("solid_electrical_conductivity", fe_values, solid_electrical_conductivity_values);
+      this->mp_values->get_values("specific_capacitance",          fe_values, specific_capacitance_values);
+      this->mp_values->get_values("faradaic_reaction_coefficient", fe_values, faradaic_reaction_coefficient_values);
+      // clang-format on
+      if ((*std::max_element(specific_capacitance_values.begin(),
+                             specific_capacitance_values.end()) > 0.) ||
+          (*std::max_element(faradaic_reaction_coefficient_values.begin(),
+                             faradaic_reaction_coefficient_values.end()) > 0.))
+        sources = 1;
+      cell_weights = 0.;
+      for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
+      {
+        dealii::Tensor<1, dim> g_gradient;
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          if (on_cathode[i])
+            g_gradient += fe_values[solid_potential].gradient(i, q_point);
+        double const JxW =
+            fe_values.JxW(q_point) *
+            _geometry->get_measure_factor(fe_values.quadrature_point(q_point));
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          cell_weights[i] += solid_electrical_conductivity_values[q_point] *
+                             (fe_values[solid_potential].gradient(i, q_point) *
+                              g_gradient) *
+                             JxW;
+      }
+      _current_weights.add(local_dof_indices, cell_weights);
+    }
+  }
+  _current_weights.compress(dealii::VectorOperation::add);
+
+  // Otherwise, fall back to the flux through the faces of the cathode.
+  if (dealii::Utilities::MPI::max(sources, this->_communicator) > 0)
+  {
+    _current_weights = 0.;
+    std::vector<double> face_solid_electrical_conductivity_values(
+        n_face_q_points);
+    for (auto const &cell_face : _cathode_faces)
+    {
+      fe_face_values.reinit(cell_face.first, cell_face.second);
+      this->mp_values->get_values("solid_electrical_conductivity",
+                                  fe_face_values,
+                                  face_solid_electrical_conductivity_values);
+      cell_weights = 0.;
+      for (unsigned int face_q_point = 0; face_q_point < n_face_q_points;
+           ++face_q_point)
+        for (unsigned int i = 0; i < dofs_per_cell; ++i)
+          cell_weights[i] +=
+              face_solid_electrical_conductivity_values[face_q_point] *
+              (fe_face_values[solid_potential].gradient(i, face_q_point) *
+               fe_face_values.normal_vector(face_q_point)) *
+              fe_face_values.JxW(face_q_point) *
+              _geometry->get_measure_factor(
+                  fe_face_values.quadrature_point(face_q_point));
+      cell_face.first->get_dof_indices(local_dof_indices);
+      _current_weights.add(local_dof_indices, cell_weights);
+    }
+    _current_weights.compress(dealii::VectorOperation::add);
+  }
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::reset(
+    std::shared_ptr<PostprocessorParameters<dim> const> parameters)
+{
+  std::ignore = parameters;
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+  this->values["n_dofs"] = static_cast<double>(dof_handler.n_dofs());
+
+  // The other quantities require a loop over all the cells. They are
+  // computed the first time they are requested.
+  _cell_quantities_up_to_date = false;
+  _cell_fields_up_to_date = false;
+
+  // The send buffer cannot be modified before the previous reduction is
+  // completed.
+  if (_reduction_pending)
+    complete_reduction();
+
+  // The voltage, the current, and the values at the probes are linear in the
+  // solution. Evaluate the local part of the dot products and reduce them
+  // together.
+  dealii::Trilinos::MPI::Vector const &solution = this->solution->block(0);
+  _local_functionals[0] = std::inner_product(
+      _voltage_weights.begin(), _voltage_weights.end(), solution.begin(), 0.);
+  _local_functionals[1] = std::inner_product(
+      _current_weights.begin(), _current_weights.end(), solution.begin(), 0.);
+  std::fill(_local_functionals.begin() + 2, _local_functionals.end(), 0.);
+  dealii::Trilinos::MPI::Vector::const_iterator solution_values =
+      solution.begin();
+  for (auto const &probe_weight : _probe_weights)
+    _local_functionals[std::get<1>(probe_weight)] +=
+        std::get<2>(probe_weight) * solution_values[std::get<0>(probe_weight)];
+  int const buffer_size = _local_functionals.size();
+  if (_non_blocking_reduction)
+  {
+    MPI_Iallreduce(_local_functionals.data(), _global_functionals.data(),
+                   buffer_size, MPI_DOUBLE, MPI_SUM, this->_communicator,
+                   &_request);
+    _reduction_pending = true;
+  }
+  else
+  {
+    MPI_Allreduce(_local_functionals.data(), _global_functionals.data(),
+                  buffer_size, MPI_DOUBLE, MPI_SUM, this->_communicator);
+    store_reduction();
+  }
+}
+
+template <int dim>
+SuperCapacitorPostprocessor<dim>::~SuperCapacitorPostprocessor()
+{
+  if (_reduction_pending)
+    MPI_Wait(&_request, MPI_STATUS_IGNORE);
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::complete_reduction() const
+{
+  MPI_Wait(&_request, MPI_STATUS_IGNORE);
+  _reduction_pending = false;
+  store_reduction();
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::store_reduction() const
+{
+  this->values["voltage"] = _global_functionals[0];
+  this->values["current"] =
+      _geometry->get_n_unit_cells() * _global_functionals[1];
+  std::vector<double> &solid_potential = _probe_values["solid_potential"];
+  std::vector<double> &liquid_potential = _probe_values["liquid_potential"];
+  std::vector<double> &overpotential = _probe_values["overpotential"];
+  for (unsigned int p = 0; p < _probe_positions.size(); ++p)
+  {
+    solid_potential[p] = _global_functionals[2 + 2 * p];
+    liquid_potential[p] = _global_functionals[3 + 2 * p];
+    overpotential[p] = solid_potential[p] - liquid_potential[p];
+  }
+}
+
+template <int dim>
+std::vector<dealii::Point<dim>> const &
+SuperCapacitorPostprocessor<dim>::get_probe_positions() const
+{
+  return _probe_positions;
+}
+
+template <int dim>
+std::vector<double> const &
+SuperCapacitorPostprocessor<dim>::get_probe_values(std::string const &key) const
+{
+  if (_reduction_pending)
+    complete_reduction();
+  std::unordered_map<std::string, std::vector<double>>::const_iterator it =
+      _probe_values.find(key);
+  AssertThrow(it != _probe_values.end(),
+              dealii::StandardExceptions::ExcMessage("Key " + key +
+                                                     " doesn't exist"));
+  return it->second;
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::setup_probes(
+    boost::property_tree::ptree const &database)
+{
+  // Read the position of the probes. The points of a line are uniformly
+  // distributed between its two ends.
+  auto to_point = [](std::string const &coordinates)
+  {
+    std::vector<double> const x = cap::to_vector<double>(coordinates);
+    if (x.size() != dim)
+      throw std::runtime_error("Invalid probe position " + coordinates);
+    dealii::Point<dim> point;
+    for (int d = 0; d < dim; ++d)
+      point[d] = x[d];
+    return point;
+  };
+  unsigned int const n_points = database.get("probes.points", 0);
+  for (unsigned int i = 0; i < n_points; ++i)
+    _probe_positions.push_back(to_point(
+        database.get<std::string>("probes.point_" + std::to_string(i))));
+  unsigned int const n_lines = database.get("probes.lines", 0);
+  for (unsigned int i = 0; i < n_lines; ++i)
+  {
+    boost::property_tree::ptree const &line =
+        database.get_child("probes.line_" + std::to_string(i));
+    dealii::Point<dim> const start = to_point(line.get<std::string>("start"));
+    dealii::Point<dim> const end = to_point(line.get<std::string>("end"));
+    unsigned int const n = line.get<unsigned int>("n_points");
+    if (n < 2)
+      throw std::runtime_error("A probe line needs at least two points");
+    for (unsigned int j = 0; j < n; ++j)
+      _probe_positions.push_back(start + static_cast<double>(j) / (n - 1) *
+                                             (end - start));
+  }
+
+  unsigned int const n_probes = _probe_positions.size();
+  for (std::string const &key :
+       {"solid_potential", "liquid_potential", "overpotential"})
+    _probe_values[key] = std::vector<double>(n_probes, 0.);
+  _local_functionals.assign(2 + 2 * n_probes, 0.);
+  _global_functionals.assign(2 + 2 * n_probes, 0.);
+  if (n_probes == 0)
+    return;
+
+  // Find the cell that contains each probe. A probe on the interface between
+  // two subdomains is assigned to the processor of lowest rank.
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+  unsigned int const rank = this->_communicator.rank();
+  unsigned int const n_processors = this->_communicator.size();
+  std::vector<unsigned int> owner(n_probes, n_processors);
+  std::vector<std::pair<typename dealii::DoFHandler<dim>::active_cell_iterator,
+                        dealii::Point<dim>>>
+      cells(n_probes);
+  for (unsigned int p = 0; p < n_probes; ++p)
+  {
+    try
+    {
+      cells[p] = dealii::GridTools::find_active_cell_around_point(
+          dealii::StaticMappingQ1<dim>::mapping, dof_handler,
+          _probe_positions[p]);
+      if (cells[p].first->is_locally_owned())
+        owner[p] = rank;
+    }
+    catch (dealii::ExceptionBase const &)
+    {
+      // The probe is not in a cell known by this processor.
+    }
+  }
+  std::vector<unsigned int> global_owner(n_probes);
+  MPI_Allreduce(owner.data(), global_owner.data(), n_probes, MPI_UNSIGNED,
+                MPI_MIN, this->_communicator);
+
+  // Compute the weights of the degrees of freedom of the cell, i.e. the value
+  // of the shape functions at the probe, and send them to the processors that
+  // own the degrees of freedom.
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  std::vector<dealii::types::global_dof_index> local_dof_indices(
+      fe.dofs_per_cell);
+  std::vector<dealii::IndexSet> const &locally_owned_dofs_per_processor =
+      dof_handler.locally_owned_dofs_per_processor();
+  std::vector<std::vector<internal::ProbeWeight>> send_weights(n_processors);
+  for (unsigned int p = 0; p < n_probes; ++p)
+  {
+    if (global_owner[p] == n_processors)
+      throw std::runtime_error("The probe " + std::to_string(p) +
+                               " is outside of the mesh");
+    if (global_owner[p] != rank)
+      continue;
+    cells[p].first->get_dof_indices(local_dof_indices);
+    for (unsigned int i = 0; i < fe.dofs_per_cell; ++i)
+    {
+      unsigned int const component = fe.system_to_component_index(i).first;
+      unsigned int value = 2 + 2 * p;
+      if (component == _liquid_potential_component)
+        ++value;
+      else if (component != _solid_potential_component)
+        continue;
+      double const weight = fe.shape_value(i, cells[p].second);
+      if (weight == 0.)
+        continue;
+      for (unsigned int q = 0; q < n_processors; ++q)
+        if (locally_owned_dofs_per_processor[q].is_element(
+                local_dof_indices[i]))
+        {
+          send_weights[q].push_back({local_dof_indices[i], value, weight});
+          break;
+        }
+    }
+  }
+  std::vector<std::vector<internal::ProbeWeight>> received_weights;
+  boost::mpi::all_to_all(this->_communicator, send_weights, received_weights);
+  dealii::IndexSet const locally_owned_dofs = dof_handler.locally_owned_dofs();
+  for (auto const &weights : received_weights)
+    for (auto const &probe_weight : weights)
+      _probe_weights.emplace_back(
+          locally_owned_dofs.index_within_set(probe_weight.dof),
+          probe_weight.value, probe_weight.weight);
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::evaluate_value(
+    std::string const &key) const
+{
+  if (_reduction_pending &&
+      ((key.compare("voltage") == 0) || (key.compare("current") == 0)))
+    complete_reduction();
+  if ((!_cell_quantities_up_to_date) && (_cell_quantities.count(key) > 0))
+    compute_cell_quantities(false);
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::evaluate_vector(
+    std::string const &key) const
+{
+  if ((!_static_fields_up_to_date) && (_static_fields.count(key) > 0))
+    compute_static_fields();
+  if ((!_cell_fields_up_to_date) && (_cell_fields.count(key) > 0))
+    compute_cell_quantities(true);
+}
+
+template <int dim>
+void SuperCapacitorPostprocessor<dim>::compute_cell_quantities(
+    bool const fields) const
+{
+  dealii::DoFHandler<dim> const &dof_handler = *(this->dof_handler);
+
+  // NOTE: cannot be const if we want to use the square brackets operator.
+  auto materials = *(_geometry->get_materials());
+  dealii::FEValuesExtractors::Scalar const solid_potential(
+      _solid_potential_component);
+  dealii::FEValuesExtractors::Scalar const liquid_potential(
+      _liquid_potential_component);
+
+  dealii::FiniteElement<dim> const &fe = dof_handler.get_fe();
+  dealii::QGauss<dim> quadrature_rule(fe.degree + 1);
+  dealii::FEValues<dim> fe_values(
+      fe, quadrature_rule, dealii::update_values | dealii::update_gradients |
+                               dealii::update_JxW_values |
+                               dealii::update_quadrature_points);
+  unsigned int const n_q_points = quadrature_rule.size();
+  // clang-format off
+  unsigned int const solid_electrical_conductivity_handle  = _mp_values_table->get_handle("solid_electrical_conductivity");
+  unsigned int const liquid_electrical_conductivity_handle = _mp_values_table->get_handle("liquid_electrical_conductivity");
+  // clang-format on
   std::vector<dealii::Tensor<1, dim>> solid_potential_gradients(n_q_points);
   std::vector<dealii::Tensor<1, dim>> liquid_potential_gradients(n_q_points);
   std::vector<double> solid_potential_values(n_q_points);
   std::vector<double> liquid_potential_values(n_q_points);
+  _relevant_solution = *(this->solution);
+  double joule_heating = 0.0;
+  double collector_joule_heating = 0.0;
   double anode_electrode_potential = 0.0;
   double cathode_electrode_potential = 0.0;
   double anode_electrode_volume = 0.0;
   double cathode_electrode_volume = 0.0;
+  // The debug fields are only computed when they are requested.
+  std::vector<std::string> const no_keys;
+  std::vector<std::string> const &solution_fields =
+      fields ? this->_debug_solution_fields : no_keys;
+  std::vector<std::string> const &solution_fluxes =
+      fields ? this->_debug_solution_fluxes : no_keys;
 
-  std::vector<double> face_solid_electrical_conductivity_values(
-      n_face_q_points);
-  std::vector<double> face_solid_potential_values(n_face_q_points);
-  std::vector<dealii::Tensor<1, dim>> face_solid_potential_gradients(
-      n_face_q_points);
-  std::vector<dealii::Tensor<1, dim>> normal_vectors(n_face_q_points);
-  // TODO: MPValues::get_values is not able to take FEFaceValues at this time so
-  // we resize this material property vector from n_face_q_points to n_q_points
-  // as a temporary bug fix.
-  face_solid_electrical_conductivity_values.resize(n_q_points);
-
-  dealii::IndexSet locally_relevant_dofs;
-  dealii::DoFTools::extract_locally_relevant_dofs(dof_handler,
-                                                  locally_relevant_dofs);
-  std::vector<dealii::IndexSet> index_sets(1, locally_relevant_dofs);
-  dealii::Trilinos::MPI::BlockVector relevant_solution(index_sets);
-  relevant_solution = solution;
-
+  unsigned int k = 0;
   for (auto cell : dof_handler.active_cell_iterators())
   {
     if (cell->is_locally_owned())
     {
       fe_values.reinit(cell);
-      this->mp_values->get_values("solid_electrical_conductivity", fe_values,
-                                  solid_electrical_conductivity_values);
-      this->mp_values->get_values("liquid_electrical_conductivity", fe_values,
-                                  liquid_electrical_conductivity_values);
-      this->mp_values->get_values("density", fe_values, density_values);
-      this->mp_values->get_values("density_of_active_material", fe_values,
-                                  density_of_active_material_values);
-      this->mp_values->get_values("specific_surface_area", fe_values,
-                                  specific_surface_area_values);
-      if (*std::max_element(solid_electrical_conductivity_values.begin(),
-                            solid_electrical_conductivity_values.end()) >
-          1e-300)
+      unsigned int const index = cell->active_cell_index();
+      // clang-format off
+      double const *solid_electrical_conductivity_values  = _mp_values_table->get_values(solid_electrical_conductivity_handle,  index);
+      double const *liquid_electrical_conductivity_values = _mp_values_table->get_values(liquid_electrical_conductivity_handle, index);
+      // clang-format on
+      if (*std::max_element(solid_electrical_conductivity_values,
+                            solid_electrical_conductivity_values +
+                                n_q_points) > 1e-300)
       {
         fe_values[solid_potential].get_function_gradients(
-            relevant_solution, solid_potential_gradients);
-        fe_values[solid_potential].get_function_values(relevant_solution,
+            _relevant_solution, solid_potential_gradients);
+        fe_values[solid_potential].get_function_values(_relevant_solution,
                                                        solid_potential_values);
       }
-      if (*std::max_element(liquid_electrical_conductivity_values.begin(),
-                            liquid_electrical_conductivity_values.end()) >
-          1e-300)
+      if (*std::max_element(liquid_electrical_conductivity_values,
+                            liquid_electrical_conductivity_values +
+                                n_q_points) > 1e-300)
       {
         fe_values[liquid_potential].get_function_gradients(
-            relevant_solution, liquid_potential_gradients);
+            _relevant_solution, liquid_potential_gradients);
         fe_values[liquid_potential].get_function_values(
-            relevant_solution, liquid_potential_values);
+            _relevant_solution, liquid_potential_values);
       }
+      bool const anode = materials["anode"].count(cell->material_id()) > 0;
+      bool const cathode = materials["cathode"].count(cell->material_id()) > 0;
+      bool const collector =
+          materials["collector"].count(cell->material_id()) > 0;
       for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
       {
-        this->values["joule_heating"] +=
+        double const JxW =
+            fe_values.JxW(q_point) *
+            _geometry->get_measure_factor(fe_values.quadrature_point(q_point));
+        double const heating =
             (solid_electrical_conductivity_values[q_point] *
                  solid_potential_gradients[q_point] *
                  solid_potential_gradients[q_point] +
              liquid_electrical_conductivity_values[q_point] *
                  liquid_potential_gradients[q_point] *
                  liquid_potential_gradients[q_point]) *
-            fe_values.JxW(q_point);
-        this->values["volume"] += fe_values.JxW(q_point);
-        this->values["mass"] +=
-            density_values[q_point] * fe_values.JxW(q_point);
-        if (materials["anode"].count(cell->material_id()) > 0)
-        {
-          anode_electrode_potential += (solid_potential_values[q_point] -
-                                        liquid_potential_values[q_point]) *
-                                       fe_values.JxW(q_point);
-          anode_electrode_volume += fe_values.JxW(q_point);
-          this->values["anode_electrode_interfacial_surface_area"] +=
-              specific_surface_area_values[q_point] * fe_values.JxW(q_point);
-          this->values["anode_electrode_mass_of_active_material"] +=
-              density_of_active_material_values[q_point] *
-              fe_values.JxW(q_point);
-        }
-        else if (materials["cathode"].count(cell->material_id()) > 0)
+            JxW;
+        joule_heating += heating;
+        if (collector)
+          collector_joule_heating += heating;
+        if (anode)
         {
-          cathode_electrode_potential += (solid_potential_values[q_point] -
-                                          liquid_potential_values[q_point]) *
-                                         fe_values.JxW(q_point);
-          cathode_electrode_volume += fe_values.JxW(q_point);
-          this->values["cathode_electrode_interfacial_surface_area"] +=
-              specific_surface_area_values[q_point] * fe_values.JxW(q_point);
-          this->values["cathode_electrode_mass_of_active_material"] +=
-              density_of_active_material_values[q_point] *
-              fe_values.JxW(q_point);
+          anode_electrode_potential +=
+              (solid_potential_values[q_point] -
+               liquid_potential_values[q_point]) *
+              JxW;
+          anode_electrode_volume += JxW;
         }
-        else
+        else if (cathode)
         {
-          // do nothing
+          cathode_electrode_potential +=
+              (solid_potential_values[q_point] -
+               liquid_potential_values[q_point]) *
+              JxW;
+          cathode_electrode_volume += JxW;
         }
       } // end for quadrature point
-      if (this->_debug_material_ids)
-        this->vectors["material_id"][cell->active_cell_index()] =
-            static_cast<double>(cell->material_id());
-      for (std::vector<std::string>::const_iterator it =
-               this->_debug_material_properties.begin();
-           it != this->_debug_material_properties.end(); ++it)
-      {
-        std::vector<double> values(n_q_points);
-        this->mp_values->get_values(*it, fe_values, values);
-        double cell_averaged_value = 0.0;
-        for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
-        {
-          cell_averaged_value += values[q_point] * fe_values.JxW(q_point);
-        }
-        cell_averaged_value /= cell->measure();
-        this->vectors[*it][cell->active_cell_index()] = cell_averaged_value;
-      }
-      for (std::vector<std::string>::const_iterator it =
-               this->_debug_solution_fields.begin();
-           it != this->_debug_solution_fields.end(); ++it)
+      for (auto const &field : solution_fields)
       {
         std::vector<double> values(n_q_points);
-        if (it->compare("solid_potential") == 0)
+        if (field.compare("solid_potential") == 0)
         {
           values = solid_potential_values;
         }
-        else if (it->compare("liquid_potential") == 0)
+        else if (field.compare("liquid_potential") == 0)
         {
           values = liquid_potential_values;
         }
-        else if (it->compare("overpotential") == 0)
+        else if (field.compare("overpotential") == 0)
         {
           std::transform(solid_potential_values.begin(),
                          solid_potential_values.end(),
                          liquid_potential_values.begin(), values.begin(),
                          std::minus<double>());
         }
-        else if (it->compare("joule_heating") == 0)
+        else // joule_heating
         {
           for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
           {
@@ -337,49 +906,29 @@ void SuperCapacitorPostprocessor<dim>::reset(
                     solid_potential_gradients[q_point].norm_square();
           }
         }
-        else
-        {
-          throw dealii::StandardExceptions::ExcMessage(
-              "Solution field '" + (*it) + "' is not recognized");
-        }
         double cell_averaged_value = 0.0;
         for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
         {
           cell_averaged_value += values[q_point] * fe_values.JxW(q_point);
         }
         cell_averaged_value /= cell->measure();
-        this->vectors[*it][cell->active_cell_index()] = cell_averaged_value;
+        this->vectors[field][k] = cell_averaged_value;
       }
-      for (std::vector<std::string>::const_iterator it =
-               this->_debug_solution_fluxes.begin();
-           it != this->_debug_solution_fluxes.end(); ++it)
+      for (auto const &flux : solution_fluxes)
       {
         std::vector<dealii::Tensor<1, dim>> values(n_q_points);
-        if (it->compare("solid_current_density") == 0)
-        {
-          std::transform(solid_electrical_conductivity_values.begin(),
-                         solid_electrical_conductivity_values.end(),
-                         solid_potential_gradients.begin(), values.begin(),
-                         [](double const x, dealii::Tensor<1, dim> const &y)
-                         {
-                           return x * y;
-                         });
-        }
-        else if (it->compare("liquid_current_density") == 0)
-        {
-          std::transform(liquid_electrical_conductivity_values.begin(),
-                         liquid_electrical_conductivity_values.end(),
-                         liquid_potential_gradients.begin(), values.begin(),
-                         [](double const x, dealii::Tensor<1, dim> const &y)
-                         {
-                           return x * y;
-                         });
-        }
-        else
-        {
-          throw dealii::StandardExceptions::ExcMessage(
-              "Solution flux '" + (*it) + "' is not recognized");
-        }
+        bool const solid = (flux.compare("solid_current_density") == 0);
+        double const *conductivity_values =
+            solid ? solid_electrical_conductivity_values
+                  : liquid_electrical_conductivity_values;
+        std::vector<dealii::Tensor<1, dim>> const &potential_gradients =
+            solid ? solid_potential_gradients : liquid_potential_gradients;
+        std::transform(conductivity_values, conductivity_values + n_q_points,
+                       potential_gradients.begin(), values.begin(),
+                       [](double const x, dealii::Tensor<1, dim> const &y)
+                       {
+                         return x * y;
+                       });
         dealii::Tensor<1, dim> cell_averaged_value;
         cell_averaged_value = 0.0;
         for (unsigned int q_point = 0; q_point < n_q_points; ++q_point)
@@ -388,73 +937,37 @@ void SuperCapacitorPostprocessor<dim>::reset(
         }
         cell_averaged_value /= cell->measure();
         for (int d = 0; d < dim; ++d)
-          this->vectors[(*it) + "_" +
-                        std::to_string(d)][cell->active_cell_index()] =
+          this->vectors[flux + "_" + std::to_string(d)][k] =
               cell_averaged_value[d];
       }
-
-      if (cell->at_boundary())
-      {
-        for (unsigned int face = 0;
-             face < dealii::GeometryInfo<dim>::faces_per_cell; ++face)
-        {
-          if (cell->face(face)->at_boundary())
-          {
-            if (boundaries["cathode"].count(cell->face(face)->boundary_id()) >
-                0)
-            {
-              fe_face_values.reinit(cell, face);
-              // TODO:  This is a temporary bug fix.  MPValues should take
-              // fe_face_values instead of fe_values as an argument.
-              this->mp_values->get_values(
-                  "solid_electrical_conductivity", fe_values,
-                  face_solid_electrical_conductivity_values);
-              fe_face_values[solid_potential].get_function_gradients(
-                  relevant_solution, face_solid_potential_gradients);
-              fe_face_values[solid_potential].get_function_values(
-                  relevant_solution, face_solid_potential_values);
-              normal_vectors = fe_face_values.get_all_normal_vectors();
-              for (unsigned int face_q_point = 0;
-                   face_q_point < n_face_q_points; ++face_q_point)
-              {
-                this->values["current"] +=
-                    (face_solid_electrical_conductivity_values[face_q_point] *
-                     face_solid_potential_gradients[face_q_point] *
-                     normal_vectors[face_q_point]) *
-                    fe_face_values.JxW(face_q_point);
-                this->values["voltage"] +=
-                    face_solid_potential_values[face_q_point] *
-                    fe_face_values.JxW(face_q_point);
-                this->values["surface_area"] +=
-                    fe_face_values.JxW(face_q_point);
-              } // end for face quadrature point
-            }   // end if cathode
-          }     // end if face at boundary
-        }       // end for face
-      }         // end if cell at boundary
+      ++k;
     }
   } // end for cell
-  // AllReduce to get the scalar quantities
-  this->values["current"] =
-      dealii::Utilities::MPI::sum(this->values["current"], this->_communicator);
-  this->values["surface_area"] = dealii::Utilities::MPI::sum(
-      this->values["surface_area"], this->_communicator);
-  this->values["voltage"] =
-      dealii::Utilities::MPI::sum(this->values["voltage"], this->_communicator);
-  anode_electrode_potential = dealii::Utilities::MPI::sum(
-      anode_electrode_potential, this->_communicator);
-  anode_electrode_volume =
-      dealii::Utilities::MPI::sum(anode_electrode_volume, this->_communicator);
-  cathode_electrode_potential = dealii::Utilities::MPI::sum(
-      cathode_electrode_potential, this->_communicator);
-  cathode_electrode_volume = dealii::Utilities::MPI::sum(
-      cathode_electrode_volume, this->_communicator);
-
-  this->values["voltage"] /= this->values["surface_area"];
-  anode_electrode_potential /= anode_electrode_volume;
-  cathode_electrode_potential /= cathode_electrode_volume;
-  this->values["anode_potential"] = anode_electrode_potential;
-  this->values["cathode_potential"] = cathode_electrode_potential;
+  // AllReduce to get the scalar quantities. All of them are packed in a
+  // single reduction.
+  std::array<double, 6> const local_values = {
+      {anode_electrode_potential, anode_electrode_volume,
+       cathode_electrode_potential, cathode_electrode_volume, joule_heating,
+       collector_joule_heating}};
+  std::array<double, 6> global_values;
+  MPI_Allreduce(local_values.data(), global_values.data(), local_values.size(),
+                MPI_DOUBLE, MPI_SUM, this->_communicator);
+
+  this->values["anode_potential"] = global_values[0] / global_values[1];
+  this->values["cathode_potential"] = global_values[2] / global_values[3];
+  // Report the Joule heating of the whole stack when only a unit cell is
+  // meshed. The collectors are not counted twice: a collector shared by two
+  // cells of the stack carries the current of both, i.e., it dissipates four
+  // times the heat of a collector of the unit cell. With n cells, the two
+  // outer collectors and the n - 1 shared ones dissipate
+  // (2 + 4 (n - 1)) / 2 = 2 n - 1 times the heat of the collectors of the
+  // unit cell.
+  double const n_unit_cells = _geometry->get_n_unit_cells();
+  this->values["joule_heating"] = n_unit_cells * global_values[4] +
+                                  (n_unit_cells - 1.) * global_values[5];
+  _cell_quantities_up_to_date = true;
+  if (fields)
+    _cell_fields_up_to_date = true;
 }
 
 } // end namespace cap
@@ -5,6 +5,7 @@
  * for the text and further information on this license.
  */
 
+#include <cap/equivalent_circuit.h>
 #include <cap/supercapacitor.templates.h>
 
 namespace cap
@@ -23,7 +24,17 @@ public:
         boost::mpi::communicator const &comm) override
   {
     int const dim = ptree.get<int>("dim");
-    if (dim == 2)
+    // In one dimension, the sandwich is modeled through its thickness. The
+    // distributed triangulations of deal.II do not support dim = 1 but the
+    // discretization of the porous electrodes by a transmission line is
+    // equivalent and its tridiagonal system is solved directly.
+    if (dim == 1)
+    {
+      boost::property_tree::ptree transmission_line_database;
+      compute_transmission_line(ptree, transmission_line_database);
+      return EnergyStorageDevice::build(transmission_line_database, comm);
+    }
+    else if (dim == 2)
       return std::make_unique<SuperCapacitor<2>>(
           SuperCapacitor<2>(ptree, comm));
     else if (dim == 3)
@@ -31,12 +42,14 @@ public:
           SuperCapacitor<3>(ptree, comm));
     else
       throw std::runtime_error("dim=" + std::to_string(dim) +
-                               " must be 2 or 3");
+                               " must be 1, 2 or 3");
   }
 } global_SuperCapacitorBuilder;
 
 template class SuperCapacitorInspector<2>;
 template class SuperCapacitorInspector<3>;
+template class ProbeInspector<2>;
+template class ProbeInspector<3>;
 template class SuperCapacitor<2>;
 template class SuperCapacitor<3>;
 
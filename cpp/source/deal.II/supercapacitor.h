@@ -15,6 +15,7 @@
 #include <cap/timer.h>
 #include <deal.II/fe/fe_system.h>
 #include <deal.II/lac/block_vector.h>
+#include <map>
 #include <memory>
 #include <iostream>
 
@@ -34,6 +35,25 @@ public:
   void inspect(EnergyStorageDevice *device) override;
 };
 
+template <int dim>
+class ProbeInspector : public EnergyStorageDeviceInspector
+{
+public:
+  ProbeInspector() = default;
+
+  /**
+   * Extract the solid potential, the liquid potential, and the overpotential
+   * at the probes defined in the @c probes section of the input, as well as
+   * the coordinates of the probes (position_0, position_1, ...).
+   */
+  void inspect(EnergyStorageDevice *device) override;
+
+  std::map<std::string, std::vector<double>> const &get_data() const;
+
+private:
+  std::map<std::string, std::vector<double>> _data;
+};
+
 template <int dim>
 class SuperCapacitor : public EnergyStorageDevice
 {
@@ -90,6 +110,13 @@ public:
    */
   std::shared_ptr<Geometry<dim>> get_geometry() const;
 
+  /**
+   * Return the ElectrochemicalPhysics used by the last time step, nullptr
+   * before the first time step.
+   */
+  std::shared_ptr<ElectrochemicalPhysics<dim> const>
+  get_electrochemical_physics() const;
+
   /**
    * Granting access to the post-processor parameters for the inspector.
    */
@@ -186,6 +213,9 @@ private:
 
   template <int dimension>
   friend class SuperCapacitorInspector;
+
+  template <int dimension>
+  friend class ProbeInspector;
 };
 }
 
@@ -58,11 +58,21 @@ void SuperCapacitorInspector<dim>::inspect(EnergyStorageDevice *device)
   for (auto &subdom : subdomain)
     subdom = local_subdomain_id;
   data_out.add_data_vector(subdomain, "subdomain");
-  // Output the required quantities
-  if (!keys.empty())
+  // Output the required quantities. The post-processor only stores the
+  // values of the locally owned cells, DataOut needs one value per active
+  // cell.
+  std::vector<dealii::Vector<float>> fields;
+  fields.reserve(keys.size());
+  for (std::string const &key : keys)
   {
-    for (std::string const &key : keys)
-      data_out.add_data_vector(supercapacitor->_post_processor->get(key), key);
+    dealii::Vector<float> const &locally_owned_values =
+        supercapacitor->_post_processor->get(key);
+    fields.emplace_back(triangulation->n_active_cells());
+    unsigned int k = 0;
+    for (auto cell : triangulation->active_cell_iterators())
+      if (cell->is_locally_owned())
+        fields.back()[cell->active_cell_index()] = locally_owned_values[k++];
+    data_out.add_data_vector(fields.back(), key);
   }
   data_out.build_patches();
   std::string const filename =
@@ -88,6 +98,37 @@ void SuperCapacitorInspector<dim>::inspect(EnergyStorageDevice *device)
   ++i;
 }
 
+template <int dim>
+void ProbeInspector<dim>::inspect(EnergyStorageDevice *device)
+{
+  SuperCapacitor<dim> *supercapacitor =
+      dynamic_cast<SuperCapacitor<dim> *>(device);
+  if (supercapacitor == nullptr)
+    throw std::bad_cast();
+
+  auto const &post_processor = supercapacitor->_post_processor;
+  _data.clear();
+  for (std::string const &key :
+       {"solid_potential", "liquid_potential", "overpotential"})
+    _data[key] = post_processor->get_probe_values(key);
+  std::vector<dealii::Point<dim>> const &positions =
+      post_processor->get_probe_positions();
+  for (int d = 0; d < dim; ++d)
+  {
+    std::vector<double> &coordinates = _data["position_" + std::to_string(d)];
+    coordinates.reserve(positions.size());
+    for (auto const &point : positions)
+      coordinates.push_back(point[d]);
+  }
+}
+
+template <int dim>
+std::map<std::string, std::vector<double>> const &
+ProbeInspector<dim>::get_data() const
+{
+  return _data;
+}
+
 template <int dim>
 SuperCapacitor<dim>::SuperCapacitor(boost::property_tree::ptree const &ptree,
                                     boost::mpi::communicator const &comm)
@@ -371,6 +412,13 @@ std::shared_ptr<Geometry<dim>> SuperCapacitor<dim>::get_geometry() const
   return _geometry;
 }
 
+template <int dim>
+std::shared_ptr<ElectrochemicalPhysics<dim> const>
+SuperCapacitor<dim>::get_electrochemical_physics() const
+{
+  return _electrochemical_physics;
+}
+
 template <int dim>
 std::shared_ptr<PostprocessorParameters<dim>>
 SuperCapacitor<dim>::get_post_processor_parameters() const
@@ -518,14 +566,31 @@ void SuperCapacitor<dim>::setup()
   _electrochemical_physics_params->dof_handler = _dof_handler;
   _electrochemical_physics_params->mp_values =
       std::dynamic_pointer_cast<MPValues<dim> const>(mp_values);
+  // The material properties do not change during the simulation. Evaluate
+  // them once for both the physics and the post-processor.
+  _electrochemical_physics_params->mp_values_table =
+      std::make_shared<MPValuesTable<dim>>(
+          *mp_values,
+          std::vector<std::string>{
+              "specific_capacitance", "solid_electrical_conductivity",
+              "liquid_electrical_conductivity", "faradaic_reaction_coefficient",
+              "density", "density_of_active_material",
+              "specific_surface_area"},
+          *_dof_handler, dealii::QGauss<dim>(_fe->degree + 1));
+  // Check once that the collectors can be treated as equipotential regions
+  // rather than every time the physics is rebuilt.
+  if (_ptree.get("equipotential_collectors", false))
+    check_equipotential_collectors(*_electrochemical_physics_params,
+                                   this->_communicator);
 
   // Compute the surface area. This is neeeded by several evolve_one_time_step_*
   _surface_area = 0.;
   auto const &cathode_boundary_ids = (*_geometry->get_boundaries())["cathode"];
   dealii::QGauss<dim - 1> face_quadrature_rule(_fe->degree + 1);
   unsigned int const n_face_q_points = face_quadrature_rule.size();
-  dealii::FEFaceValues<dim> fe_face_values(*_fe, face_quadrature_rule,
-                                           dealii::update_JxW_values);
+  dealii::FEFaceValues<dim> fe_face_values(
+      *_fe, face_quadrature_rule,
+      dealii::update_JxW_values | dealii::update_quadrature_points);
   for (auto cell :
        dealii::filter_iterators(_dof_handler->active_cell_iterators(),
                                 dealii::IteratorFilters::LocallyOwnedCell(),
@@ -538,11 +603,16 @@ void SuperCapacitor<dim>::setup()
              ++face_q_point)
         {
           fe_face_values.reinit(cell, face);
-          _surface_area += fe_face_values.JxW(face_q_point);
+          _surface_area += fe_face_values.JxW(face_q_point) *
+                           _geometry->get_measure_factor(
+                               fe_face_values.quadrature_point(face_q_point));
         }
-  // Reduce the value computed on each processor.
+  // Reduce the value computed on each processor. When the mesh is a unit cell
+  // of the stack, the surface area is the one of the whole stack so that the
+  // current density is the one seen by each cell.
   _surface_area =
-      dealii::Utilities::MPI::sum(_surface_area, this->_communicator);
+      dealii::Utilities::MPI::sum(_surface_area, this->_communicator) *
+      _geometry->get_n_unit_cells();
 
   // Create the post-processor parameters
   _post_processor_params =
@@ -559,6 +629,8 @@ void SuperCapacitor<dim>::setup()
   _post_processor_params->solution = _solution;
   _post_processor_params->mp_values =
       _electrochemical_physics_params->mp_values;
+  _post_processor_params->mp_values_table =
+      _electrochemical_physics_params->mp_values_table;
   _post_processor = std::make_shared<SuperCapacitorPostprocessor<dim>>(
       _post_processor_params, _geometry, this->_communicator);
 
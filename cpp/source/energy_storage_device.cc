@@ -6,6 +6,8 @@
  */
 
 #include <cap/energy_storage_device.h>
+#include <stdexcept>
+#include <tuple>
 
 namespace cap
 {
@@ -49,6 +51,43 @@ EnergyStorageDevice::EnergyStorageDevice(
 
 EnergyStorageDevice::~EnergyStorageDevice() = default;
 
+bool EnergyStorageDevice::has_closed_form_response() const { return false; }
+
+void EnergyStorageDevice::evolve_over_interval_constant_current(
+    double const duration, double const current, double &charge,
+    double &energy)
+{
+  std::ignore = duration;
+  std::ignore = current;
+  std::ignore = charge;
+  std::ignore = energy;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void EnergyStorageDevice::evolve_over_interval_constant_voltage(
+    double const duration, double const voltage, double &charge,
+    double &energy)
+{
+  std::ignore = duration;
+  std::ignore = voltage;
+  std::ignore = charge;
+  std::ignore = energy;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void EnergyStorageDevice::evolve_over_interval_constant_load(
+    double const duration, double const load, double &charge, double &energy)
+{
+  std::ignore = duration;
+  std::ignore = load;
+  std::ignore = charge;
+  std::ignore = energy;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
 boost::mpi::communicator EnergyStorageDevice::get_mpi_communicator() const
 {
   return _communicator;
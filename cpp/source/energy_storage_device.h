@@ -96,6 +96,51 @@ public:
   virtual void evolve_one_time_step_linear_load(double const time_step,
                                                 double const load) = 0;
 
+  /**
+   * Return true if the response of the device to a constant current, voltage,
+   * or load is known in closed form, i.e. if the evolve_over_interval_*
+   * functions can advance the device by an arbitrarily long interval in a
+   * single call. The default implementation returns false.
+   */
+  virtual bool has_closed_form_response() const;
+
+  /**
+   * Advance the time by @p duration seconds in a single call. The current is
+   * constant during the interval and its value is @p current amperes. On
+   * return, @p charge and @p energy contain the charge in coulombs and the
+   * energy in joules that entered the device during the interval. The default
+   * implementation throws an exception.
+   */
+  virtual void evolve_over_interval_constant_current(double const duration,
+                                                     double const current,
+                                                     double &charge,
+                                                     double &energy);
+
+  /**
+   * Advance the time by @p duration seconds in a single call. The voltage is
+   * constant during the interval and its value is @p voltage volts. On
+   * return, @p charge and @p energy contain the charge in coulombs and the
+   * energy in joules that entered the device during the interval. The default
+   * implementation throws an exception.
+   */
+  virtual void evolve_over_interval_constant_voltage(double const duration,
+                                                     double const voltage,
+                                                     double &charge,
+                                                     double &energy);
+
+  /**
+   * Advance the time by @p duration seconds in a single call. The load is
+   * constant during the interval and its value is @p load ohms. On return,
+   * @p charge and @p energy contain the charge in coulombs and the energy in
+   * joules that entered the device during the interval (they are negative
+   * since the device discharges in the load). The default implementation
+   * throws an exception.
+   */
+  virtual void evolve_over_interval_constant_load(double const duration,
+                                                  double const load,
+                                                  double &charge,
+                                                  double &energy);
+
   /**
    * Save the current state of the energy storage device in a file.
    */
@@ -0,0 +1,319 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/energy_storage_device.h>
+#include <cap/equivalent_circuit.h>
+#include <cap/material_properties.h>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace cap
+{
+
+namespace internal
+{
+/**
+ * Geometry and material properties of the sandwich, in SI units.
+ */
+struct SandwichProperties
+{
+  double cross_sectional_area;
+  double electrode_width;
+  double separator_width;
+  double collector_width;
+  double electrode_specific_capacitance;
+  double electrode_solid_electrical_conductivity;
+  double electrode_liquid_electrical_conductivity;
+  double electrode_exchange_current_density;
+  double separator_liquid_electrical_conductivity;
+  double collector_solid_electrical_conductivity;
+};
+
+void append_to_key(std::ostringstream &key,
+                   boost::property_tree::ptree const &database)
+{
+  for (auto const &entry : database)
+    key << entry.first << " " << entry.second.data() << "\n";
+}
+
+// The sandwich properties only depend on four values of the geometry
+// database, on the anode, separator, and collector entries of the
+// material_properties database, on the phases they refer to, and on a few
+// physical constants. The key is made of these values only.
+std::string
+make_sandwich_properties_key(boost::property_tree::ptree const &input_database)
+{
+  std::ostringstream key;
+  key << std::setprecision(17);
+  for (std::string const path :
+       {"geometry.geometric_area", "geometry.anode_electrode_thickness",
+        "geometry.separator_thickness", "geometry.anode_collector_thickness"})
+    key << input_database.get<double>(path) << "\n";
+  boost::property_tree::ptree const &material_properties_database =
+      input_database.get_child("material_properties");
+  for (std::string const material : {"anode", "separator", "collector"})
+  {
+    boost::property_tree::ptree const &material_database =
+        material_properties_database.get_child(material);
+    key << material << "\n";
+    append_to_key(key, material_database);
+    for (std::string const phase :
+         {"matrix_phase", "solution_phase", "metal_foil"})
+    {
+      auto const phase_name =
+          material_database.get_optional<std::string>(phase);
+      if (phase_name)
+        append_to_key(key, material_properties_database.get_child(*phase_name));
+    }
+  }
+  for (std::string const constant :
+       {"anodic_charge_transfer_coefficient",
+        "cathodic_charge_transfer_coefficient", "faraday_constant",
+        "gas_constant", "temperature"})
+    key << constant << " "
+        << material_properties_database.get<std::string>(constant, "") << "\n";
+  return key.str();
+}
+
+SandwichProperties compute_sandwich_properties(
+    boost::property_tree::ptree const &input_database)
+{
+  auto to_meters = [](double const &cm)
+  {
+    return 0.01 * cm;
+  };
+  auto to_square_meters = [](double const &cm2)
+  {
+    return 0.0001 * cm2;
+  };
+
+  SandwichProperties properties;
+  properties.cross_sectional_area =
+      to_square_meters(input_database.get<double>("geometry.geometric_area"));
+  // clang-format off
+  properties.electrode_width = to_meters(input_database.get<double>("geometry.anode_electrode_thickness"));
+  properties.separator_width = to_meters(input_database.get<double>("geometry.separator_thickness"      ));
+  properties.collector_width = to_meters(input_database.get<double>("geometry.anode_collector_thickness"));
+  // clang-format on
+
+  // getting the material parameters values
+  boost::property_tree::ptree const &material_properties_database =
+      input_database.get_child("material_properties");
+  // electrode
+  auto electrode =
+      compute_material_properties(material_properties_database, "anode");
+  properties.electrode_solid_electrical_conductivity =
+      electrode["solid_electrical_conductivity"];
+  properties.electrode_liquid_electrical_conductivity =
+      electrode["liquid_electrical_conductivity"];
+  properties.electrode_specific_capacitance =
+      electrode["specific_capacitance"];
+  properties.electrode_exchange_current_density =
+      electrode["faradaic_reaction_coefficient"];
+  // separator
+  auto separator =
+      compute_material_properties(material_properties_database, "separator");
+  properties.separator_liquid_electrical_conductivity =
+      separator["liquid_electrical_conductivity"];
+  // collector
+  auto collector =
+      compute_material_properties(material_properties_database, "collector");
+  properties.collector_solid_electrical_conductivity =
+      collector["solid_electrical_conductivity"];
+
+  return properties;
+}
+
+// reads the geometry and the material properties from the database for the
+// finite element model. The results are memoized since sweeps typically
+// build many devices from the same materials.
+SandwichProperties
+read_sandwich_properties(boost::property_tree::ptree const &input_database)
+{
+  static std::mutex mutex;
+  static std::unordered_map<std::string, SandwichProperties> cache;
+  std::size_t const max_cache_size = 1024;
+
+  std::string const key = make_sandwich_properties_key(input_database);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto const got = cache.find(key);
+    if (got != cache.end())
+      return got->second;
+  }
+  SandwichProperties const properties =
+      compute_sandwich_properties(input_database);
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cache.size() >= max_cache_size)
+    cache.clear();
+  cache.emplace(key, properties);
+  return properties;
+}
+} // end namespace internal
+
+// reads database for finite element model and write database for equivalent
+// circuit model
+void compute_equivalent_circuit(
+    boost::property_tree::ptree const &input_database,
+    boost::property_tree::ptree &output_database)
+{
+  // TODO: of course we could clear the database or just overwrite but for
+  // now let's just throw an exception if it is not empty
+  if (!output_database.empty())
+    throw std::runtime_error("output_database was not empty...");
+
+  internal::SandwichProperties const p =
+      internal::read_sandwich_properties(input_database);
+  double const cross_sectional_area = p.cross_sectional_area;
+  double const electrode_width = p.electrode_width;
+  double const separator_width = p.separator_width;
+  double const collector_width = p.collector_width;
+
+  // electrode
+  double const electrode_resistivity =
+      (1.0 / p.electrode_solid_electrical_conductivity +
+       1.0 / p.electrode_liquid_electrical_conductivity +
+       1.0 / (p.electrode_solid_electrical_conductivity +
+              p.electrode_liquid_electrical_conductivity)) /
+      3.0;
+  double const electrode_resistance =
+      electrode_resistivity * electrode_width / cross_sectional_area;
+  double const electrode_capacitance = p.electrode_specific_capacitance *
+                                       electrode_width * cross_sectional_area;
+  double const electrode_leakage_resistance =
+      1.0 / (p.electrode_exchange_current_density * electrode_width *
+             cross_sectional_area);
+  // separator
+  double const separator_resistivity =
+      1.0 / p.separator_liquid_electrical_conductivity;
+  double const separator_resistance =
+      separator_resistivity * separator_width / cross_sectional_area;
+  // collector
+  double const collector_resistivity =
+      1.0 / p.collector_solid_electrical_conductivity;
+  double const collector_resistance =
+      collector_resistivity * collector_width / cross_sectional_area;
+
+  // compute the effective resistance and capacitance
+  double const sandwich_capacitance = electrode_capacitance / 2.0;
+  double const sandwich_resistance = 2.0 * electrode_resistance +
+                                     separator_resistance +
+                                     2.0 * collector_resistance;
+  double const sandwich_leakage_resistance = 2.0 * electrode_leakage_resistance;
+
+  output_database.put("capacitance", sandwich_capacitance);
+  output_database.put("series_resistance", sandwich_resistance);
+  output_database.put("parallel_resistance", sandwich_leakage_resistance);
+  if (std::isfinite(sandwich_leakage_resistance))
+    output_database.put("type", "ParallelRC");
+  else
+    output_database.put("type", "SeriesRC");
+}
+
+class EquivalentCircuitBuilder : public EnergyStorageDeviceBuilder
+{
+public:
+  EquivalentCircuitBuilder()
+  {
+    register_energy_storage_device("EquivalentCircuit", this);
+  }
+  std::unique_ptr<EnergyStorageDevice>
+  build(boost::property_tree::ptree const &ptree,
+        boost::mpi::communicator const &comm) override
+  {
+    boost::property_tree::ptree other;
+    compute_equivalent_circuit(ptree, other);
+    return EnergyStorageDevice::build(other, comm);
+  }
+} global_EquivalentCircuitBuilder;
+
+void compute_equivalent_circuit(
+    std::vector<boost::property_tree::ptree> const &input_databases,
+    std::vector<boost::property_tree::ptree> &output_databases)
+{
+  if (!output_databases.empty())
+    throw std::runtime_error("output_databases was not empty...");
+
+  output_databases.resize(input_databases.size());
+  for (std::size_t i = 0; i < input_databases.size(); ++i)
+    compute_equivalent_circuit(input_databases[i], output_databases[i]);
+}
+
+void compute_transmission_line(
+    boost::property_tree::ptree const &input_database,
+    boost::property_tree::ptree &output_database)
+{
+  if (!output_database.empty())
+    throw std::runtime_error("output_database was not empty...");
+
+  internal::SandwichProperties const p =
+      internal::read_sandwich_properties(input_database);
+  double const area = p.cross_sectional_area;
+
+  // Each electrode is a transmission line. The two electrodes in series
+  // behave as a single line with twice the resistances and half the
+  // capacitance.
+  double const electrode_solid_resistance =
+      p.electrode_width / (p.electrode_solid_electrical_conductivity * area);
+  double const electrode_liquid_resistance =
+      p.electrode_width / (p.electrode_liquid_electrical_conductivity * area);
+  double const electrode_capacitance =
+      p.electrode_specific_capacitance * p.electrode_width * area;
+  double const electrode_leakage_resistance =
+      1.0 / (p.electrode_exchange_current_density * p.electrode_width * area);
+  double const separator_resistance =
+      p.separator_width / (p.separator_liquid_electrical_conductivity * area);
+  double const collector_resistance =
+      p.collector_width / (p.collector_solid_electrical_conductivity * area);
+
+  output_database.put("type", "TransmissionLine");
+  output_database.put("n_segments",
+                      input_database.get<std::size_t>("n_segments", 50));
+  output_database.put("series_resistance",
+                      separator_resistance + 2.0 * collector_resistance);
+  output_database.put("solid_resistance", 2.0 * electrode_solid_resistance);
+  output_database.put("liquid_resistance", 2.0 * electrode_liquid_resistance);
+  output_database.put("capacitance", electrode_capacitance / 2.0);
+  if (std::isfinite(electrode_leakage_resistance))
+    output_database.put("leakage_resistance",
+                        2.0 * electrode_leakage_resistance);
+}
+
+class EquivalentTransmissionLineBuilder : public EnergyStorageDeviceBuilder
+{
+public:
+  EquivalentTransmissionLineBuilder()
+  {
+    register_energy_storage_device("EquivalentTransmissionLine", this);
+  }
+  std::unique_ptr<EnergyStorageDevice>
+  build(boost::property_tree::ptree const &ptree,
+        boost::mpi::communicator const &comm) override
+  {
+    boost::property_tree::ptree other;
+    compute_transmission_line(ptree, other);
+    return EnergyStorageDevice::build(other, comm);
+  }
+} global_EquivalentTransmissionLineBuilder;
+
+void compute_transmission_line(
+    std::vector<boost::property_tree::ptree> const &input_databases,
+    std::vector<boost::property_tree::ptree> &output_databases)
+{
+  if (!output_databases.empty())
+    throw std::runtime_error("output_databases was not empty...");
+
+  output_databases.resize(input_databases.size());
+  for (std::size_t i = 0; i < input_databases.size(); ++i)
+    compute_transmission_line(input_databases[i], output_databases[i]);
+}
+
+} // end namespace cap
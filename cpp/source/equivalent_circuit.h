@@ -0,0 +1,56 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_EQUIVALENT_CIRCUIT_H
+#define CAP_EQUIVALENT_CIRCUIT_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <vector>
+
+namespace cap
+{
+
+/**
+ * Read the database of the finite element model and write the database of
+ * the equivalent SeriesRC or ParallelRC circuit. Only the @c geometry and @c
+ * material_properties databases are used and no mesh is built. The material
+ * properties of the sandwich are memoized so that building many circuits
+ * from the same materials is cheap. Throw an exception if @p output_database
+ * is not empty.
+ */
+void compute_equivalent_circuit(
+    boost::property_tree::ptree const &input_database,
+    boost::property_tree::ptree &output_database);
+
+/**
+ * Batch version of the function above. @p output_databases must be empty;
+ * it is resized to match @p input_databases.
+ */
+void compute_equivalent_circuit(
+    std::vector<boost::property_tree::ptree> const &input_databases,
+    std::vector<boost::property_tree::ptree> &output_databases);
+
+/**
+ * Read the database of the finite element model and write the database of a
+ * TransmissionLine with @c n_segments segments (read from @p input_database,
+ * 50 by default). The two electrodes of the sandwich are lumped in a single
+ * transmission line. Throw an exception if @p output_database is not empty.
+ */
+void compute_transmission_line(
+    boost::property_tree::ptree const &input_database,
+    boost::property_tree::ptree &output_database);
+
+/**
+ * Batch version of the function above.
+ */
+void compute_transmission_line(
+    std::vector<boost::property_tree::ptree> const &input_databases,
+    std::vector<boost::property_tree::ptree> &output_databases);
+
+} // end namespace cap
+
+#endif // CAP_EQUIVALENT_CIRCUIT_H
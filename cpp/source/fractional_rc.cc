@@ -0,0 +1,230 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/fractional_rc.h>
+#include <cap/rc_propagator.h>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/math/constants/constants.hpp>
+#include <boost/serialization/vector.hpp>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace cap
+{
+
+REGISTER_ENERGY_STORAGE_DEVICE(FractionalRC)
+
+FractionalRC::FractionalRC(boost::property_tree::ptree const &ptree,
+                           boost::mpi::communicator const &comm)
+    : EnergyStorageDevice(comm),
+      _series_resistance(ptree.get<double>("series_resistance")),
+      _power_solver(string_to_power_solver(
+          ptree.get<std::string>("power_solver", "CLOSED_FORM"))),
+      _propagator_delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _total_charge(0.0), _total_ramp(0.0), _I(0.0)
+{
+  double const Q = ptree.get<double>("cpe_coefficient");
+  double const alpha = ptree.get<double>("cpe_exponent");
+  std::size_t const n_modes = ptree.get<std::size_t>("n_modes", 40);
+  double const min_time_constant =
+      ptree.get<double>("min_time_constant", 1.0e-3);
+  double const max_time_constant =
+      ptree.get<double>("max_time_constant", 1.0e6);
+  if (!(alpha > 0.0) || !(alpha < 1.0))
+    throw std::runtime_error("The exponent of the constant-phase element "
+                             "must be strictly between 0 and 1");
+  if (!(Q > 0.0))
+    throw std::runtime_error("The coefficient of the constant-phase element "
+                             "must be positive");
+  if (n_modes < 2)
+    throw std::runtime_error("At least two modes are required");
+  if (!(min_time_constant > 0.0) ||
+      !(max_time_constant > min_time_constant))
+    throw std::runtime_error("Invalid range of time constants");
+
+  // The kernel t^(alpha-1) / Gamma(alpha) is the integral over the rates s of
+  // sin(pi alpha) / pi s^(-alpha) exp(-s t). The integral is discretized
+  // with the trapezoidal rule in log(s).
+  double const pi = boost::math::constants::pi<double>();
+  double const scaling = std::sin(pi * alpha) / (pi * Q);
+  double const min_rate = 1.0 / max_time_constant;
+  double const max_rate = 1.0 / min_time_constant;
+  double const h = std::log(max_rate / min_rate) / (n_modes - 1);
+  // The rates smaller than min_rate are lumped in a capacitor.
+  _rates.push_back(0.0);
+  _gains.push_back(scaling * std::pow(min_rate, 1.0 - alpha) / (1.0 - alpha));
+  for (std::size_t j = 0; j < n_modes; ++j)
+  {
+    double const rate = min_rate * std::exp(j * h);
+    double const weight = ((j == 0) || (j == n_modes - 1)) ? 0.5 : 1.0;
+    _rates.push_back(rate);
+    _gains.push_back(scaling * weight * h * std::pow(rate, 1.0 - alpha));
+  }
+  // The rates larger than max_rate reach their steady state instantly and
+  // are lumped in a resistance.
+  _series_resistance += scaling * std::pow(max_rate, -alpha) / alpha;
+
+  _v.assign(_rates.size(), 0.0);
+  _v[0] = ptree.get<double>("initial_voltage", 0.0);
+  _U = _v[0];
+}
+
+void FractionalRC::inspect(EnergyStorageDeviceInspector *inspector)
+{
+  inspector->inspect(this);
+}
+
+void FractionalRC::update_propagators(double const delta_t)
+{
+  if (delta_t == _propagator_delta_t)
+    return;
+  _propagator_delta_t = delta_t;
+  std::size_t const n = _rates.size();
+  _decay.resize(n);
+  _charge.resize(n);
+  _ramp.resize(n);
+  _total_charge = 0.0;
+  _total_ramp = 0.0;
+  for (std::size_t j = 0; j < n; ++j)
+  {
+    double const x = _rates[j] * delta_t;
+    _decay[j] = std::exp(-x);
+    _charge[j] = _gains[j] * delta_t * internal::phi(x);
+    _ramp[j] = _gains[j] * delta_t * internal::psi(x);
+    _total_charge += _charge[j];
+    _total_ramp += _ramp[j];
+  }
+}
+
+double FractionalRC::get_equilibrium_voltage() const
+{
+  double U_eq = 0.0;
+  for (std::size_t j = 0; j < _v.size(); ++j)
+    U_eq += _decay[j] * _v[j];
+  return U_eq;
+}
+
+void FractionalRC::advance(double const current_0, double const current_1)
+{
+  double voltage = _series_resistance * current_1;
+  for (std::size_t j = 0; j < _v.size(); ++j)
+  {
+    _v[j] = _decay[j] * _v[j] + _charge[j] * current_0 +
+            _ramp[j] * (current_1 - current_0);
+    voltage += _v[j];
+  }
+  _I = current_1;
+  _U = voltage;
+}
+
+void FractionalRC::evolve_one_time_step_constant_current(double const delta_t,
+                                                         double const current)
+{
+  update_propagators(delta_t);
+  advance(current, current);
+}
+
+void FractionalRC::evolve_one_time_step_linear_current(double const delta_t,
+                                                       double const current)
+{
+  update_propagators(delta_t);
+  advance(_I, current);
+}
+
+void FractionalRC::evolve_one_time_step_constant_voltage(double const delta_t,
+                                                         double const voltage)
+{
+  update_propagators(delta_t);
+  double const current = (voltage - get_equilibrium_voltage()) /
+                         (_series_resistance + _total_charge);
+  advance(current, current);
+}
+
+void FractionalRC::evolve_one_time_step_linear_voltage(double const delta_t,
+                                                       double const voltage)
+{
+  update_propagators(delta_t);
+  double const current =
+      (voltage - get_equilibrium_voltage() -
+       (_total_charge - _total_ramp) * _I) /
+      (_series_resistance + _total_ramp);
+  advance(_I, current);
+}
+
+void FractionalRC::evolve_one_time_step_constant_power(double const delta_t,
+                                                       double const power)
+{
+  update_propagators(delta_t);
+  double current;
+  solve_constant_power(_series_resistance + _total_charge,
+                       get_equilibrium_voltage(), power, _power_solver, _U,
+                       current);
+  advance(current, current);
+}
+
+void FractionalRC::evolve_one_time_step_constant_load(double const delta_t,
+                                                      double const load)
+{
+  update_propagators(delta_t);
+  double const current = -get_equilibrium_voltage() /
+                         (_series_resistance + _total_charge + load);
+  advance(current, current);
+}
+
+void FractionalRC::evolve_one_time_step_linear_power(double const delta_t,
+                                                     double const power)
+{
+  std::ignore = delta_t;
+  std::ignore = power;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void FractionalRC::evolve_one_time_step_linear_load(double const delta_t,
+                                                    double const load)
+{
+  std::ignore = delta_t;
+  std::ignore = load;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void FractionalRC::save(const std::string &filename) const
+{
+  if (_communicator.rank() == 0)
+  {
+    std::ofstream ofs(filename);
+    boost::archive::text_oarchive oa(ofs);
+    oa << _v << _U << _I;
+  }
+}
+
+void FractionalRC::load(const std::string &filename)
+{
+  if (_communicator.rank() == 0)
+  {
+    // Check that the file exist
+    if (boost::filesystem::exists(filename) == false)
+      throw std::runtime_error("The file " + filename + " does not exists.");
+
+    std::ifstream ifs(filename);
+    if (ifs.good() == false)
+      throw std::runtime_error("Error while opening file " + filename);
+    boost::archive::text_iarchive ia(ifs);
+    std::vector<double> v;
+    ia >> v >> _U >> _I;
+    if (v.size() != _v.size())
+      throw std::runtime_error("The file " + filename +
+                               " does not match the number of modes");
+    _v = v;
+  }
+}
+} // end namespace cap
@@ -0,0 +1,143 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_FRACTIONAL_RC_H
+#define CAP_FRACTIONAL_RC_H
+
+#include <cap/energy_storage_device.h>
+#include <cap/resistor_capacitor.h>
+#include <string>
+#include <vector>
+
+namespace cap
+{
+
+/**
+ * A resistor in series with a constant-phase element (CPE) of impedance
+ * @f$ 1 / (Q (j\omega)^\alpha) @f$, with @f$ 0 < \alpha < 1 @f$.
+ * @code
+ * type                FractionalRC
+ * series_resistance   50.0e-3 ; [ohm]
+ * cpe_coefficient     3.0     ; Q [farad second^(alpha-1)]
+ * cpe_exponent        0.9     ; alpha
+ * n_modes             40      ; optional
+ * min_time_constant   1.0e-3  ; [second] optional
+ * max_time_constant   1.0e+6  ; [second] optional
+ * initial_voltage     0.0     ; [volt] optional
+ * @endcode
+ * The voltage across the CPE is the convolution of the current with the
+ * power-law kernel @f$ t^{\alpha-1} / (Q \Gamma(\alpha)) @f$, which would
+ * require the whole history of the current. Instead, the kernel is written
+ * as a superposition of exponentials whose rates are discretized with @c
+ * n_modes points evenly spaced on a logarithmic scale between the inverse of
+ * the time constants. The slower modes are lumped in a capacitor and the
+ * faster ones in a resistance. Each mode is a leaky capacitor advanced
+ * exactly, so that a time step and the memory cost O(n_modes) whatever the
+ * length of the simulation.
+ *
+ * The current is assumed constant during the time step when the voltage,
+ * the power, or the load is imposed (linear when the voltage changes
+ * linearly). The method used for the constant power operating condition is
+ * read from @c power_solver (CLOSED_FORM by default).
+ */
+class FractionalRC : public EnergyStorageDevice
+{
+public:
+  FractionalRC(boost::property_tree::ptree const &ptree,
+               boost::mpi::communicator const &comm);
+
+  void inspect(EnergyStorageDeviceInspector *inspector) override;
+
+  void evolve_one_time_step_constant_current(double const delta_t,
+                                             double const current) override;
+
+  void evolve_one_time_step_constant_voltage(double const delta_t,
+                                             double const voltage) override;
+
+  void evolve_one_time_step_constant_power(double const delta_t,
+                                           double const power) override;
+
+  void evolve_one_time_step_constant_load(double const delta_t,
+                                          double const load) override;
+
+  void evolve_one_time_step_linear_current(double const delta_t,
+                                           double const current) override;
+
+  void evolve_one_time_step_linear_voltage(double const delta_t,
+                                           double const voltage) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_power(double const delta_t,
+                                         double const power) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_load(double const delta_t,
+                                        double const load) override;
+
+  void get_voltage(double &voltage) const override { voltage = _U; }
+
+  void get_current(double &current) const override { current = _I; }
+
+  /**
+   * Return the number of exponential modes, including the one lumping the
+   * slowest modes.
+   */
+  std::size_t n_modes() const { return _rates.size(); }
+
+  /**
+   * Save the current state of the device in a file.
+   */
+  void save(const std::string &filename) const override;
+
+  /**
+   * Load the state of the device from a file.
+   */
+  void load(const std::string &filename) override;
+
+private:
+  /**
+   * Compute the coefficients of the modes for the time step @p delta_t if
+   * they have not already been computed.
+   */
+  void update_propagators(double const delta_t);
+
+  /**
+   * Return the voltage at the end of the time step in the absence of
+   * current.
+   */
+  double get_equilibrium_voltage() const;
+
+  /**
+   * Advance the modes by one time step. The current changes linearly from @p
+   * current_0 to @p current_1.
+   */
+  void advance(double const current_0, double const current_1);
+
+  double _series_resistance;
+  PowerSolver _power_solver;
+  // Rate and inverse capacitance of the modes.
+  std::vector<double> _rates;
+  std::vector<double> _gains;
+  double _propagator_delta_t;
+  std::vector<double> _decay;
+  std::vector<double> _charge;
+  std::vector<double> _ramp;
+  double _total_charge;
+  double _total_ramp;
+  // Voltage across the modes.
+  std::vector<double> _v;
+  double _U;
+  double _I;
+};
+
+} // end namespace cap
+
+#endif // CAP_FRACTIONAL_RC_H
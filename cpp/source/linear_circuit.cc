@@ -0,0 +1,613 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/linear_circuit.h>
+#include <cap/utils.h>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace cap
+{
+
+REGISTER_ENERGY_STORAGE_DEVICE(LinearCircuit)
+
+namespace internal
+{
+/**
+ * Read the values of the elements of the netlist.
+ */
+std::vector<double>
+read_element_values(boost::property_tree::ptree const &ptree)
+{
+  std::size_t const n_elements = ptree.get<std::size_t>("elements");
+  std::vector<double> values(n_elements);
+  for (std::size_t k = 0; k < n_elements; ++k)
+    values[k] = ptree.get<double>("element_" + std::to_string(k) + ".value");
+  return values;
+}
+
+/**
+ * LU factorization with partial pivoting of the @p n by @p n matrix @p M
+ * stored row-major. Return false if the matrix is singular.
+ */
+bool lu_factorize(std::vector<double> &M, std::vector<std::size_t> &pivots,
+                  std::size_t const n)
+{
+  double max_entry = 0.0;
+  for (double const m : M)
+    max_entry = std::max(max_entry, std::abs(m));
+  double const tolerance =
+      n * std::numeric_limits<double>::epsilon() * max_entry;
+  pivots.resize(n);
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    std::size_t p = k;
+    for (std::size_t i = k + 1; i < n; ++i)
+      if (std::abs(M[i * n + k]) > std::abs(M[p * n + k]))
+        p = i;
+    if (!(std::abs(M[p * n + k]) > tolerance))
+      return false;
+    pivots[k] = p;
+    if (p != k)
+      for (std::size_t j = 0; j < n; ++j)
+        std::swap(M[k * n + j], M[p * n + j]);
+    for (std::size_t i = k + 1; i < n; ++i)
+    {
+      double const l = M[i * n + k] / M[k * n + k];
+      M[i * n + k] = l;
+      for (std::size_t j = k + 1; j < n; ++j)
+        M[i * n + j] -= l * M[k * n + j];
+    }
+  }
+  return true;
+}
+
+/**
+ * Solve the linear system using the factorization computed by lu_factorize.
+ * The right-hand side @p b is overwritten by the solution.
+ */
+void lu_solve(std::vector<double> const &LU,
+              std::vector<std::size_t> const &pivots, std::vector<double> &b)
+{
+  std::size_t const n = b.size();
+  for (std::size_t k = 0; k < n; ++k)
+    std::swap(b[k], b[pivots[k]]);
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < i; ++j)
+      b[i] -= LU[i * n + j] * b[j];
+  for (std::size_t i = n; i-- > 0;)
+  {
+    for (std::size_t j = i + 1; j < n; ++j)
+      b[i] -= LU[i * n + j] * b[j];
+    b[i] /= LU[i * n + i];
+  }
+}
+
+/**
+ * Product of the @p n by @p n matrices @p A and @p B stored row-major.
+ */
+std::vector<double> multiply(std::vector<double> const &A,
+                             std::vector<double> const &B, std::size_t const n)
+{
+  std::vector<double> AB(n * n, 0.0);
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t k = 0; k < n; ++k)
+    {
+      double const a = A[i * n + k];
+      if (a != 0.0)
+        for (std::size_t j = 0; j < n; ++j)
+          AB[i * n + j] += a * B[k * n + j];
+    }
+  return AB;
+}
+
+/**
+ * Replace the @p n by @p n matrix @p M stored row-major by its exponential.
+ * The matrix is scaled such that its norm is smaller than 1/2, the
+ * exponential of the scaled matrix is evaluated with its Taylor series, and
+ * the result is squared back.
+ */
+void exponential(std::vector<double> &M, std::size_t const n)
+{
+  double norm = 0.0;
+  for (std::size_t j = 0; j < n; ++j)
+  {
+    double column_sum = 0.0;
+    for (std::size_t i = 0; i < n; ++i)
+      column_sum += std::abs(M[i * n + j]);
+    norm = std::max(norm, column_sum);
+  }
+  int squarings = 0;
+  if (norm > 0.5)
+    squarings = static_cast<int>(std::ceil(std::log2(norm / 0.5)));
+  double const scaling = std::ldexp(1.0, -squarings);
+  for (double &m : M)
+    m *= scaling;
+
+  // With a norm smaller than 1/2, 18 terms are enough to reach the machine
+  // precision.
+  std::vector<double> term(n * n, 0.0);
+  std::vector<double> sum(n * n, 0.0);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    term[i * n + i] = 1.0;
+    sum[i * n + i] = 1.0;
+  }
+  for (int k = 1; k <= 18; ++k)
+  {
+    term = multiply(term, M, n);
+    for (double &t : term)
+      t /= k;
+    for (std::size_t i = 0; i < n * n; ++i)
+      sum[i] += term[i];
+  }
+  for (int k = 0; k < squarings; ++k)
+    sum = multiply(sum, sum, n);
+  M.swap(sum);
+}
+} // end namespace internal
+
+LinearCircuit::Netlist::Netlist(boost::property_tree::ptree const &ptree)
+    : n_nodes(0), n_capacitors(0), n_inductors(0)
+{
+  std::size_t const n_elements = ptree.get<std::size_t>("elements");
+  if (n_elements == 0)
+    throw std::runtime_error("The circuit must contain at least one element");
+  types.resize(n_elements);
+  nodes.resize(n_elements);
+  for (std::size_t k = 0; k < n_elements; ++k)
+  {
+    boost::property_tree::ptree const &element =
+        ptree.get_child("element_" + std::to_string(k));
+    std::string const type = element.get<std::string>("type");
+    if (type.compare("resistor") == 0)
+      types[k] = RESISTOR;
+    else if (type.compare("capacitor") == 0)
+      types[k] = CAPACITOR;
+    else if (type.compare("inductor") == 0)
+      types[k] = INDUCTOR;
+    else
+      throw std::runtime_error("invalid element type " + type);
+    std::vector<unsigned int> const element_nodes =
+        to_vector<unsigned int>(element.get<std::string>("nodes"));
+    if ((element_nodes.size() != 2) || (element_nodes[0] == element_nodes[1]))
+      throw std::runtime_error("The element " + std::to_string(k) +
+                               " must be connected to two distinct nodes");
+    nodes[k] = {{element_nodes[0], element_nodes[1]}};
+    n_nodes = std::max<std::size_t>(
+        n_nodes, std::max(element_nodes[0], element_nodes[1]) + 1);
+  }
+  if (n_nodes < 2)
+    throw std::runtime_error("The node 1 (positive terminal) is not connected");
+
+  // The capacitors come first followed by the inductors.
+  states.assign(n_elements, 0);
+  for (std::size_t k = 0; k < n_elements; ++k)
+    if (types[k] == CAPACITOR)
+      states[k] = n_capacitors++;
+  for (std::size_t k = 0; k < n_elements; ++k)
+    if (types[k] == INDUCTOR)
+      states[k] = n_capacitors + n_inductors++;
+}
+
+LinearCircuit::LinearCircuit(boost::property_tree::ptree const &ptree,
+                             boost::mpi::communicator const &comm)
+    : LinearCircuit(std::make_shared<Netlist const>(ptree),
+                    internal::read_element_values(ptree), ptree, comm)
+{
+}
+
+LinearCircuit::LinearCircuit(std::shared_ptr<Netlist const> netlist,
+                             std::vector<double> const &values,
+                             boost::property_tree::ptree const &ptree,
+                             boost::mpi::communicator const &comm)
+    : EnergyStorageDevice(comm), _netlist(netlist),
+      _power_solver(string_to_power_solver(
+          ptree.get<std::string>("power_solver", "CLOSED_FORM"))),
+      _next_discretization(0), _U(0.0), _I(0.0)
+{
+  std::size_t const n_states = _netlist->n_capacitors + _netlist->n_inductors;
+  _x.assign(n_states, 0.0);
+  _x_tmp.assign(n_states, 0.0);
+  for (std::size_t k = 0; k < _netlist->types.size(); ++k)
+  {
+    std::string const element = "element_" + std::to_string(k);
+    if (_netlist->types[k] == Netlist::CAPACITOR)
+      _x[_netlist->states[k]] =
+          ptree.get<double>(element + ".initial_voltage", 0.0);
+    else if (_netlist->types[k] == Netlist::INDUCTOR)
+      _x[_netlist->states[k]] =
+          ptree.get<double>(element + ".initial_current", 0.0);
+  }
+  set_element_values(values);
+
+  // The device is initially at rest, i.e. no current flows through the
+  // terminals. If the current can not be imposed, the terminals are shorted.
+  if (_current_driven.valid)
+    _U = output(_current_driven);
+  else
+    _I = output(_voltage_driven);
+}
+
+void LinearCircuit::set_element_values(std::vector<double> const &values)
+{
+  if (values.size() != _netlist->types.size())
+    throw std::runtime_error("Expected " +
+                             std::to_string(_netlist->types.size()) +
+                             " element values, got " +
+                             std::to_string(values.size()));
+  for (double const value : values)
+    if (!(value > 0.0))
+      throw std::runtime_error("The values of the elements must be positive");
+  _values = values;
+  assemble();
+  for (auto &discretization : _discretizations)
+    discretization.delta_t = std::numeric_limits<double>::quiet_NaN();
+}
+
+std::vector<std::unique_ptr<LinearCircuit>>
+LinearCircuit::build_batch(
+    boost::property_tree::ptree const &ptree,
+    boost::mpi::communicator const &comm,
+    std::vector<std::vector<double>> const &element_values)
+{
+  auto netlist = std::make_shared<Netlist const>(ptree);
+  std::vector<std::unique_ptr<LinearCircuit>> circuits;
+  circuits.reserve(element_values.size());
+  for (auto const &values : element_values)
+    circuits.emplace_back(new LinearCircuit(netlist, values, ptree, comm));
+  return circuits;
+}
+
+void LinearCircuit::assemble()
+{
+  // The node voltages (the ground excluded) and the currents flowing through
+  // the capacitors are the unknowns of the modified nodal analysis. The
+  // capacitors act as voltage sources and the inductors as current sources.
+  // When the voltage is imposed, the current flowing out of the positive
+  // terminal is an additional unknown.
+  Netlist const &netlist = *_netlist;
+  std::size_t const n_nodes = netlist.n_nodes - 1;
+  std::size_t const n_capacitors = netlist.n_capacitors;
+  std::size_t const n_states = _x.size();
+  auto node = [](unsigned int const i) { return i - 1; };
+
+  for (Mode const mode : {CURRENT, VOLTAGE})
+  {
+    std::size_t const n = n_nodes + n_capacitors + (mode == VOLTAGE ? 1 : 0);
+    std::vector<double> M(n * n, 0.0);
+    for (std::size_t k = 0; k < netlist.types.size(); ++k)
+    {
+      unsigned int const a = netlist.nodes[k][0];
+      unsigned int const b = netlist.nodes[k][1];
+      if (netlist.types[k] == Netlist::RESISTOR)
+      {
+        double const G = 1.0 / _values[k];
+        if (a != 0)
+          M[node(a) * n + node(a)] += G;
+        if (b != 0)
+          M[node(b) * n + node(b)] += G;
+        if ((a != 0) && (b != 0))
+        {
+          M[node(a) * n + node(b)] -= G;
+          M[node(b) * n + node(a)] -= G;
+        }
+      }
+      else if (netlist.types[k] == Netlist::CAPACITOR)
+      {
+        std::size_t const j = n_nodes + netlist.states[k];
+        if (a != 0)
+        {
+          M[node(a) * n + j] += 1.0;
+          M[j * n + node(a)] += 1.0;
+        }
+        if (b != 0)
+        {
+          M[node(b) * n + j] -= 1.0;
+          M[j * n + node(b)] -= 1.0;
+        }
+      }
+    }
+    if (mode == VOLTAGE)
+    {
+      M[node(1) * n + n - 1] = 1.0;
+      M[(n - 1) * n + node(1)] = 1.0;
+    }
+
+    StateSpace &state_space =
+        (mode == CURRENT) ? _current_driven : _voltage_driven;
+    std::vector<std::size_t> pivots;
+    state_space.valid = internal::lu_factorize(M, pivots, n);
+    state_space.A.assign(n_states * n_states, 0.0);
+    state_space.B.assign(n_states, 0.0);
+    state_space.C.assign(n_states, 0.0);
+    state_space.D = 0.0;
+    if (!state_space.valid)
+      continue;
+
+    // Each column of the state-space form is the response of the network to
+    // a unit state variable or a unit input.
+    std::vector<double> z(n);
+    for (std::size_t c = 0; c <= n_states; ++c)
+    {
+      std::fill(z.begin(), z.end(), 0.0);
+      if (c == n_states)
+        z[(mode == CURRENT) ? node(1) : n - 1] = 1.0;
+      for (std::size_t k = 0; k < netlist.types.size(); ++k)
+        if ((netlist.types[k] != Netlist::RESISTOR) &&
+            (netlist.states[k] == c))
+        {
+          unsigned int const a = netlist.nodes[k][0];
+          unsigned int const b = netlist.nodes[k][1];
+          if (netlist.types[k] == Netlist::CAPACITOR)
+            z[n_nodes + c] = 1.0;
+          else if (netlist.types[k] == Netlist::INDUCTOR)
+          {
+            if (a != 0)
+              z[node(a)] -= 1.0;
+            if (b != 0)
+              z[node(b)] += 1.0;
+          }
+        }
+      internal::lu_solve(M, pivots, z);
+
+      for (std::size_t k = 0; k < netlist.types.size(); ++k)
+      {
+        std::size_t const s = netlist.states[k];
+        unsigned int const a = netlist.nodes[k][0];
+        unsigned int const b = netlist.nodes[k][1];
+        double derivative = 0.0;
+        if (netlist.types[k] == Netlist::CAPACITOR)
+          derivative = z[n_nodes + s] / _values[k];
+        else if (netlist.types[k] == Netlist::INDUCTOR)
+          derivative = ((a != 0 ? z[node(a)] : 0.0) -
+                        (b != 0 ? z[node(b)] : 0.0)) /
+                       _values[k];
+        else
+          continue;
+        if (c == n_states)
+          state_space.B[s] = derivative;
+        else
+          state_space.A[s * n_states + c] = derivative;
+      }
+      double const y = (mode == CURRENT) ? z[node(1)] : -z[n - 1];
+      if (c == n_states)
+        state_space.D = y;
+      else
+        state_space.C[c] = y;
+    }
+  }
+
+  if (!_current_driven.valid && !_voltage_driven.valid)
+    throw std::runtime_error("The circuit is singular, check that every node "
+                             "is connected to the terminals");
+}
+
+bool LinearCircuit::is_load_current_driven(double const load) const
+{
+  if (_current_driven.valid && (load + _current_driven.D != 0.0))
+    return true;
+  if (_voltage_driven.valid)
+    return false;
+  throw std::runtime_error("The load can not be connected to this circuit");
+}
+
+LinearCircuit::Discretization const &
+LinearCircuit::get_discretization(Mode const mode, double const delta_t,
+                                  double const load)
+{
+  for (auto const &discretization : _discretizations)
+    if ((discretization.delta_t == delta_t) && (discretization.mode == mode) &&
+        (discretization.load == load))
+      return discretization;
+
+  std::size_t const n_states = _x.size();
+  std::vector<double> A;
+  std::vector<double> B(n_states, 0.0);
+  if (mode == LOAD)
+  {
+    // Eliminate the input using the relation between the current and the
+    // voltage imposed by the load.
+    bool const current_driven = is_load_current_driven(load);
+    StateSpace const &state_space =
+        current_driven ? _current_driven : _voltage_driven;
+    double const gain =
+        current_driven ? -1.0 / (load + state_space.D)
+                       : -load / (1.0 + state_space.D * load);
+    A = state_space.A;
+    for (std::size_t i = 0; i < n_states; ++i)
+      for (std::size_t j = 0; j < n_states; ++j)
+        A[i * n_states + j] += state_space.B[i] * gain * state_space.C[j];
+  }
+  else
+  {
+    StateSpace const &state_space =
+        (mode == CURRENT) ? _current_driven : _voltage_driven;
+    if (!state_space.valid)
+      throw std::runtime_error(
+          std::string("The ") + (mode == CURRENT ? "current" : "voltage") +
+          " can not be imposed on this circuit");
+    A = state_space.A;
+    B = state_space.B;
+  }
+
+  // The exponential of [[A dt, B dt, 0], [0, 0, 1], [0, 0, 0]] contains the
+  // state transition matrix and the responses to a constant and to a linearly
+  // changing input.
+  std::size_t const n = n_states + 2;
+  std::vector<double> E(n * n, 0.0);
+  for (std::size_t i = 0; i < n_states; ++i)
+  {
+    for (std::size_t j = 0; j < n_states; ++j)
+      E[i * n + j] = A[i * n_states + j] * delta_t;
+    E[i * n + n_states] = B[i] * delta_t;
+  }
+  E[n_states * n + n_states + 1] = 1.0;
+  internal::exponential(E, n);
+
+  Discretization &discretization = _discretizations[_next_discretization];
+  _next_discretization = (_next_discretization + 1) % _discretizations.size();
+  discretization.mode = mode;
+  discretization.delta_t = delta_t;
+  discretization.load = load;
+  discretization.Phi.resize(n_states * n_states);
+  discretization.Gamma_0.resize(n_states);
+  discretization.Gamma_1.resize(n_states);
+  for (std::size_t i = 0; i < n_states; ++i)
+  {
+    for (std::size_t j = 0; j < n_states; ++j)
+      discretization.Phi[i * n_states + j] = E[i * n + j];
+    discretization.Gamma_0[i] = E[i * n + n_states];
+    discretization.Gamma_1[i] = E[i * n + n_states + 1];
+  }
+  return discretization;
+}
+
+void LinearCircuit::advance(Discretization const &discretization,
+                            double const u_0, double const u_1)
+{
+  std::size_t const n_states = _x.size();
+  for (std::size_t i = 0; i < n_states; ++i)
+  {
+    double x = discretization.Gamma_0[i] * u_0 +
+               discretization.Gamma_1[i] * (u_1 - u_0);
+    for (std::size_t j = 0; j < n_states; ++j)
+      x += discretization.Phi[i * n_states + j] * _x[j];
+    _x_tmp[i] = x;
+  }
+  _x.swap(_x_tmp);
+}
+
+double LinearCircuit::output(StateSpace const &state_space) const
+{
+  double y = 0.0;
+  for (std::size_t i = 0; i < _x.size(); ++i)
+    y += state_space.C[i] * _x[i];
+  return y;
+}
+
+void LinearCircuit::inspect(EnergyStorageDeviceInspector *inspector)
+{
+  inspector->inspect(this);
+}
+
+void LinearCircuit::evolve_one_time_step_constant_current(double const delta_t,
+                                                          double const current)
+{
+  advance(get_discretization(CURRENT, delta_t), current, current);
+  _I = current;
+  _U = output(_current_driven) + _current_driven.D * current;
+}
+
+void LinearCircuit::evolve_one_time_step_constant_voltage(double const delta_t,
+                                                          double const voltage)
+{
+  advance(get_discretization(VOLTAGE, delta_t), voltage, voltage);
+  _U = voltage;
+  _I = output(_voltage_driven) + _voltage_driven.D * voltage;
+}
+
+void LinearCircuit::evolve_one_time_step_constant_power(double const delta_t,
+                                                        double const power)
+{
+  Discretization const &discretization = get_discretization(CURRENT, delta_t);
+  // The voltage at the end of the time step is U_eq + R_eff I.
+  advance(discretization, 0.0, 0.0);
+  double const U_eq = output(_current_driven);
+  double R_eff = _current_driven.D;
+  for (std::size_t i = 0; i < _x.size(); ++i)
+    R_eff += _current_driven.C[i] * discretization.Gamma_0[i];
+  solve_constant_power(R_eff, U_eq, power, _power_solver, _U, _I);
+  for (std::size_t i = 0; i < _x.size(); ++i)
+    _x[i] += discretization.Gamma_0[i] * _I;
+}
+
+void LinearCircuit::evolve_one_time_step_constant_load(double const delta_t,
+                                                       double const load)
+{
+  advance(get_discretization(LOAD, delta_t, load), 0.0, 0.0);
+  if (is_load_current_driven(load))
+    _I = -output(_current_driven) / (load + _current_driven.D);
+  else
+    _I = output(_voltage_driven) / (1.0 + _voltage_driven.D * load);
+  _U = -load * _I;
+}
+
+void LinearCircuit::evolve_one_time_step_linear_current(double const delta_t,
+                                                        double const current)
+{
+  advance(get_discretization(CURRENT, delta_t), _I, current);
+  _I = current;
+  _U = output(_current_driven) + _current_driven.D * current;
+}
+
+void LinearCircuit::evolve_one_time_step_linear_voltage(double const delta_t,
+                                                        double const voltage)
+{
+  advance(get_discretization(VOLTAGE, delta_t), _U, voltage);
+  _U = voltage;
+  _I = output(_voltage_driven) + _voltage_driven.D * voltage;
+}
+
+void LinearCircuit::evolve_one_time_step_linear_power(double const delta_t,
+                                                      double const power)
+{
+  std::ignore = delta_t;
+  std::ignore = power;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void LinearCircuit::evolve_one_time_step_linear_load(double const delta_t,
+                                                     double const load)
+{
+  std::ignore = delta_t;
+  std::ignore = load;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void LinearCircuit::save(const std::string &filename) const
+{
+  if (_communicator.rank() == 0)
+  {
+    std::ofstream ofs(filename);
+    boost::archive::text_oarchive oa(ofs);
+    oa << _values << _x << _U << _I;
+  }
+}
+
+void LinearCircuit::load(const std::string &filename)
+{
+  if (_communicator.rank() == 0)
+  {
+    // Check that the file exist
+    if (boost::filesystem::exists(filename) == false)
+      throw std::runtime_error("The file " + filename + " does not exists.");
+
+    std::ifstream ifs(filename);
+    if (ifs.good() == false)
+      throw std::runtime_error("Error while opening file " + filename);
+    boost::archive::text_iarchive ia(ifs);
+    std::vector<double> values;
+    std::vector<double> x;
+    ia >> values >> x >> _U >> _I;
+    if (x.size() != _x.size())
+      throw std::runtime_error("The file " + filename +
+                               " does not match the topology of the circuit");
+    set_element_values(values);
+    _x = x;
+  }
+}
+} // end namespace cap
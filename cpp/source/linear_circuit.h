@@ -0,0 +1,255 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_LINEAR_CIRCUIT_H
+#define CAP_LINEAR_CIRCUIT_H
+
+#include <cap/energy_storage_device.h>
+#include <cap/resistor_capacitor.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cap
+{
+
+/**
+ * This class represents an arbitrary linear circuit made of resistors,
+ * capacitors, and inductors. The circuit is described by a netlist:
+ * @code
+ * type       LinearCircuit
+ * elements   2
+ * element_0 {
+ *     type    resistor   ; resistor, capacitor, or inductor
+ *     nodes   1,2
+ *     value   50.0e-3    ; [ohm], [farad], or [henry]
+ * }
+ * element_1 {
+ *     type            capacitor
+ *     nodes           2,0
+ *     value           3.0
+ *     initial_voltage 1.0 ; optional
+ * }
+ * @endcode
+ * The device is connected to the outside world between the node 1 (positive
+ * terminal) and the node 0 (negative terminal). The optional initial value
+ * of a capacitor is its voltage and the one of an inductor (@c
+ * initial_current) is the current flowing from its first to its second node.
+ *
+ * The state of the circuit is made of the voltages of the capacitors and the
+ * currents of the inductors. The state-space form @f$ \dot{x} = A x + B u
+ * @f$, @f$ y = C x + D u @f$ is assembled once by modified nodal analysis,
+ * where the input @f$ u @f$ is the current (the output is the voltage) or the
+ * voltage (the output is the current). The exact discretization of the
+ * state-space form, computed with a matrix exponential, is cached for the
+ * last few time steps so that a time step only costs a dense matrix-vector
+ * product.
+ *
+ * Imposing the voltage requires that no capacitor is directly connected
+ * between the terminals. The method used for the constant power operating
+ * condition is read from @c power_solver (CLOSED_FORM by default).
+ */
+class LinearCircuit : public EnergyStorageDevice
+{
+public:
+  LinearCircuit(boost::property_tree::ptree const &ptree,
+                boost::mpi::communicator const &comm);
+
+  void inspect(EnergyStorageDeviceInspector *inspector) override;
+
+  void evolve_one_time_step_constant_current(double const delta_t,
+                                             double const current) override;
+
+  void evolve_one_time_step_constant_voltage(double const delta_t,
+                                             double const voltage) override;
+
+  void evolve_one_time_step_constant_power(double const delta_t,
+                                           double const power) override;
+
+  void evolve_one_time_step_constant_load(double const delta_t,
+                                          double const load) override;
+
+  void evolve_one_time_step_linear_current(double const delta_t,
+                                           double const current) override;
+
+  void evolve_one_time_step_linear_voltage(double const delta_t,
+                                           double const voltage) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_power(double const delta_t,
+                                         double const power) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_load(double const delta_t,
+                                        double const load) override;
+
+  void get_voltage(double &voltage) const override { voltage = _U; }
+
+  void get_current(double &current) const override { current = _I; }
+
+  /**
+   * Return the number of state variables, i.e. the number of capacitors and
+   * inductors.
+   */
+  std::size_t n_states() const { return _x.size(); }
+
+  /**
+   * Return the state of the circuit. The capacitors come first followed by
+   * the inductors, in the order of the netlist.
+   */
+  std::vector<double> const &get_state() const { return _x; }
+
+  /**
+   * Return the values of the elements in the order of the netlist.
+   */
+  std::vector<double> const &get_element_values() const { return _values; }
+
+  /**
+   * Change the values of the elements (in the order of the netlist) while
+   * keeping the topology and the state of the circuit.
+   */
+  void set_element_values(std::vector<double> const &values);
+
+  /**
+   * Build one circuit for each set of element values in @p element_values.
+   * The netlist in @p ptree is parsed once and shared by all the circuits.
+   */
+  static std::vector<std::unique_ptr<LinearCircuit>>
+  build_batch(boost::property_tree::ptree const &ptree,
+              boost::mpi::communicator const &comm,
+              std::vector<std::vector<double>> const &element_values);
+
+  /**
+   * Save the current state of the circuit in a file.
+   */
+  void save(const std::string &filename) const override;
+
+  /**
+   * Load the state of the circuit from a file.
+   */
+  void load(const std::string &filename) override;
+
+  /**
+   * Topology of the circuit.
+   */
+  struct Netlist
+  {
+    enum ElementType
+    {
+      RESISTOR,
+      CAPACITOR,
+      INDUCTOR
+    };
+
+    Netlist(boost::property_tree::ptree const &ptree);
+
+    std::size_t n_nodes;
+    std::vector<ElementType> types;
+    std::vector<std::array<unsigned int, 2>> nodes;
+    /**
+     * Index of the state variable associated to each element. Resistors do
+     * not have one.
+     */
+    std::vector<std::size_t> states;
+    std::size_t n_capacitors;
+    std::size_t n_inductors;
+  };
+
+private:
+  /**
+   * State-space form of the circuit when the current or the voltage is
+   * imposed. The matrices are stored row-major.
+   */
+  struct StateSpace
+  {
+    bool valid;
+    std::vector<double> A;
+    std::vector<double> B;
+    std::vector<double> C;
+    double D;
+  };
+
+  enum Mode
+  {
+    CURRENT,
+    VOLTAGE,
+    LOAD
+  };
+
+  /**
+   * Exact discretization of a state-space form for a time step. The input
+   * contributes through @c Gamma_0 if it is constant during the time step and
+   * also through @c Gamma_1 times its increment if it changes linearly.
+   */
+  struct Discretization
+  {
+    Mode mode;
+    double delta_t;
+    double load;
+    std::vector<double> Phi;
+    std::vector<double> Gamma_0;
+    std::vector<double> Gamma_1;
+  };
+
+  LinearCircuit(std::shared_ptr<Netlist const> netlist,
+                std::vector<double> const &values,
+                boost::property_tree::ptree const &ptree,
+                boost::mpi::communicator const &comm);
+
+  /**
+   * Assemble the state-space forms from the netlist and the element values.
+   */
+  void assemble();
+
+  /**
+   * Return the discretization for the time step @p delta_t. It is computed if
+   * it is not in the cache.
+   */
+  Discretization const &get_discretization(Mode const mode,
+                                           double const delta_t,
+                                           double const load = 0.0);
+
+  /**
+   * Advance the state with the discretization @p discretization. The input
+   * is @p u_0 at the beginning and @p u_1 at the end of the time step.
+   */
+  void advance(Discretization const &discretization, double const u_0,
+               double const u_1);
+
+  /**
+   * Return the output @f$ C x @f$ without the feedthrough term.
+   */
+  double output(StateSpace const &state_space) const;
+
+  /**
+   * Return true if the constant load operating condition is derived from the
+   * current-driven state-space form, false if it is derived from the
+   * voltage-driven one.
+   */
+  bool is_load_current_driven(double const load) const;
+
+  std::shared_ptr<Netlist const> _netlist;
+  std::vector<double> _values;
+  PowerSolver _power_solver;
+  StateSpace _current_driven;
+  StateSpace _voltage_driven;
+  std::array<Discretization, 4> _discretizations;
+  std::size_t _next_discretization;
+  std::vector<double> _x;
+  std::vector<double> _x_tmp;
+  double _U;
+  double _I;
+};
+
+} // end namespace cap
+
+#endif // CAP_LINEAR_CIRCUIT_H
@@ -0,0 +1,150 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/material_properties.h>
+#include <limits>
+#include <stdexcept>
+
+namespace cap
+{
+
+namespace internal
+{
+// helpers to convert units
+double to_meters(double const cm) { return 1e-2 * cm; }
+double to_kilograms_per_cubic_meter(double const g_per_cm3)
+{
+  return 1e3 * g_per_cm3;
+}
+double to_farads_per_square_meter(double const uF_per_cm2)
+{
+  return 1e-2 * uF_per_cm2;
+}
+double to_amperes_per_square_meter(double const A_per_cm2)
+{
+  return 1e4 * A_per_cm2;
+}
+double to_ohm_meter(double const o_cm) { return 1e-2 * o_cm; }
+
+std::map<std::string, double>
+compute_porous_electrode_properties(boost::property_tree::ptree const &database,
+                                    std::string const &material_name,
+                                    bool const permeable_membrane)
+{
+  boost::property_tree::ptree const &material_database =
+      database.get_child(material_name);
+
+  std::string const matrix_phase =
+      material_database.get<std::string>("matrix_phase");
+  boost::property_tree::ptree const &matrix_phase_database =
+      database.get_child(matrix_phase);
+
+  // The matrix phase of a permeable membrane does not store charges, does
+  // not react, and does not conduct electrons.
+  // clang-format off
+  double const differential_capacitance       = permeable_membrane ? 0.0 : to_farads_per_square_meter(matrix_phase_database.get<double>("differential_capacitance"));
+  double const exchange_current_density       = permeable_membrane ? 0.0 : to_amperes_per_square_meter(matrix_phase_database.get<double>("exchange_current_density"));
+  double const void_volume_fraction           = matrix_phase_database.get<double>("void_volume_fraction");
+  double const tortuosity_factor              = matrix_phase_database.get<double>("tortuosity_factor");
+  double const pores_characteristic_dimension = to_meters(matrix_phase_database.get<double>("pores_characteristic_dimension"));
+  double const pores_geometry_factor          = matrix_phase_database.get<double>("pores_geometry_factor");
+  double const mass_density                   = to_kilograms_per_cubic_meter(matrix_phase_database.get<double>("mass_density"));
+  double const electrical_resistivity         = permeable_membrane ? std::numeric_limits<double>::max() : to_ohm_meter(matrix_phase_database.get<double>("electrical_resistivity"));
+  double const electrical_conductivity        = (electrical_resistivity>1e300) ? 0. : 1.0/electrical_resistivity;
+  // clang-format on
+  double const specific_surface_area_per_unit_volume =
+      (1.0 + pores_geometry_factor) * void_volume_fraction /
+      pores_characteristic_dimension;
+
+  std::map<std::string, double> properties;
+  properties["specific_surface_area"] = specific_surface_area_per_unit_volume;
+  properties["specific_capacitance"] =
+      specific_surface_area_per_unit_volume * differential_capacitance;
+  properties["solid_electrical_conductivity"] =
+      (1.0 - void_volume_fraction) * electrical_conductivity;
+
+  // from the solution_phase datatabase
+  std::string const solution_phase =
+      material_database.get<std::string>("solution_phase");
+  boost::property_tree::ptree const &solution_phase_database =
+      database.get_child(solution_phase);
+  double const electrolyte_conductivity =
+      1.0 / to_ohm_meter(
+                solution_phase_database.get<double>("electrical_resistivity"));
+  double const electrolyte_mass_density = to_kilograms_per_cubic_meter(
+      solution_phase_database.get<double>("mass_density"));
+  properties["liquid_electrical_conductivity"] =
+      void_volume_fraction * electrolyte_conductivity / tortuosity_factor;
+  // TODO: not sure where to pull this from
+  // clang-format off
+  double const anodic_charge_transfer_coefficient   = database.get<double>("anodic_charge_transfer_coefficient", 0.5);
+  double const cathodic_charge_transfer_coefficient = database.get<double>("cathodic_charge_transfer_coefficient", 0.5);
+  double const faraday_constant                     = database.get<double>("faraday_constant", 9.64853365e4);
+  double const gas_constant                         = database.get<double>("gas_constant", 8.3144621);
+  double const temperature                          = database.get<double>("temperature", 300.0);
+  // clang-format on
+  properties["faradaic_reaction_coefficient"] =
+      specific_surface_area_per_unit_volume * exchange_current_density *
+      (anodic_charge_transfer_coefficient +
+       cathodic_charge_transfer_coefficient) *
+      faraday_constant / (gas_constant * temperature);
+  properties["electron_thermal_voltage"] =
+      gas_constant * temperature / faraday_constant;
+  properties["density"] = void_volume_fraction * electrolyte_mass_density +
+                          (1.0 - void_volume_fraction) * mass_density;
+  properties["density_of_active_material"] =
+      (1.0 - void_volume_fraction) * mass_density;
+
+  return properties;
+}
+
+std::map<std::string, double>
+compute_metal_foil_properties(boost::property_tree::ptree const &database,
+                              std::string const &material_name)
+{
+  std::string const metal_foil =
+      database.get<std::string>(material_name + ".metal_foil");
+  boost::property_tree::ptree const &metal_foil_database =
+      database.get_child(metal_foil);
+
+  // clang-format off
+  double const mass_density           = to_kilograms_per_cubic_meter(metal_foil_database.get<double>("mass_density"));
+  double const electrical_resistivity = to_ohm_meter(metal_foil_database.get<double>("electrical_resistivity"));
+  // clang-format on
+
+  std::map<std::string, double> properties;
+  properties["density_of_active_material"] = 0.0;
+  properties["specific_surface_area"] = 0.0;
+  properties["specific_capacitance"] = 0.0;
+  properties["faradaic_reaction_coefficient"] = 0.0;
+  properties["liquid_electrical_conductivity"] = 0.0;
+  properties["solid_electrical_conductivity"] = 1.0 / electrical_resistivity;
+  properties["density"] = mass_density;
+
+  return properties;
+}
+} // end namespace internal
+
+std::map<std::string, double>
+compute_material_properties(boost::property_tree::ptree const &database,
+                            std::string const &material_name)
+{
+  std::string const type =
+      database.get<std::string>(material_name + ".type");
+  if (type.compare("porous_electrode") == 0)
+    return internal::compute_porous_electrode_properties(database,
+                                                         material_name, false);
+  else if (type.compare("permeable_membrane") == 0)
+    return internal::compute_porous_electrode_properties(database,
+                                                         material_name, true);
+  else if (type.compare("current_collector") == 0)
+    return internal::compute_metal_foil_properties(database, material_name);
+  else
+    throw std::runtime_error("Invalid material type " + type);
+}
+
+} // end namespace cap
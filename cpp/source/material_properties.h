@@ -0,0 +1,34 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_MATERIAL_PROPERTIES_H
+#define CAP_MATERIAL_PROPERTIES_H
+
+#include <boost/property_tree/ptree.hpp>
+#include <map>
+#include <string>
+
+namespace cap
+{
+
+/**
+ * Compute the properties, in SI units, of the material @p material_name
+ * described in @p database (the @c material_properties database of the
+ * supercapacitor). The material type is either @c porous_electrode, @c
+ * permeable_membrane, or @c current_collector. The properties are returned
+ * by name (e.g. @c specific_capacitance or @c solid_electrical_conductivity)
+ * and they are uniform over the material. This function does not require a
+ * mesh and it is used by the MPValues of the finite element model as well as
+ * by the equivalent circuits.
+ */
+std::map<std::string, double>
+compute_material_properties(boost::property_tree::ptree const &database,
+                            std::string const &material_name);
+
+} // end namespace cap
+
+#endif // CAP_MATERIAL_PROPERTIES_H
@@ -0,0 +1,532 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/rc_bank.h>
+#include <cap/rc_propagator.h>
+#include <cap/utils.h>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/mpi/collectives.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace cap
+{
+
+REGISTER_ENERGY_STORAGE_DEVICE(RCBank)
+
+namespace internal
+{
+// helper function to build the distribution of a cell parameter
+std::function<double(std::default_random_engine &)>
+build_cell_parameter_distribution(
+    boost::property_tree::ptree const &parameter_database)
+{
+  auto const distribution_type =
+      parameter_database.get<std::string>("distribution_type");
+  if (distribution_type.compare("uniform") == 0)
+  {
+    auto const range =
+        to_vector<double>(parameter_database.get<std::string>("range"));
+    if (range.size() != 2)
+      throw std::runtime_error(
+          "Invalid range for constructing an uniform distribution");
+    std::uniform_real_distribution<double> distribution(range[0], range[1]);
+    return
+        [distribution](std::default_random_engine &generator) mutable -> double
+    {
+      return distribution(generator);
+    };
+  }
+  else if (distribution_type.compare("normal") == 0)
+  {
+    std::normal_distribution<double> distribution(
+        parameter_database.get<double>("mean"),
+        parameter_database.get<double>("standard_deviation"));
+    return
+        [distribution](std::default_random_engine &generator) mutable -> double
+    {
+      return distribution(generator);
+    };
+  }
+  else if (distribution_type.compare("lognormal") == 0)
+  {
+    std::lognormal_distribution<double> distribution(
+        parameter_database.get<double>("location"),
+        parameter_database.get<double>("scale"));
+    return
+        [distribution](std::default_random_engine &generator) mutable -> double
+    {
+      return distribution(generator);
+    };
+  }
+  else
+    throw std::runtime_error("Invalid parameter distribution type " +
+                             distribution_type);
+}
+
+// Read the value of the parameter @p key for all the cells of the bank. The
+// parameter is either a single value, a list of n_cells values, or a
+// distribution.
+std::vector<double>
+read_cell_parameter(boost::property_tree::ptree const &ptree,
+                    std::string const &key, std::size_t const n_cells,
+                    std::default_random_engine &generator)
+{
+  boost::property_tree::ptree const &parameter_database = ptree.get_child(key);
+  if (!parameter_database.empty())
+  {
+    auto distribution = build_cell_parameter_distribution(parameter_database);
+    std::vector<double> values(n_cells);
+    for (auto &value : values)
+      value = distribution(generator);
+    return values;
+  }
+  std::vector<double> values =
+      to_vector<double>(ptree.get<std::string>(key));
+  if (values.size() == 1)
+    values.resize(n_cells, values[0]);
+  if (values.size() != n_cells)
+    throw std::runtime_error("The number of values of " + key + " (" +
+                             std::to_string(values.size()) +
+                             ") does not match the number of cells (" +
+                             std::to_string(n_cells) + ")");
+  return values;
+}
+} // end namespace internal
+
+RCBank::RCBank(boost::property_tree::ptree const &ptree,
+               boost::mpi::communicator const &comm)
+    : EnergyStorageDevice(comm), _n_cells(ptree.get<std::size_t>("n_cells")),
+      _first_local_cell(0), _distributed(ptree.get("distributed", false)),
+      _current_delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _current_ramp_delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _voltage_delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _voltage_ramp_delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _load_delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _load(std::numeric_limits<double>::quiet_NaN()), _voltage(0.0),
+      _current(0.0)
+{
+  if (_n_cells == 0)
+    throw std::runtime_error("The bank must contain at least one cell");
+
+  // Every processor draws the parameters of all the cells so that the values
+  // do not depend on the number of processors. Only the local cells are kept.
+  std::default_random_engine generator(ptree.get("seed", 0u));
+  std::vector<double> const R = internal::read_cell_parameter(
+      ptree, "series_resistance", _n_cells, generator);
+  std::vector<double> R_parallel;
+  if (ptree.get_child_optional("parallel_resistance"))
+    R_parallel = internal::read_cell_parameter(ptree, "parallel_resistance",
+                                               _n_cells, generator);
+  std::vector<double> const C =
+      internal::read_cell_parameter(ptree, "capacitance", _n_cells, generator);
+  std::vector<double> U_C(_n_cells, 0.0);
+  if (ptree.get_child_optional("initial_voltage"))
+    U_C = internal::read_cell_parameter(ptree, "initial_voltage", _n_cells,
+                                        generator);
+
+  std::size_t n_local_cells = _n_cells;
+  if (_distributed)
+  {
+    std::size_t const size = _communicator.size();
+    std::size_t const rank = _communicator.rank();
+    n_local_cells = _n_cells / size + ((rank < _n_cells % size) ? 1 : 0);
+    _first_local_cell = rank * (_n_cells / size) +
+                        std::min<std::size_t>(rank, _n_cells % size);
+  }
+  auto const first = _first_local_cell;
+  auto const last = _first_local_cell + n_local_cells;
+  _R.assign(R.begin() + first, R.begin() + last);
+  _C.assign(C.begin() + first, C.begin() + last);
+  _U_C.assign(U_C.begin() + first, U_C.begin() + last);
+  _G.assign(n_local_cells, 0.0);
+  if (!R_parallel.empty())
+    std::transform(R_parallel.begin() + first, R_parallel.begin() + last,
+                   _G.begin(), [](double const r)
+                   {
+                     return 1.0 / r;
+                   });
+  // Start at rest, the leakage current flows through the series resistance.
+  _I.resize(n_local_cells);
+  _U.resize(n_local_cells);
+  for (std::size_t i = 0; i < n_local_cells; ++i)
+  {
+    _I[i] = _G[i] * _U_C[i];
+    _U[i] = _U_C[i] + _R[i] * _I[i];
+  }
+  update_averages();
+}
+
+void RCBank::inspect(EnergyStorageDeviceInspector *inspector)
+{
+  inspector->inspect(this);
+}
+
+void RCBank::evolve_one_time_step_constant_current(double const delta_t,
+                                                   double const current)
+{
+  update_current_coefficients(delta_t);
+  std::size_t const n = _R.size();
+  double const *__restrict__ R = _R.data();
+  double const *__restrict__ decay = _decay.data();
+  double const *__restrict__ charge = _charge.data();
+  double *__restrict__ U_C = _U_C.data();
+  double *__restrict__ U = _U.data();
+  double *__restrict__ I = _I.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    U_C[i] = decay[i] * U_C[i] + charge[i] * current;
+    I[i] = current;
+    U[i] = U_C[i] + R[i] * current;
+  }
+  update_averages();
+}
+
+void RCBank::evolve_one_time_step_linear_current(double const delta_t,
+                                                 double const current)
+{
+  update_current_coefficients(delta_t);
+  update_current_ramp(delta_t);
+  std::size_t const n = _R.size();
+  double const *__restrict__ R = _R.data();
+  double const *__restrict__ decay = _decay.data();
+  double const *__restrict__ charge = _charge.data();
+  double const *__restrict__ ramp = _ramp.data();
+  double *__restrict__ U_C = _U_C.data();
+  double *__restrict__ U = _U.data();
+  double *__restrict__ I = _I.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    U_C[i] = decay[i] * U_C[i] + charge[i] * I[i] + ramp[i] * (current - I[i]);
+    I[i] = current;
+    U[i] = U_C[i] + R[i] * current;
+  }
+  update_averages();
+}
+
+void RCBank::evolve_one_time_step_constant_voltage(double const delta_t,
+                                                   double const voltage)
+{
+  update_voltage_coefficients(delta_t);
+  std::size_t const n = _R.size();
+  double const *__restrict__ R = _R.data();
+  double const *__restrict__ gain = _gain.data();
+  double const *__restrict__ relaxation = _voltage_relaxation.data();
+  double *__restrict__ U_C = _U_C.data();
+  double *__restrict__ U = _U.data();
+  double *__restrict__ I = _I.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    U_C[i] += (voltage * gain[i] - U_C[i]) * relaxation[i];
+    U[i] = voltage;
+    I[i] = (voltage - U_C[i]) / R[i];
+  }
+  update_averages();
+}
+
+void RCBank::evolve_one_time_step_linear_voltage(double const delta_t,
+                                                 double const voltage)
+{
+  update_voltage_coefficients(delta_t);
+  update_voltage_ramp(delta_t);
+  std::size_t const n = _R.size();
+  double const *__restrict__ R = _R.data();
+  double const *__restrict__ gain = _gain.data();
+  double const *__restrict__ relaxation = _voltage_relaxation.data();
+  double const *__restrict__ ramp = _voltage_ramp.data();
+  double *__restrict__ U_C = _U_C.data();
+  double *__restrict__ U = _U.data();
+  double *__restrict__ I = _I.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    U_C[i] += (U[i] * gain[i] - U_C[i]) * relaxation[i] +
+              (voltage - U[i]) * ramp[i];
+    U[i] = voltage;
+    I[i] = (voltage - U_C[i]) / R[i];
+  }
+  update_averages();
+}
+
+void RCBank::evolve_one_time_step_constant_load(double const delta_t,
+                                                double const load)
+{
+  update_load_decay(delta_t, load);
+  std::size_t const n = _R.size();
+  double const *__restrict__ R = _R.data();
+  double const *__restrict__ load_decay = _load_decay.data();
+  double *__restrict__ U_C = _U_C.data();
+  double *__restrict__ U = _U.data();
+  double *__restrict__ I = _I.data();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    U_C[i] *= load_decay[i];
+    I[i] = -U_C[i] / (R[i] + load);
+    U[i] = U_C[i] + R[i] * I[i];
+  }
+  update_averages();
+}
+
+void RCBank::evolve_one_time_step_constant_power(double const delta_t,
+                                                 double const power)
+{
+  // Over the time step, the voltage and the current satisfy
+  //   U = R_eff I + U_eq  with  I = P / U
+  // where R_eff and U_eq do not depend on the current. U is the root of the
+  // quadratic equation that tends to U_eq when P goes to zero.
+  update_current_coefficients(delta_t);
+  std::size_t const n = _R.size();
+  double const *__restrict__ R = _R.data();
+  double const *__restrict__ decay = _decay.data();
+  double const *__restrict__ charge = _charge.data();
+  double *__restrict__ U_C = _U_C.data();
+  double *__restrict__ U = _U.data();
+  double *__restrict__ I = _I.data();
+  double const P = power;
+  // Check that all the cells can deliver the power before the state is
+  // modified, so that a failed time step leaves the bank unchanged.
+  double min_discriminant = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    double const U_eq = decay[i] * U_C[i];
+    min_discriminant = std::min(min_discriminant,
+                                U_eq * U_eq + 4.0 * (R[i] + charge[i]) * P);
+  }
+  if (_distributed)
+    min_discriminant = boost::mpi::all_reduce(_communicator, min_discriminant,
+                                              boost::mpi::minimum<double>());
+  if (min_discriminant < 0.0)
+    throw std::runtime_error(
+        "The power " + std::to_string(P) +
+        " exceeds what the cells can deliver during the time step");
+
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    double const U_eq = decay[i] * U_C[i];
+    double const discriminant = U_eq * U_eq + 4.0 * (R[i] + charge[i]) * P;
+    U[i] = 0.5 * (U_eq + std::copysign(std::sqrt(discriminant), U_eq));
+    I[i] = (U[i] != 0.0) ? P / U[i] : 0.0;
+    U_C[i] = U_eq + charge[i] * I[i];
+    U[i] = U_C[i] + R[i] * I[i];
+  }
+  update_averages();
+}
+
+void RCBank::evolve_one_time_step_linear_power(double const delta_t,
+                                               double const power)
+{
+  std::ignore = delta_t;
+  std::ignore = power;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void RCBank::evolve_one_time_step_linear_load(double const delta_t,
+                                              double const load)
+{
+  std::ignore = delta_t;
+  std::ignore = load;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void RCBank::update_current_coefficients(double const delta_t)
+{
+  if (delta_t == _current_delta_t)
+    return;
+  _current_delta_t = delta_t;
+  std::size_t const n = _R.size();
+  _decay.resize(n);
+  _charge.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    internal::compute_current_coefficients(delta_t, _G[i], _C[i], _decay[i],
+                                           _charge[i]);
+}
+
+void RCBank::update_current_ramp(double const delta_t)
+{
+  if (delta_t == _current_ramp_delta_t)
+    return;
+  _current_ramp_delta_t = delta_t;
+  std::size_t const n = _R.size();
+  _ramp.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    _ramp[i] = internal::compute_current_ramp(delta_t, _G[i], _C[i]);
+}
+
+void RCBank::update_voltage_coefficients(double const delta_t)
+{
+  if (delta_t == _voltage_delta_t)
+    return;
+  _voltage_delta_t = delta_t;
+  std::size_t const n = _R.size();
+  _gain.resize(n);
+  _voltage_relaxation.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    internal::compute_voltage_coefficients(delta_t, _R[i], _G[i], _C[i],
+                                           _gain[i], _voltage_relaxation[i]);
+}
+
+void RCBank::update_voltage_ramp(double const delta_t)
+{
+  if (delta_t == _voltage_ramp_delta_t)
+    return;
+  _voltage_ramp_delta_t = delta_t;
+  std::size_t const n = _R.size();
+  _voltage_ramp.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    _voltage_ramp[i] =
+        internal::compute_voltage_ramp(delta_t, _R[i], _G[i], _C[i]);
+}
+
+void RCBank::update_load_decay(double const delta_t, double const load)
+{
+  if ((delta_t == _load_delta_t) && (load == _load))
+    return;
+  _load_delta_t = delta_t;
+  _load = load;
+  std::size_t const n = _R.size();
+  _load_decay.resize(n);
+  for (std::size_t i = 0; i < n; ++i)
+    _load_decay[i] =
+        std::exp(-delta_t * (1.0 / (_R[i] + load) + _G[i]) / _C[i]);
+}
+
+void RCBank::update_averages()
+{
+  double sums[2] = {0.0, 0.0};
+  std::size_t const n = _R.size();
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    sums[0] += _U[i];
+    sums[1] += _I[i];
+  }
+  if (_distributed)
+  {
+    double local_sums[2] = {sums[0], sums[1]};
+    boost::mpi::all_reduce(_communicator, local_sums, 2, sums,
+                           std::plus<double>());
+  }
+  _voltage = sums[0] / _n_cells;
+  _current = sums[1] / _n_cells;
+}
+
+void RCBank::gather(AlignedVector const &local,
+                    std::vector<double> &global) const
+{
+  if (!_distributed)
+  {
+    global.assign(local.begin(), local.end());
+    return;
+  }
+  std::vector<std::vector<double>> all_values;
+  boost::mpi::all_gather(_communicator,
+                         std::vector<double>(local.begin(), local.end()),
+                         all_values);
+  global.clear();
+  global.reserve(_n_cells);
+  for (auto const &values : all_values)
+    global.insert(global.end(), values.begin(), values.end());
+}
+
+void RCBank::gather_voltage(std::vector<double> &voltage) const
+{
+  gather(_U, voltage);
+}
+
+void RCBank::gather_current(std::vector<double> &current) const
+{
+  gather(_I, current);
+}
+
+void RCBank::save(const std::string &filename) const
+{
+  std::vector<double> R, G, C, U_C, U, I;
+  gather(_R, R);
+  gather(_G, G);
+  gather(_C, C);
+  gather(_U_C, U_C);
+  gather(_U, U);
+  gather(_I, I);
+  if (_communicator.rank() == 0)
+  {
+    std::ofstream ofs(filename);
+    boost::archive::text_oarchive oa(ofs);
+    oa << _n_cells << R << G << C << U_C << U << I;
+  }
+}
+
+void RCBank::load(const std::string &filename)
+{
+  // Only the processor of rank zero reads the file. If something goes wrong,
+  // the error is broadcast so that all the processors throw.
+  std::size_t n_cells = 0;
+  std::vector<double> R, G, C, U_C, U, I;
+  std::string error_message;
+  if (_communicator.rank() == 0)
+  {
+    try
+    {
+      // Check that the file exist
+      if (boost::filesystem::exists(filename) == false)
+        throw std::runtime_error("The file " + filename + " does not exists.");
+
+      std::ifstream ifs(filename);
+      if (ifs.good() == false)
+        throw std::runtime_error("Error while opening file " + filename);
+      boost::archive::text_iarchive ia(ifs);
+      ia >> n_cells >> R >> G >> C >> U_C >> U >> I;
+    }
+    catch (std::exception const &exception)
+    {
+      error_message = exception.what();
+      if (error_message.empty())
+        error_message = "Error while reading file " + filename;
+    }
+  }
+  if (_distributed)
+    boost::mpi::broadcast(_communicator, error_message, 0);
+  if (!error_message.empty())
+    throw std::runtime_error(error_message);
+  if (_distributed)
+  {
+    boost::mpi::broadcast(_communicator, n_cells, 0);
+    for (auto *values : {&R, &G, &C, &U_C, &U, &I})
+      boost::mpi::broadcast(_communicator, *values, 0);
+  }
+  else if (_communicator.rank() != 0)
+  {
+    // Only the processor of rank zero holds a non-distributed bank.
+    return;
+  }
+  if (n_cells != _n_cells)
+    throw std::runtime_error("The number of cells in " + filename +
+                             " does not match the bank");
+  auto const first = _first_local_cell;
+  auto const last = _first_local_cell + _R.size();
+  _R.assign(R.begin() + first, R.begin() + last);
+  _G.assign(G.begin() + first, G.begin() + last);
+  _C.assign(C.begin() + first, C.begin() + last);
+  _U_C.assign(U_C.begin() + first, U_C.begin() + last);
+  _U.assign(U.begin() + first, U.begin() + last);
+  _I.assign(I.begin() + first, I.begin() + last);
+  // The parameters of the cells have changed
+  for (double *delta_t : {&_current_delta_t, &_current_ramp_delta_t,
+                          &_voltage_delta_t, &_voltage_ramp_delta_t})
+    *delta_t = std::numeric_limits<double>::quiet_NaN();
+  _load_delta_t = std::numeric_limits<double>::quiet_NaN();
+  update_averages();
+}
+
+} // end namespace cap
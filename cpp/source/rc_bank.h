@@ -0,0 +1,206 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_RC_BANK_H
+#define CAP_RC_BANK_H
+
+#include <cap/energy_storage_device.h>
+#include <boost/align/aligned_allocator.hpp>
+#include <string>
+#include <vector>
+
+namespace cap
+{
+
+/**
+ * This class represents a bank of independent resistor-capacitor cells. Each
+ * cell is a capacitor @f$ C @f$ with an optional leakage resistance in
+ * parallel, in series with a resistance @f$ R @f$, i.e. a SeriesRC or a
+ * ParallelRC. The state of the cells is stored in contiguous aligned arrays
+ * (structure of arrays) and all the cells are evolved at once, which allows
+ * the compiler to vectorize the loops. The coefficients of the propagators of
+ * the cells are computed once per time step size.
+ *
+ * Every cell is subjected to the same operating condition (the current,
+ * voltage, power, or load passed to the evolve functions are per cell).
+ * get_voltage() and get_current() return the average over all the cells of
+ * the bank, so that a homogeneous bank behaves exactly as a single cell.
+ * The value of each individual cell can be gathered with gather_voltage() and
+ * gather_current().
+ *
+ * The per-cell parameters @c series_resistance, @c parallel_resistance
+ * (optional, no leakage if absent), @c capacitance, and @c initial_voltage
+ * are either a single value, a comma-separated list of @c n_cells values, or
+ * a child database describing a distribution (@c distribution_type is
+ * @c uniform, @c normal, or @c lognormal) from which the values are drawn
+ * using the @c seed of the bank. If @c distributed is true, the cells are
+ * spread across the processors of the communicator. The values drawn from the
+ * distributions do not depend on the number of processors.
+ */
+class RCBank : public EnergyStorageDevice
+{
+public:
+  RCBank(boost::property_tree::ptree const &ptree,
+         boost::mpi::communicator const &comm);
+
+  void inspect(EnergyStorageDeviceInspector *inspector) override;
+
+  void evolve_one_time_step_constant_current(double const delta_t,
+                                             double const current) override;
+
+  void evolve_one_time_step_constant_voltage(double const delta_t,
+                                             double const voltage) override;
+
+  void evolve_one_time_step_constant_power(double const delta_t,
+                                           double const power) override;
+
+  void evolve_one_time_step_constant_load(double const delta_t,
+                                          double const load) override;
+
+  void evolve_one_time_step_linear_current(double const delta_t,
+                                           double const current) override;
+
+  void evolve_one_time_step_linear_voltage(double const delta_t,
+                                           double const voltage) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_power(double const delta_t,
+                                         double const power) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_load(double const delta_t,
+                                        double const load) override;
+
+  /**
+   * Return the voltage averaged over all the cells of the bank.
+   */
+  void get_voltage(double &voltage) const override { voltage = _voltage; }
+
+  /**
+   * Return the current averaged over all the cells of the bank.
+   */
+  void get_current(double &current) const override { current = _current; }
+
+  /**
+   * Return the total number of cells in the bank.
+   */
+  std::size_t n_cells() const { return _n_cells; }
+
+  /**
+   * Return the number of cells stored on this processor.
+   */
+  std::size_t n_local_cells() const { return _R.size(); }
+
+  /**
+   * Return the global index of the first cell stored on this processor.
+   */
+  std::size_t first_local_cell() const { return _first_local_cell; }
+
+  /**
+   * Gather the voltage of all the cells of the bank in @p voltage. This
+   * function must be called by all the processors of the communicator.
+   */
+  void gather_voltage(std::vector<double> &voltage) const;
+
+  /**
+   * Gather the current of all the cells of the bank in @p current. This
+   * function must be called by all the processors of the communicator.
+   */
+  void gather_current(std::vector<double> &current) const;
+
+  /**
+   * Save the current state of the bank in a file. The processor of rank zero
+   * writes the state of all the cells.
+   */
+  void save(const std::string &filename) const override;
+
+  /**
+   * Load the bank from a state saved in a file.
+   */
+  void load(const std::string &filename) override;
+
+private:
+  typedef std::vector<double, boost::alignment::aligned_allocator<double, 64>>
+      AlignedVector;
+
+  /**
+   * Compute the coefficients of the cells used when the current is imposed
+   * (see RCPropagator) if the time step @p delta_t differs from the one used
+   * previously. The other update functions do the same for the other groups
+   * of coefficients so that an operating condition only computes the
+   * coefficients it needs.
+   */
+  void update_current_coefficients(double const delta_t);
+  void update_current_ramp(double const delta_t);
+  void update_voltage_coefficients(double const delta_t);
+  void update_voltage_ramp(double const delta_t);
+
+  /**
+   * Compute the decay of the cells connected to the load @p load if the load
+   * or the time step @p delta_t differ from the ones used previously.
+   */
+  void update_load_decay(double const delta_t, double const load);
+
+  /**
+   * Compute the average voltage and current over the cells of the bank.
+   */
+  void update_averages();
+
+  /**
+   * Gather @p local from all the processors in @p global.
+   */
+  void gather(AlignedVector const &local, std::vector<double> &global) const;
+
+  std::size_t _n_cells;
+  std::size_t _first_local_cell;
+  bool _distributed;
+  /**
+   * Series resistance of the cells.
+   */
+  AlignedVector _R;
+  /**
+   * Leakage conductance of the cells, i.e. the inverse of the parallel
+   * resistance. It is zero when there is no leakage.
+   */
+  AlignedVector _G;
+  AlignedVector _C;
+  AlignedVector _U_C;
+  AlignedVector _U;
+  AlignedVector _I;
+  /**
+   * Coefficients of the propagators of the cells (see RCPropagator), grouped
+   * by operating condition. Each group stores the time step for which it was
+   * computed.
+   */
+  double _current_delta_t;
+  AlignedVector _decay;
+  AlignedVector _charge;
+  double _current_ramp_delta_t;
+  AlignedVector _ramp;
+  double _voltage_delta_t;
+  AlignedVector _gain;
+  AlignedVector _voltage_relaxation;
+  double _voltage_ramp_delta_t;
+  AlignedVector _voltage_ramp;
+  /**
+   * Decay of the cells connected to the load _load for the time step
+   * _load_delta_t.
+   */
+  double _load_delta_t;
+  double _load;
+  AlignedVector _load_decay;
+  double _voltage;
+  double _current;
+};
+
+} // end namespace cap
+
+#endif // CAP_RC_BANK_H
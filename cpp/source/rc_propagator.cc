@@ -0,0 +1,102 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/rc_propagator.h>
+#include <limits>
+
+namespace cap
+{
+
+namespace internal
+{
+void compute_current_coefficients(double const delta_t, double const G,
+                                  double const C, double &decay,
+                                  double &charge)
+{
+  // Current imposed: C dU_C/dt = I - G U_C
+  if (G == 0.0)
+  {
+    decay = 1.0;
+    charge = delta_t / C;
+  }
+  else
+  {
+    double const x = G * delta_t / C;
+    decay = std::exp(-x);
+    charge = delta_t / C * phi(x);
+  }
+}
+
+double compute_current_ramp(double const delta_t, double const G,
+                            double const C)
+{
+  return delta_t / C * psi(G * delta_t / C);
+}
+
+void compute_voltage_coefficients(double const delta_t, double const R,
+                                  double const G, double const C,
+                                  double &gain, double &relaxation)
+{
+  // Voltage imposed: C dU_C/dt = (U - U_C) / R - G U_C. The time constant is
+  // R C gain.
+  gain = 1.0 / (1.0 + R * G);
+  relaxation = -std::expm1(-delta_t / (R * C * gain));
+}
+
+double compute_voltage_ramp(double const delta_t, double const R,
+                            double const G, double const C)
+{
+  double const gain = 1.0 / (1.0 + R * G);
+  double const y = delta_t / (R * C * gain);
+  return gain * ((y > 1.0e-2) ? 1.0 - phi(y) : y * psi(y));
+}
+} // end namespace internal
+
+RCPropagator::RCPropagator()
+    : RCPropagator(std::numeric_limits<double>::quiet_NaN(),
+                   std::numeric_limits<double>::quiet_NaN(),
+                   std::numeric_limits<double>::quiet_NaN(),
+                   std::numeric_limits<double>::quiet_NaN())
+{
+}
+
+RCPropagator::RCPropagator(double const delta_t, double const R,
+                           double const G, double const C)
+    : _delta_t(delta_t), _R(R), _G(G), _C(C), _current_computed(false),
+      _ramp_computed(false), _voltage_computed(false),
+      _voltage_ramp_computed(false), _decay(0.0), _charge(0.0), _ramp(0.0),
+      _gain(0.0), _voltage_relaxation(0.0), _voltage_ramp(0.0),
+      _load(std::numeric_limits<double>::quiet_NaN()), _load_decay(0.0)
+{
+}
+
+void RCPropagator::compute_current()
+{
+  internal::compute_current_coefficients(_delta_t, _G, _C, _decay, _charge);
+  _current_computed = true;
+}
+
+void RCPropagator::compute_voltage()
+{
+  internal::compute_voltage_coefficients(_delta_t, _R, _G, _C, _gain,
+                                         _voltage_relaxation);
+  _voltage_computed = true;
+}
+
+RCPropagator &RCPropagatorCache::get(double const delta_t, double const R,
+                                     double const G, double const C)
+{
+  for (auto &propagator : _propagators)
+    if (propagator.matches(delta_t, R, G, C))
+      return propagator;
+  RCPropagator &propagator = _propagators[_next];
+  propagator = RCPropagator(delta_t, R, G, C);
+  _next = (_next + 1) % _size;
+  return propagator;
+}
+
+} // end namespace cap
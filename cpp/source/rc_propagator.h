@@ -0,0 +1,243 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_RC_PROPAGATOR_H
+#define CAP_RC_PROPAGATOR_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace cap
+{
+
+namespace internal
+{
+/**
+ * phi(x) = (1 - exp(-x)) / x and phi(0) = 1. phi(G dt / C) dt / C is the
+ * charge-to-voltage factor of a leaky capacitor over a time step.
+ */
+inline double phi(double const x)
+{
+  return (x > 0.0) ? -std::expm1(-x) / x : 1.0;
+}
+
+/**
+ * psi(x) = (1 - phi(x)) / x and psi(0) = 1/2. It appears when the operating
+ * condition changes linearly during the time step. The Taylor expansion is
+ * used for small x to avoid the cancellation.
+ */
+inline double psi(double const x)
+{
+  return (x > 1.0e-2)
+             ? (1.0 + std::expm1(-x) / x) / x
+             : 0.5 -
+                   x * (1.0 / 6.0 -
+                        x * (1.0 / 24.0 - x * (1.0 / 120.0 - x / 720.0)));
+}
+
+/**
+ * Compute the coefficients used when the current is imposed: the decay of the
+ * capacitor voltage through the leakage and its increase per unit of
+ * current. They do not involve any transcendental function when there is no
+ * leakage.
+ */
+void compute_current_coefficients(double const delta_t, double const G,
+                                  double const C, double &decay,
+                                  double &charge);
+
+/**
+ * Return the increase of the capacitor voltage per unit of current increment
+ * when the current changes linearly during the time step.
+ */
+double compute_current_ramp(double const delta_t, double const G,
+                            double const C);
+
+/**
+ * Compute the coefficients used when the voltage is imposed: the fraction of
+ * the voltage seen by the capacitor at steady state and the fraction of the
+ * gap to the steady state closed during the time step.
+ */
+void compute_voltage_coefficients(double const delta_t, double const R,
+                                  double const G, double const C,
+                                  double &gain, double &relaxation);
+
+/**
+ * Return the increase of the capacitor voltage per unit of voltage increment
+ * when the voltage changes linearly during the time step.
+ */
+double compute_voltage_ramp(double const delta_t, double const R,
+                            double const G, double const C);
+} // end namespace internal
+
+/**
+ * Coefficients of the exact discrete-time propagator of a capacitor @f$ C
+ * @f$ with a leakage conductance @f$ G @f$ (zero when there is no leakage), in
+ * series with a resistance @f$ R @f$, for a time step @f$ \Delta t @f$. With
+ * these coefficients, advancing the circuit by one time step only requires a
+ * few multiply-adds. The coefficients are computed the first time they are
+ * requested so that an operating condition only pays for the ones it uses.
+ * The coefficients for the constant load operating condition depend on the
+ * load and are recomputed when it changes.
+ */
+class RCPropagator
+{
+public:
+  /**
+   * Create an empty propagator that does not match any circuit.
+   */
+  RCPropagator();
+
+  /**
+   * Create the propagator of the circuit. No coefficient is computed yet.
+   */
+  RCPropagator(double const delta_t, double const R, double const G,
+               double const C);
+
+  /**
+   * Return true if the propagator has been created for these parameters.
+   */
+  bool matches(double const delta_t, double const R, double const G,
+               double const C) const
+  {
+    return (delta_t == _delta_t) && (R == _R) && (G == _G) && (C == _C);
+  }
+
+  /**
+   * Return the decay of the capacitor voltage through the leakage,
+   * exp(-G dt / C).
+   */
+  double get_decay()
+  {
+    if (!_current_computed)
+      compute_current();
+    return _decay;
+  }
+
+  /**
+   * Return the increase of the capacitor voltage per unit of constant
+   * current.
+   */
+  double get_charge()
+  {
+    if (!_current_computed)
+      compute_current();
+    return _charge;
+  }
+
+  /**
+   * Return the increase of the capacitor voltage per unit of current
+   * increment when the current changes linearly during the time step.
+   */
+  double get_ramp()
+  {
+    if (!_ramp_computed)
+    {
+      _ramp = internal::compute_current_ramp(_delta_t, _G, _C);
+      _ramp_computed = true;
+    }
+    return _ramp;
+  }
+
+  /**
+   * Return the fraction of the imposed voltage seen by the capacitor at
+   * steady state, 1 / (1 + R G).
+   */
+  double get_gain()
+  {
+    if (!_voltage_computed)
+      compute_voltage();
+    return _gain;
+  }
+
+  /**
+   * Return the fraction of the gap to the steady state closed during the
+   * time step when the voltage is constant.
+   */
+  double get_voltage_relaxation()
+  {
+    if (!_voltage_computed)
+      compute_voltage();
+    return _voltage_relaxation;
+  }
+
+  /**
+   * Return the increase of the capacitor voltage per unit of voltage
+   * increment when the voltage changes linearly during the time step.
+   */
+  double get_voltage_ramp()
+  {
+    if (!_voltage_ramp_computed)
+    {
+      _voltage_ramp = internal::compute_voltage_ramp(_delta_t, _R, _G, _C);
+      _voltage_ramp_computed = true;
+    }
+    return _voltage_ramp;
+  }
+
+  /**
+   * Return the decay of the capacitor voltage when a load @p load is
+   * connected to the circuit. The value is recomputed only if the load
+   * differs from the previous call.
+   */
+  double get_load_decay(double const load)
+  {
+    if (load != _load)
+    {
+      _load = load;
+      _load_decay = std::exp(-_delta_t * (1.0 / (_R + load) + _G) / _C);
+    }
+    return _load_decay;
+  }
+
+private:
+  void compute_current();
+  void compute_voltage();
+
+  double _delta_t;
+  double _R;
+  double _G;
+  double _C;
+  bool _current_computed;
+  bool _ramp_computed;
+  bool _voltage_computed;
+  bool _voltage_ramp_computed;
+  double _decay;
+  double _charge;
+  double _ramp;
+  double _gain;
+  double _voltage_relaxation;
+  double _voltage_ramp;
+  double _load;
+  double _load_decay;
+};
+
+/**
+ * Small cache of the propagators for the last few time steps used by a
+ * circuit. The oldest propagator is replaced when the cache is full.
+ */
+class RCPropagatorCache
+{
+public:
+  RCPropagatorCache() : _next(0) {}
+
+  /**
+   * Return the propagator associated to these parameters. It is computed if
+   * it is not in the cache.
+   */
+  RCPropagator &get(double const delta_t, double const R, double const G,
+                    double const C);
+
+private:
+  static std::size_t const _size = 4;
+  std::array<RCPropagator, _size> _propagators;
+  std::size_t _next;
+};
+
+} // end namespace cap
+
+#endif // CAP_RC_PROPAGATOR_H
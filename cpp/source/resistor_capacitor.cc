@@ -19,6 +19,133 @@ namespace cap
 REGISTER_ENERGY_STORAGE_DEVICE(SeriesRC)
 REGISTER_ENERGY_STORAGE_DEVICE(ParallelRC)
 
+PowerSolver string_to_power_solver(std::string const &method)
+{
+  if (method.compare("CLOSED_FORM") == 0)
+    return PowerSolver::CLOSED_FORM;
+  else if (method.compare("NEWTON") == 0)
+    return PowerSolver::NEWTON;
+  else if (method.compare("FIXED_POINT") == 0)
+    return PowerSolver::FIXED_POINT;
+  else
+    throw std::runtime_error("invalid method " + method);
+}
+
+std::string power_solver_to_string(PowerSolver const solver)
+{
+  switch (solver)
+  {
+  case PowerSolver::CLOSED_FORM:
+    return "CLOSED_FORM";
+  case PowerSolver::NEWTON:
+    return "NEWTON";
+  case PowerSolver::FIXED_POINT:
+    return "FIXED_POINT";
+  }
+  throw std::runtime_error("invalid power solver");
+}
+
+std::size_t solve_constant_power(double const R_eff, double const U_eq,
+                                 double const P, PowerSolver const solver,
+                                 double &U, double &I)
+{
+  if ((solver == PowerSolver::CLOSED_FORM) || (P == 0.0))
+  {
+    // U is the root of U^2 - U_eq U - R_eff P = 0 that tends to U_eq when P
+    // goes to zero. It is written such that there is no cancellation.
+    double const discriminant = U_eq * U_eq + 4.0 * R_eff * P;
+    if (discriminant < 0.0)
+      throw std::runtime_error(
+          "The power " + std::to_string(P) +
+          " exceeds what the device can deliver during the time step");
+    U = 0.5 * (U_eq + std::copysign(std::sqrt(discriminant), U_eq));
+    I = (U != 0.0) ? P / U : 0.0;
+    return 0;
+  }
+
+  double const ATOL = 1.0e-14;
+  double const RTOL = 1.0e-14;
+  std::size_t const MAXIT = 30;
+  double const TOL = std::abs(P) * RTOL + ATOL;
+  std::size_t k = 0;
+  while (true)
+  {
+    ++k;
+    I = P / U;
+    if (solver == PowerSolver::FIXED_POINT)
+      U = R_eff * I + U_eq;
+    else
+      U += (R_eff * P / U - U + U_eq) / (R_eff * P / (U * U) + 1.0);
+    if (std::abs(P - U * I) < TOL)
+      break;
+    if (k >= MAXIT)
+      throw std::runtime_error(power_solver_to_string(solver) +
+                               " fail to converge within " +
+                               std::to_string(MAXIT) + " iterations");
+  }
+  return k;
+}
+
+namespace internal
+{
+// The functions below advance a capacitor C with a leakage conductance G (zero
+// for SeriesRC) in series with a resistance R by an arbitrarily long interval
+// and compute the charge and the energy that entered the circuit. They use
+// the exact solution of the circuit over the interval.
+void evolve_over_interval_constant_current(double const duration,
+                                           double const current,
+                                           double const R, double const G,
+                                           double const C, double &U_C,
+                                           double &U, double &I,
+                                           double &charge, double &energy)
+{
+  RCPropagator propagator(duration, R, G, C);
+  double const integral_U_C =
+      duration * (internal::phi(G * duration / C) * U_C +
+                  propagator.get_ramp() * current);
+  charge = current * duration;
+  energy = current * integral_U_C + R * current * current * duration;
+  U_C = propagator.get_decay() * U_C + propagator.get_charge() * current;
+  I = current;
+  U = U_C + R * I;
+}
+
+void evolve_over_interval_constant_voltage(double const duration,
+                                           double const voltage,
+                                           double const R, double const G,
+                                           double const C, double &U_C,
+                                           double &U, double &I,
+                                           double &charge, double &energy)
+{
+  RCPropagator propagator(duration, R, G, C);
+  double const gain = propagator.get_gain();
+  double const relaxation = propagator.get_voltage_relaxation();
+  // The charge stored in the capacitor plus the charge lost in the leakage
+  // resistance.
+  charge = C * gain * (voltage * gain - U_C) * relaxation +
+           G * gain * voltage * duration;
+  energy = voltage * charge;
+  U_C += (voltage * gain - U_C) * relaxation;
+  U = voltage;
+  I = (U - U_C) / R;
+}
+
+void evolve_over_interval_constant_load(double const duration,
+                                        double const load, double const R,
+                                        double const G, double const C,
+                                        double &U_C, double &U, double &I,
+                                        double &charge, double &energy)
+{
+  double const x = duration * (1.0 / (R + load) + G) / C;
+  charge = -U_C * duration * internal::phi(x) / (R + load);
+  energy = -load / ((R + load) * (R + load)) * U_C * U_C * duration *
+           internal::phi(2.0 * x);
+  U_C *= std::exp(-x);
+  I = -U_C / (R + load);
+  U = U_C + R * I;
+}
+} // end namespace internal
+
 void ParallelRC::inspect(EnergyStorageDeviceInspector *inspector)
 {
   inspector->inspect(this);
@@ -34,14 +161,15 @@ SeriesRC::SeriesRC(boost::property_tree::ptree const &ptree,
     : EnergyStorageDevice(comm), R(ptree.get<double>("series_resistance")),
       C(ptree.get<double>("capacitance")),
       U_C(ptree.get<double>("initial_voltage", 0.0)), U(U_C), I(0.0),
-      _comm(comm)
+      _comm(comm), _power_solver(string_to_power_solver(
+                       ptree.get<std::string>("power_solver", "CLOSED_FORM")))
 {
 }
 
 void SeriesRC::evolve_one_time_step_constant_load(double const delta_t,
                                                   double const load)
 {
-  U_C *= std::exp(-delta_t / ((R + load) * C));
+  U_C *= get_propagator(delta_t).get_load_decay(load);
   I = -U_C / (R + load);
   U = U_C + R * I;
 }
@@ -49,12 +177,14 @@ void SeriesRC::evolve_one_time_step_constant_load(double const delta_t,
 void SeriesRC::evolve_one_time_step_constant_power(double const delta_t,
                                                    double const power)
 {
-  evolve_one_time_step_constant_power(delta_t, power, "NEWTON");
+  evolve_one_time_step_constant_power(delta_t, power, _power_solver);
 }
 
 void SeriesRC::evolve_one_time_step_constant_current(double const delta_t,
                                                      double const current)
 {
+  // Without a leakage path the capacitor integrates the current exactly and
+  // there is nothing worth caching.
   U_C += current * delta_t / C;
   I = current;
   U = R * I + U_C;
@@ -63,8 +193,7 @@ void SeriesRC::evolve_one_time_step_constant_current(double const delta_t,
 void SeriesRC::evolve_one_time_step_linear_current(double const delta_t,
                                                    double const current)
 {
-  U_C += I * delta_t / C;
-  U_C += (current - I) * 0.5 * delta_t / C;
+  U_C += (current + I) * delta_t / (2. * C);
   I = current;
   U = R * I + U_C;
 }
@@ -72,7 +201,9 @@ void SeriesRC::evolve_one_time_step_linear_current(double const delta_t,
 void SeriesRC::evolve_one_time_step_constant_voltage(double const delta_t,
                                                      double const voltage)
 {
-  U_C -= (voltage - U_C) * std::expm1(-delta_t / (R * C));
+  RCPropagator &propagator = get_propagator(delta_t);
+  U_C += (voltage * propagator.get_gain() - U_C) *
+         propagator.get_voltage_relaxation();
   U = voltage;
   I = (U - U_C) / R;
 }
@@ -80,9 +211,10 @@ void SeriesRC::evolve_one_time_step_constant_voltage(double const delta_t,
 void SeriesRC::evolve_one_time_step_linear_voltage(double const delta_t,
                                                    double const voltage)
 {
-  U_C -= (U - U_C) * std::expm1(-delta_t / (R * C));
-  U_C += (voltage - U) / delta_t *
-         (delta_t + R * C * std::expm1(-delta_t / (R * C)));
+  RCPropagator &propagator = get_propagator(delta_t);
+  U_C += (U * propagator.get_gain() - U_C) *
+             propagator.get_voltage_relaxation() +
+         (voltage - U) * propagator.get_voltage_ramp();
   U = voltage;
   I = (U - U_C) / R;
 }
@@ -108,34 +240,47 @@ void SeriesRC::evolve_one_time_step_linear_load(double const delta_t,
 std::size_t SeriesRC::evolve_one_time_step_constant_power(
     double const delta_t, double const power, std::string const &method)
 {
-  // TODO: if P is zero do constant current 0
-  double const P = power;
-  double const ATOL = 1.0e-14;
-  double const RTOL = 1.0e-14;
-  std::size_t const MAXIT = 30;
-  double const TOL = std::abs(P) * RTOL + ATOL;
-  std::size_t k = 0;
-  while (true)
-  {
-    ++k;
-    I = P / U;
-    if (method.compare("FIXED_POINT") == 0)
-      U = (R + delta_t / C) * I + U_C;
-    else if (method.compare("NEWTON") == 0)
-      U += ((R + delta_t / C) * P / U - U + U_C) /
-           ((R + delta_t / C) * P / (U * U) + 1.0);
-    else
-      throw std::runtime_error("invalid method " + method);
-    if (std::abs(P - U * I) < TOL)
-      break;
-    if (k >= MAXIT)
-      throw std::runtime_error(method + " fail to converge within " +
-                               std::to_string(MAXIT) + " iterations");
-  }
-  U_C += I * delta_t / C;
+  return evolve_one_time_step_constant_power(delta_t, power,
+                                             string_to_power_solver(method));
+}
+
+std::size_t SeriesRC::evolve_one_time_step_constant_power(
+    double const delta_t, double const power, PowerSolver const solver)
+{
+  double const charge = delta_t / C;
+  std::size_t const k =
+      solve_constant_power(R + charge, U_C, power, solver, U, I);
+  U_C += charge * I;
   return k;
 }
 
+void SeriesRC::evolve_over_interval_constant_current(double const duration,
+                                                     double const current,
+                                                     double &charge,
+                                                     double &energy)
+{
+  internal::evolve_over_interval_constant_current(duration, current, R, 0.0, C,
+                                                  U_C, U, I, charge, energy);
+}
+
+void SeriesRC::evolve_over_interval_constant_voltage(double const duration,
+                                                     double const voltage,
+                                                     double &charge,
+                                                     double &energy)
+{
+  internal::evolve_over_interval_constant_voltage(duration, voltage, R, 0.0, C,
+                                                  U_C, U, I, charge, energy);
+}
+
+void SeriesRC::evolve_over_interval_constant_load(double const duration,
+                                                  double const load,
+                                                  double &charge,
+                                                  double &energy)
+{
+  internal::evolve_over_interval_constant_load(duration, load, R, 0.0, C, U_C,
+                                               U, I, charge, energy);
+}
+
 void SeriesRC::save(const std::string &filename) const
 {
   if (_comm.rank() == 0)
@@ -172,15 +317,17 @@ ParallelRC::ParallelRC(boost::property_tree::ptree const &ptree,
       C(ptree.get<double>("capacitance")),
       U_C(ptree.get<double>("initial_voltage", 0.0)),
       U((R_series + R_parallel) / R_parallel * U_C),
-      I(U / (R_series + R_parallel)), _comm(comm)
+      I(U / (R_series + R_parallel)), _comm(comm),
+      _power_solver(string_to_power_solver(
+          ptree.get<std::string>("power_solver", "CLOSED_FORM")))
 {
 }
 
 void ParallelRC::evolve_one_time_step_constant_current(double const delta_t,
                                                        double const current)
 {
-  U_C = R_parallel * current +
-        (U_C - R_parallel * current) * std::exp(-delta_t / (R_parallel * C));
+  RCPropagator &propagator = get_propagator(delta_t);
+  U_C = propagator.get_decay() * U_C + propagator.get_charge() * current;
   I = current;
   U = R_series * I + U_C;
 }
@@ -188,10 +335,9 @@ void ParallelRC::evolve_one_time_step_constant_current(double const delta_t,
 void ParallelRC::evolve_one_time_step_linear_current(double const delta_t,
                                                      double const current)
 {
-  U_C = R_parallel * I +
-        (U_C - R_parallel * I) * std::exp(-delta_t / (R_parallel * C));
-  U_C += R_parallel * (current - I) / delta_t *
-         (delta_t + (R_parallel * C) * std::expm1(-delta_t / (R_parallel * C)));
+  RCPropagator &propagator = get_propagator(delta_t);
+  U_C = propagator.get_decay() * U_C + propagator.get_charge() * I +
+        propagator.get_ramp() * (current - I);
   I = current;
   U = R_series * I + U_C;
 }
@@ -199,9 +345,9 @@ void ParallelRC::evolve_one_time_step_linear_current(double const delta_t,
 void ParallelRC::evolve_one_time_step_constant_voltage(double const delta_t,
                                                        double const voltage)
 {
-  U_C -= (voltage * R_parallel / (R_series + R_parallel) - U_C) *
-         std::expm1(-delta_t * (R_series + R_parallel) /
-                    (R_series * R_parallel * C));
+  RCPropagator &propagator = get_propagator(delta_t);
+  U_C += (voltage * propagator.get_gain() - U_C) *
+         propagator.get_voltage_relaxation();
   U = voltage;
   I = (U - U_C) / R_series;
 }
@@ -209,14 +355,10 @@ void ParallelRC::evolve_one_time_step_constant_voltage(double const delta_t,
 void ParallelRC::evolve_one_time_step_linear_voltage(double const delta_t,
                                                      double const voltage)
 {
-  U_C -= (U * R_parallel / (R_series + R_parallel) - U_C) *
-         std::expm1(-delta_t * (R_series + R_parallel) /
-                    (R_series * R_parallel * C));
-  U_C += (voltage - U) / delta_t * R_parallel / (R_series + R_parallel) *
-         (delta_t +
-          (R_series * R_parallel * C) / (R_series + R_parallel) *
-              std::expm1(-delta_t * (R_series + R_parallel) /
-                         (R_series * R_parallel * C)));
+  RCPropagator &propagator = get_propagator(delta_t);
+  U_C += (U * propagator.get_gain() - U_C) *
+             propagator.get_voltage_relaxation() +
+         (voltage - U) * propagator.get_voltage_ramp();
   U = voltage;
   I = (U - U_C) / R_series;
 }
@@ -242,8 +384,7 @@ void ParallelRC::evolve_one_time_step_linear_load(double const delta_t,
 void ParallelRC::evolve_one_time_step_constant_load(double const delta_t,
                                                     double const load)
 {
-  U_C *= std::exp(-delta_t * (1.0 + (R_series + load) / R_parallel) /
-                  ((R_series + load) * C));
+  U_C *= get_propagator(delta_t).get_load_decay(load);
   I = -U_C / (R_series + load);
   U = U_C + R_series * I;
 }
@@ -251,47 +392,57 @@ void ParallelRC::evolve_one_time_step_constant_load(double const delta_t,
 void ParallelRC::evolve_one_time_step_constant_power(double const delta_t,
                                                      double const power)
 {
-  evolve_one_time_step_constant_power(delta_t, power, "NEWTON");
+  evolve_one_time_step_constant_power(delta_t, power, _power_solver);
 }
 
 std::size_t ParallelRC::evolve_one_time_step_constant_power(
     double const delta_t, double const power, std::string const &method)
 {
-  // TODO: if P is zero do constant current 0
-  double const P = power;
-  double const ATOL = 1.0e-14;
-  double const RTOL = 1.0e-14;
-  std::size_t const MAXIT = 30;
-  double const TOL = std::abs(P) * RTOL + ATOL;
-  std::size_t k = 0;
-  while (true)
-  {
-    ++k;
-    I = P / U;
-    if (method.compare("FIXED_POINT") == 0)
-      U = (R_series + R_parallel) * I +
-          (U_C - R_parallel * I) * std::exp(-delta_t / (R_parallel * C));
-    else if (method.compare("NEWTON") == 0)
-      U += ((R_series +
-             R_parallel * (1.0 - std::exp(-delta_t / (R_parallel * C)))) *
-                P / U -
-            U + U_C * std::exp(-delta_t / (R_parallel * C))) /
-           ((R_series +
-             R_parallel * (1.0 - std::exp(-delta_t / (R_parallel * C)))) *
-                P / (U * U) +
-            1.0);
-    else
-      throw std::runtime_error("invalid method " + method);
-    if (std::abs(P - U * I) < TOL)
-      break;
-    if (k >= MAXIT)
-      throw std::runtime_error(method + " fail to converge within " +
-                               std::to_string(MAXIT) + " iterations");
-  }
-  U_C = U - R_series * I;
+  return evolve_one_time_step_constant_power(delta_t, power,
+                                             string_to_power_solver(method));
+}
+
+std::size_t ParallelRC::evolve_one_time_step_constant_power(
+    double const delta_t, double const power, PowerSolver const solver)
+{
+  RCPropagator &propagator = get_propagator(delta_t);
+  double const U_eq = propagator.get_decay() * U_C;
+  std::size_t const k = solve_constant_power(
+      R_series + propagator.get_charge(), U_eq, power, solver, U, I);
+  U_C = U_eq + propagator.get_charge() * I;
   return k;
 }
 
+void ParallelRC::evolve_over_interval_constant_current(double const duration,
+                                                       double const current,
+                                                       double &charge,
+                                                       double &energy)
+{
+  internal::evolve_over_interval_constant_current(duration, current, R_series,
+                                                  1.0 / R_parallel, C, U_C, U,
+                                                  I, charge, energy);
+}
+
+void ParallelRC::evolve_over_interval_constant_voltage(double const duration,
+                                                       double const voltage,
+                                                       double &charge,
+                                                       double &energy)
+{
+  internal::evolve_over_interval_constant_voltage(duration, voltage, R_series,
+                                                  1.0 / R_parallel, C, U_C, U,
+                                                  I, charge, energy);
+}
+
+void ParallelRC::evolve_over_interval_constant_load(double const duration,
+                                                    double const load,
+                                                    double &charge,
+                                                    double &energy)
+{
+  internal::evolve_over_interval_constant_load(duration, load, R_series,
+                                               1.0 / R_parallel, C, U_C, U, I,
+                                               charge, energy);
+}
+
 void ParallelRC::save(const std::string &filename) const
 {
   if (_comm.rank() == 0)
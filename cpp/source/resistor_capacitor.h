@@ -9,6 +9,7 @@
 #define CAP_RESISTOR_CAPACITOR_H
 
 #include <cap/energy_storage_device.h>
+#include <cap/rc_propagator.h>
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
@@ -17,6 +18,49 @@
 namespace cap
 {
 
+/**
+ * Method used to solve the non-linear problem of the constant power
+ * operating condition. The voltage @f$ U @f$ at the end of the time step
+ * satisfies @f$ U = R_{\mathrm{eff}} P / U + U_{\mathrm{eq}} @f$, which is a
+ * quadratic equation. CLOSED_FORM directly evaluates its root and is the
+ * default. NEWTON and FIXED_POINT (Picard iteration) are kept for
+ * comparison.
+ */
+enum class PowerSolver
+{
+  CLOSED_FORM,
+  NEWTON,
+  FIXED_POINT
+};
+
+/**
+ * Convert @p method to a PowerSolver. Throw an exception if the method is
+ * invalid.
+ */
+PowerSolver string_to_power_solver(std::string const &method);
+
+/**
+ * Return the name of the PowerSolver @p solver.
+ */
+std::string power_solver_to_string(PowerSolver const solver);
+
+/**
+ * Solve @f$ U = R_{\mathrm{eff}} P / U + U_{\mathrm{eq}} @f$ for the voltage
+ * @p U and the current @p I = P / U at the end of a time step under constant
+ * power @p P, where @p R_eff and @p U_eq depend on the device but not on the
+ * current. On entry, @p U is the initial guess of the iterative solvers.
+ * Return the number of iterations performed (zero for the closed-form
+ * solution, which is also used whatever the solver when @p P is zero).
+ */
+std::size_t solve_constant_power(double const R_eff, double const U_eq,
+                                 double const P, PowerSolver const solver,
+                                 double &U, double &I);
+
+/**
+ * A resistor in series with a capacitor. The method used for the constant
+ * power operating condition is read from @c power_solver (CLOSED_FORM by
+ * default).
+ */
 class SeriesRC : public EnergyStorageDevice
 {
 public:
@@ -59,17 +103,43 @@ public:
 
   void get_current(double &current) const override { current = I; }
 
+  /**
+   * Return true, the response of the circuit is known in closed form.
+   */
+  bool has_closed_form_response() const override { return true; }
+
+  void evolve_over_interval_constant_current(double const duration,
+                                             double const current,
+                                             double &charge,
+                                             double &energy) override;
+
+  void evolve_over_interval_constant_voltage(double const duration,
+                                             double const voltage,
+                                             double &charge,
+                                             double &energy) override;
+
+  void evolve_over_interval_constant_load(double const duration,
+                                          double const load, double &charge,
+                                          double &energy) override;
+
   /**
    * This function advance the time by @p delta_t seconds. The power is
    * constant during the time step and its value is @p power. This
    * function internally solves a non-linear problem and the third parameter @p
-   * method allows to choose between FIXED_POINT (Picard iteration) and NEWTON.
-   * This function returns the number of non-linear iterations performed to
-   * reach convergence.
+   * method allows to choose between CLOSED_FORM, FIXED_POINT (Picard
+   * iteration), and NEWTON. This function returns the number of non-linear
+   * iterations performed to reach convergence (zero for CLOSED_FORM).
    */
   std::size_t
   evolve_one_time_step_constant_power(double const delta_t, double const power,
-                                      std::string const &method = "NEWTON");
+                                      std::string const &method);
+
+  /**
+   * Same as above but the method is given as a PowerSolver.
+   */
+  std::size_t evolve_one_time_step_constant_power(double const delta_t,
+                                                  double const power,
+                                                  PowerSolver const solver);
 
   /**
    * Save the current state of energy device in a file.
@@ -98,9 +168,24 @@ private:
     std::ignore = version;
   }
 
+  /**
+   * Return the propagator for the time step @p delta_t.
+   */
+  RCPropagator &get_propagator(double const delta_t)
+  {
+    return _propagators.get(delta_t, R, 0.0, C);
+  }
+
   boost::mpi::communicator _comm;
+  PowerSolver _power_solver;
+  RCPropagatorCache _propagators;
 };
 
+/**
+ * A resistor in series with a capacitor and a leakage resistance in
+ * parallel. The method used for the constant power operating condition is read
+ * from @c power_solver (CLOSED_FORM by default).
+ */
 class ParallelRC : public EnergyStorageDevice
 {
 public:
@@ -143,17 +228,43 @@ public:
 
   inline void get_current(double &current) const override { current = I; }
 
+  /**
+   * Return true, the response of the circuit is known in closed form.
+   */
+  bool has_closed_form_response() const override { return true; }
+
+  void evolve_over_interval_constant_current(double const duration,
+                                             double const current,
+                                             double &charge,
+                                             double &energy) override;
+
+  void evolve_over_interval_constant_voltage(double const duration,
+                                             double const voltage,
+                                             double &charge,
+                                             double &energy) override;
+
+  void evolve_over_interval_constant_load(double const duration,
+                                          double const load, double &charge,
+                                          double &energy) override;
+
   /**
    * This function advance the time by @p delta_t seconds. The power is
    * constant during the time step and its value is @p power. This
    * function internally solves a non-linear problem and the third parameter @p
-   * method allows to choose between FIXED_POINT (Picard iteration) and NEWTON.
-   * This function returns the number of non-linear iterations performed to
-   * reach convergence.
+   * method allows to choose between CLOSED_FORM, FIXED_POINT (Picard
+   * iteration), and NEWTON. This function returns the number of non-linear
+   * iterations performed to reach convergence (zero for CLOSED_FORM).
    */
   std::size_t
   evolve_one_time_step_constant_power(double const delta_t, double const power,
-                                      std::string const &method = "NEWTON");
+                                      std::string const &method);
+
+  /**
+   * Same as above but the method is given as a PowerSolver.
+   */
+  std::size_t evolve_one_time_step_constant_power(double const delta_t,
+                                                  double const power,
+                                                  PowerSolver const solver);
 
   /**
    * Save the current state of energy device in a file.
@@ -183,7 +294,17 @@ private:
     std::ignore = version;
   }
 
+  /**
+   * Return the propagator for the time step @p delta_t.
+   */
+  RCPropagator &get_propagator(double const delta_t)
+  {
+    return _propagators.get(delta_t, R_series, 1.0 / R_parallel, C);
+  }
+
   boost::mpi::communicator _comm;
+  PowerSolver _power_solver;
+  RCPropagatorCache _propagators;
 };
 
 } // end namespace cap
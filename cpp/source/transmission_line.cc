@@ -0,0 +1,238 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#include <cap/transmission_line.h>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/vector.hpp>
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace cap
+{
+
+REGISTER_ENERGY_STORAGE_DEVICE(TransmissionLine)
+
+TransmissionLine::TransmissionLine(boost::property_tree::ptree const &ptree,
+                                   boost::mpi::communicator const &comm)
+    : EnergyStorageDevice(comm),
+      _n_segments(ptree.get<std::size_t>("n_segments")),
+      _power_solver(string_to_power_solver(
+          ptree.get<std::string>("power_solver", "CLOSED_FORM"))),
+      _delta_t(std::numeric_limits<double>::quiet_NaN()),
+      _response_output(0.0), _I(0.0)
+{
+  double const series_resistance = ptree.get<double>("series_resistance");
+  double const solid_resistance = ptree.get<double>("solid_resistance");
+  double const liquid_resistance = ptree.get<double>("liquid_resistance");
+  double const capacitance = ptree.get<double>("capacitance");
+  double const leakage_resistance = ptree.get<double>(
+      "leakage_resistance", std::numeric_limits<double>::infinity());
+  if (_n_segments == 0)
+    throw std::runtime_error("The transmission line needs at least one "
+                             "segment");
+  if ((series_resistance < 0.0) || (solid_resistance < 0.0) ||
+      (liquid_resistance < 0.0) ||
+      !(solid_resistance + liquid_resistance > 0.0))
+    throw std::runtime_error("The resistances of the transmission line must "
+                             "be non-negative and the solid and the liquid "
+                             "phases can not both be perfect conductors");
+  if (!(capacitance > 0.0) || !(leakage_resistance > 0.0))
+    throw std::runtime_error("The capacitance and the leakage resistance of "
+                             "the transmission line must be positive");
+
+  double const N = static_cast<double>(_n_segments);
+  double const rail_resistance = solid_resistance + liquid_resistance;
+  _segment_capacitance = capacitance / N;
+  _segment_leakage_conductance = 1.0 / (leakage_resistance * N);
+  _interface_conductance = N / rail_resistance;
+  _alpha = liquid_resistance / rail_resistance;
+  // The current flows through half a segment at both ends of the ladder and
+  // splits between the two phases in between.
+  _feedthrough_resistance =
+      series_resistance +
+      (N - 1.0) / N * solid_resistance * liquid_resistance / rail_resistance +
+      0.5 * rail_resistance / N;
+
+  _v.assign(_n_segments, ptree.get<double>("initial_voltage", 0.0));
+  _response.resize(_n_segments);
+  _upper.resize(_n_segments);
+  _inverse_pivot.resize(_n_segments);
+  _U = output(_v);
+}
+
+void TransmissionLine::inspect(EnergyStorageDeviceInspector *inspector)
+{
+  inspector->inspect(this);
+}
+
+double TransmissionLine::output(std::vector<double> const &v) const
+{
+  return (1.0 - _alpha) * v.front() + _alpha * v.back();
+}
+
+void TransmissionLine::factorize(double const delta_t)
+{
+  if (delta_t == _delta_t)
+    return;
+  _delta_t = delta_t;
+
+  // The matrix is C/dt + G_leakage + G_interface L, where L is the
+  // one-dimensional Laplacian with homogeneous Neumann boundary conditions.
+  double const off_diagonal = -_interface_conductance;
+  double const diagonal =
+      _segment_capacitance / delta_t + _segment_leakage_conductance;
+  std::size_t const n = _n_segments;
+  for (std::size_t k = 0; k < n; ++k)
+  {
+    double pivot = diagonal;
+    if (k > 0)
+      pivot += _interface_conductance - off_diagonal * _upper[k - 1];
+    if (k + 1 < n)
+      pivot += _interface_conductance;
+    _inverse_pivot[k] = 1.0 / pivot;
+    _upper[k] = off_diagonal * _inverse_pivot[k];
+  }
+
+  // The current charges the capacitors next to the collector through the
+  // solid phase and the ones next to the separator through the liquid phase.
+  std::fill(_response.begin(), _response.end(), 0.0);
+  _response.front() += 1.0 - _alpha;
+  _response.back() += _alpha;
+  substitute(_response);
+  _response_output = output(_response);
+}
+
+void TransmissionLine::substitute(std::vector<double> &x) const
+{
+  // Forward and backward substitutions of the Thomas algorithm.
+  double const off_diagonal = -_interface_conductance;
+  x[0] *= _inverse_pivot[0];
+  for (std::size_t k = 1; k < _n_segments; ++k)
+    x[k] = (x[k] - off_diagonal * x[k - 1]) * _inverse_pivot[k];
+  for (std::size_t k = _n_segments - 1; k-- > 0;)
+    x[k] -= _upper[k] * x[k + 1];
+}
+
+void TransmissionLine::solve(double const delta_t, double &U_eq, double &R_eff)
+{
+  factorize(delta_t);
+  double const scaling = _segment_capacitance / delta_t;
+  for (double &v : _v)
+    v *= scaling;
+  substitute(_v);
+  U_eq = output(_v);
+  R_eff = _response_output + _feedthrough_resistance;
+}
+
+void TransmissionLine::update(double const current)
+{
+  for (std::size_t k = 0; k < _n_segments; ++k)
+    _v[k] += current * _response[k];
+  _I = current;
+  _U = output(_v) + _feedthrough_resistance * current;
+}
+
+void TransmissionLine::evolve_one_time_step_constant_current(
+    double const delta_t, double const current)
+{
+  double U_eq, R_eff;
+  solve(delta_t, U_eq, R_eff);
+  update(current);
+}
+
+void TransmissionLine::evolve_one_time_step_constant_voltage(
+    double const delta_t, double const voltage)
+{
+  double U_eq, R_eff;
+  solve(delta_t, U_eq, R_eff);
+  update((voltage - U_eq) / R_eff);
+  _U = voltage;
+}
+
+void TransmissionLine::evolve_one_time_step_constant_power(
+    double const delta_t, double const power)
+{
+  double U_eq, R_eff;
+  solve(delta_t, U_eq, R_eff);
+  double current;
+  solve_constant_power(R_eff, U_eq, power, _power_solver, _U, current);
+  update(current);
+}
+
+void TransmissionLine::evolve_one_time_step_constant_load(
+    double const delta_t, double const load)
+{
+  double U_eq, R_eff;
+  solve(delta_t, U_eq, R_eff);
+  update(-U_eq / (R_eff + load));
+}
+
+void TransmissionLine::evolve_one_time_step_linear_current(
+    double const delta_t, double const current)
+{
+  evolve_one_time_step_constant_current(delta_t, current);
+}
+
+void TransmissionLine::evolve_one_time_step_linear_voltage(
+    double const delta_t, double const voltage)
+{
+  evolve_one_time_step_constant_voltage(delta_t, voltage);
+}
+
+void TransmissionLine::evolve_one_time_step_linear_power(double const delta_t,
+                                                         double const power)
+{
+  std::ignore = delta_t;
+  std::ignore = power;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void TransmissionLine::evolve_one_time_step_linear_load(double const delta_t,
+                                                        double const load)
+{
+  std::ignore = delta_t;
+  std::ignore = load;
+
+  throw std::runtime_error("This function is not implemented.");
+}
+
+void TransmissionLine::save(const std::string &filename) const
+{
+  if (_communicator.rank() == 0)
+  {
+    std::ofstream ofs(filename);
+    boost::archive::text_oarchive oa(ofs);
+    oa << _v << _U << _I;
+  }
+}
+
+void TransmissionLine::load(const std::string &filename)
+{
+  if (_communicator.rank() == 0)
+  {
+    // Check that the file exist
+    if (boost::filesystem::exists(filename) == false)
+      throw std::runtime_error("The file " + filename + " does not exists.");
+
+    std::ifstream ifs(filename);
+    if (ifs.good() == false)
+      throw std::runtime_error("Error while opening file " + filename);
+    boost::archive::text_iarchive ia(ifs);
+    std::vector<double> v;
+    ia >> v >> _U >> _I;
+    if (v.size() != _n_segments)
+      throw std::runtime_error("The file " + filename + " does not match the "
+                               "number of segments of the transmission line");
+    _v = v;
+  }
+}
+} // end namespace cap
@@ -0,0 +1,156 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#ifndef CAP_TRANSMISSION_LINE_H
+#define CAP_TRANSMISSION_LINE_H
+
+#include <cap/energy_storage_device.h>
+#include <cap/resistor_capacitor.h>
+#include <string>
+#include <vector>
+
+namespace cap
+{
+
+/**
+ * This class represents a porous electrode as a transmission line, i.e. a
+ * ladder of @c n_segments double-layer capacitors connecting a solid-phase
+ * rail to a liquid-phase rail. The current enters the solid phase on the
+ * side of the current collector and leaves through the liquid phase on the
+ * side of the separator. The ladder is in series with @c series_resistance
+ * (separator and collectors).
+ * @code
+ * type                 TransmissionLine
+ * n_segments           50
+ * series_resistance    20.0e-3 ; [ohm]
+ * solid_resistance      1.0e-3 ; [ohm] whole solid phase
+ * liquid_resistance    50.0e-3 ; [ohm] whole liquid phase
+ * capacitance           3.0    ; [farad] sum of the capacitors of the ladder
+ * leakage_resistance    2.5e+6 ; [ohm] optional, all the segments in parallel
+ * initial_voltage       0.0    ; [volt] optional
+ * @endcode
+ * The voltages of the capacitors are advanced with the backward Euler method.
+ * The linear system is tridiagonal and it is solved with the Thomas
+ * algorithm, so that a time step costs O(n_segments) operations. Since the
+ * voltage at the terminals is an affine function of the current, all the
+ * operating conditions require a single solve. The linear operating
+ * conditions use the value of the current or the voltage at the end of the
+ * time step. The method used for the constant power operating condition is
+ * read from @c power_solver (CLOSED_FORM by default).
+ */
+class TransmissionLine : public EnergyStorageDevice
+{
+public:
+  TransmissionLine(boost::property_tree::ptree const &ptree,
+                   boost::mpi::communicator const &comm);
+
+  void inspect(EnergyStorageDeviceInspector *inspector) override;
+
+  void evolve_one_time_step_constant_current(double const delta_t,
+                                             double const current) override;
+
+  void evolve_one_time_step_constant_voltage(double const delta_t,
+                                             double const voltage) override;
+
+  void evolve_one_time_step_constant_power(double const delta_t,
+                                           double const power) override;
+
+  void evolve_one_time_step_constant_load(double const delta_t,
+                                          double const load) override;
+
+  void evolve_one_time_step_linear_current(double const delta_t,
+                                           double const current) override;
+
+  void evolve_one_time_step_linear_voltage(double const delta_t,
+                                           double const voltage) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_power(double const delta_t,
+                                         double const power) override;
+
+  /**
+   * This function is not implemented and throws an exception.
+   */
+  void evolve_one_time_step_linear_load(double const delta_t,
+                                        double const load) override;
+
+  void get_voltage(double &voltage) const override { voltage = _U; }
+
+  void get_current(double &current) const override { current = _I; }
+
+  /**
+   * Return the voltages of the capacitors of the ladder, starting from the
+   * current collector.
+   */
+  std::vector<double> const &get_capacitor_voltages() const { return _v; }
+
+  /**
+   * Save the current state of the transmission line in a file.
+   */
+  void save(const std::string &filename) const override;
+
+  /**
+   * Load the state of the transmission line from a file.
+   */
+  void load(const std::string &filename) override;
+
+private:
+  /**
+   * Factorize the tridiagonal matrix for the time step @p delta_t and compute
+   * the response of the ladder to a unit current. Nothing is done if the
+   * time step has not changed.
+   */
+  void factorize(double const delta_t);
+
+  /**
+   * Overwrite @p x by the solution of the linear system factorized by
+   * factorize().
+   */
+  void substitute(std::vector<double> &x) const;
+
+  /**
+   * Solve the backward Euler step without current. On return, the voltages
+   * of the capacitors are @c _v + current @c _response and the voltage at
+   * the terminals is @p U_eq + @p R_eff current.
+   */
+  void solve(double const delta_t, double &U_eq, double &R_eff);
+
+  /**
+   * Finish the time step once the current is known.
+   */
+  void update(double const current);
+
+  /**
+   * Voltage at the terminals due to the capacitors of the ladder.
+   */
+  double output(std::vector<double> const &v) const;
+
+  std::size_t _n_segments;
+  double _segment_capacitance;
+  double _segment_leakage_conductance;
+  double _interface_conductance;
+  // Fraction of the current that goes through the liquid phase when the
+  // capacitors are not charging.
+  double _alpha;
+  // Resistance seen from the terminals when the capacitors are shorted.
+  double _feedthrough_resistance;
+  PowerSolver _power_solver;
+  double _delta_t;
+  std::vector<double> _v;
+  std::vector<double> _response;
+  std::vector<double> _upper;
+  std::vector<double> _inverse_pivot;
+  double _response_output;
+  double _U;
+  double _I;
+};
+
+} // end namespace cap
+
+#endif // CAP_TRANSMISSION_LINE_H
@@ -0,0 +1,121 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE EquivalentCircuit2
+
+#include "main.cc"
+
+#include <cap/energy_storage_device.h>
+#include <cap/equivalent_circuit.h>
+#include <cap/material_properties.h>
+#include <boost/property_tree/info_parser.hpp>
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include <sstream>
+
+double const TOLERANCE = 1.0e-10; // in percentage units
+
+boost::property_tree::ptree make_database()
+{
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::property_tree::ptree geometry_database;
+  boost::property_tree::info_parser::read_info("read_mesh.info",
+                                               geometry_database);
+  ptree.put_child("geometry", geometry_database);
+  return ptree;
+}
+
+BOOST_AUTO_TEST_CASE(test_material_properties)
+{
+  boost::property_tree::ptree const database =
+      make_database().get_child("material_properties");
+
+  // conversion from the units of the database to SI units is done by hand
+  auto anode = cap::compute_material_properties(database, "anode");
+  BOOST_CHECK_CLOSE(anode["specific_surface_area"],
+                    3.0 * 0.67 / 1.5e-9, TOLERANCE);
+  BOOST_CHECK_CLOSE(anode["specific_capacitance"],
+                    3.0 * 0.67 / 1.5e-9 * 3.134e-2, TOLERANCE);
+  BOOST_CHECK_CLOSE(anode["solid_electrical_conductivity"],
+                    0.33 / 1.92e-2, TOLERANCE);
+  BOOST_CHECK_CLOSE(anode["liquid_electrical_conductivity"],
+                    0.67 / 14.9 / 2.3, TOLERANCE);
+  BOOST_CHECK_CLOSE(anode["density"], 0.67 * 1.2e3 + 0.33 * 2.3e3, TOLERANCE);
+
+  auto separator = cap::compute_material_properties(database, "separator");
+  BOOST_TEST(separator["specific_capacitance"] == 0.0);
+  BOOST_TEST(separator["faradaic_reaction_coefficient"] == 0.0);
+  BOOST_TEST(separator["solid_electrical_conductivity"] == 0.0);
+  BOOST_CHECK_CLOSE(separator["liquid_electrical_conductivity"],
+                    0.6 / 14.9 / 1.29, TOLERANCE);
+
+  auto collector = cap::compute_material_properties(database, "collector");
+  BOOST_CHECK_CLOSE(collector["solid_electrical_conductivity"],
+                    1.0 / 28.2e-9, TOLERANCE);
+  BOOST_TEST(collector["liquid_electrical_conductivity"] == 0.0);
+  BOOST_CHECK_CLOSE(collector["density"], 2.7e3, TOLERANCE);
+
+  boost::property_tree::ptree invalid = database;
+  invalid.put("collector.type", "vacuum");
+  BOOST_CHECK_THROW(cap::compute_material_properties(invalid, "collector"),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_no_output)
+{
+  // building an equivalent circuit must not write anything to the console
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree = make_database();
+  ptree.put("type", "EquivalentCircuit");
+  std::stringstream buffer;
+  std::streambuf *const stdout_buffer = std::cout.rdbuf(buffer.rdbuf());
+  auto device = cap::EnergyStorageDevice::build(ptree, world);
+  ptree.put("type", "EquivalentTransmissionLine");
+  auto transmission_line = cap::EnergyStorageDevice::build(ptree, world);
+  std::cout.rdbuf(stdout_buffer);
+  BOOST_TEST(buffer.str().empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_batch_and_memoization)
+{
+  std::vector<boost::property_tree::ptree> inputs(4, make_database());
+  inputs[1].put("geometry.separator_thickness", 50.0e-4);
+  inputs[2].put("material_properties.electrode_material"
+                ".exchange_current_density",
+                0.0);
+  // same as the first one, should hit the cache
+
+  std::vector<boost::property_tree::ptree> outputs;
+  cap::compute_equivalent_circuit(inputs, outputs);
+  BOOST_TEST(outputs.size() == inputs.size());
+  for (std::size_t i = 0; i < inputs.size(); ++i)
+  {
+    boost::property_tree::ptree output;
+    cap::compute_equivalent_circuit(inputs[i], output);
+    BOOST_TEST(output == outputs[i]);
+  }
+  BOOST_TEST(outputs[3] == outputs[0]);
+  // the cache must not be confused by a change in the geometry or in the
+  // material properties
+  BOOST_TEST(outputs[1].get<double>("series_resistance") >
+             outputs[0].get<double>("series_resistance"));
+  BOOST_TEST(outputs[0].get<std::string>("type") == "ParallelRC");
+  BOOST_TEST(outputs[2].get<std::string>("type") == "SeriesRC");
+
+  std::vector<boost::property_tree::ptree> transmission_lines;
+  cap::compute_transmission_line(inputs, transmission_lines);
+  BOOST_TEST(transmission_lines.size() == inputs.size());
+  BOOST_TEST(transmission_lines[3] == transmission_lines[0]);
+  BOOST_TEST(transmission_lines[2].count("leakage_resistance") == 0);
+
+  // outputs must be empty
+  BOOST_CHECK_THROW(cap::compute_equivalent_circuit(inputs, outputs),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(cap::compute_transmission_line(inputs, outputs),
+                    std::runtime_error);
+}
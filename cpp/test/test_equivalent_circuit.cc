@@ -38,6 +38,19 @@ BOOST_AUTO_TEST_CASE(build_equivalent_circuit)
   not_empty_database.put("something", "not_empty");
   BOOST_CHECK_THROW(cap::compute_equivalent_circuit(ptree, not_empty_database),
                     std::runtime_error);
+  BOOST_CHECK_THROW(cap::compute_transmission_line(ptree, not_empty_database),
+                    std::runtime_error);
+
+  // the transmission line is built from the same database
+  ptree.put("type", "EquivalentTransmissionLine");
+  ptree.put("n_segments", 10);
+  boost::property_tree::ptree transmission_line_database;
+  cap::compute_transmission_line(ptree, transmission_line_database);
+  BOOST_TEST(transmission_line_database.get<std::string>("type") ==
+             "TransmissionLine");
+  BOOST_TEST(transmission_line_database.get<std::size_t>("n_segments") == 10);
+  auto transmission_line = cap::EnergyStorageDevice::build(ptree, world);
+  transmission_line->evolve_one_time_step_constant_current(0.1, 1.0);
 }
 
 BOOST_DATA_TEST_CASE(test_equivalent_circuit,
@@ -0,0 +1,152 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE FractionalRC
+
+#include "main.cc"
+
+#include <cap/fractional_rc.h>
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+double const R_SERIES = 50.0e-3;
+double const Q = 3.0;
+double const ALPHA = 0.8;
+double const TOLERANCE = 1.0e-8; // in percentage units
+
+boost::property_tree::ptree make_database()
+{
+  boost::property_tree::ptree ptree;
+  ptree.put("type", "FractionalRC");
+  ptree.put("series_resistance", R_SERIES);
+  ptree.put("cpe_coefficient", Q);
+  ptree.put("cpe_exponent", ALPHA);
+  ptree.put("n_modes", 60);
+  ptree.put("min_time_constant", 1.0e-4);
+  ptree.put("max_time_constant", 1.0e+6);
+  return ptree;
+}
+
+BOOST_AUTO_TEST_CASE(test_constant_current)
+{
+  // Under constant current, the voltage across the constant-phase element is
+  // I t^alpha / (Q Gamma(1 + alpha)).
+  boost::mpi::communicator world;
+  cap::FractionalRC device(make_database(), world);
+  BOOST_TEST(device.n_modes() == 61);
+  double const current = 0.5;
+  double const dt = 0.1;
+  for (int step = 1; step <= 1000; ++step)
+  {
+    device.evolve_one_time_step_constant_current(dt, current);
+    double const t = step * dt;
+    double voltage;
+    device.get_voltage(voltage);
+    BOOST_CHECK_CLOSE(voltage, current * R_SERIES +
+                                   current * std::pow(t, ALPHA) /
+                                       (Q * std::tgamma(1.0 + ALPHA)),
+                      0.1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_time_step_independence)
+{
+  // The modes are advanced exactly, so the state does not depend on the time
+  // step when the current is piecewise constant or linear.
+  boost::mpi::communicator world;
+  cap::FractionalRC coarse(make_database(), world);
+  cap::FractionalRC fine(make_database(), world);
+  coarse.evolve_one_time_step_constant_current(1.0, 0.3);
+  coarse.evolve_one_time_step_linear_current(2.0, -0.1);
+  for (int step = 0; step < 10; ++step)
+    fine.evolve_one_time_step_constant_current(0.1, 0.3);
+  for (int step = 1; step <= 20; ++step)
+    fine.evolve_one_time_step_linear_current(0.1, 0.3 - 0.4 * step / 20.0);
+  double coarse_voltage;
+  double fine_voltage;
+  coarse.get_voltage(coarse_voltage);
+  fine.get_voltage(fine_voltage);
+  BOOST_CHECK_CLOSE(fine_voltage, coarse_voltage, TOLERANCE);
+}
+
+BOOST_AUTO_TEST_CASE(test_operating_conditions)
+{
+  // The current obtained under constant voltage, power, or load must yield
+  // the same state when it is imposed.
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree = make_database();
+  ptree.put("initial_voltage", 1.0);
+  auto device = cap::EnergyStorageDevice::build(ptree, world);
+  cap::FractionalRC other(ptree, world);
+  double const dt = 0.05;
+  std::vector<std::function<void(cap::EnergyStorageDevice &)>> const
+      operating_conditions = {
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_voltage(dt, 2.1);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_power(dt, -0.5);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_load(dt, 0.2);
+          }};
+  for (auto const &evolve : operating_conditions)
+  {
+    evolve(*device);
+    double current;
+    double voltage;
+    device->get_current(current);
+    device->get_voltage(voltage);
+    other.evolve_one_time_step_constant_current(dt, current);
+    double other_voltage;
+    other.get_voltage(other_voltage);
+    BOOST_CHECK_CLOSE(other_voltage, voltage, TOLERANCE);
+  }
+  double current;
+  double voltage;
+  device->get_current(current);
+  device->get_voltage(voltage);
+  BOOST_CHECK_CLOSE(voltage, -0.2 * current, TOLERANCE);
+
+  // linear voltage
+  device->evolve_one_time_step_linear_voltage(dt, 1.5);
+  device->get_voltage(voltage);
+  BOOST_CHECK_CLOSE(voltage, 1.5, TOLERANCE);
+  BOOST_CHECK_THROW(device->evolve_one_time_step_linear_power(dt, 1.0),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(device->evolve_one_time_step_linear_load(dt, 1.0),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_save_load)
+{
+  boost::mpi::communicator world;
+  cap::FractionalRC device(make_database(), world);
+  device.evolve_one_time_step_constant_current(0.1, 1.0);
+  std::string const filename = "fractional_rc.txt";
+  device.save(filename);
+  cap::FractionalRC restored(make_database(), world);
+  restored.load(filename);
+  std::remove(filename.c_str());
+  device.evolve_one_time_step_constant_current(0.1, 1.0);
+  restored.evolve_one_time_step_constant_current(0.1, 1.0);
+  double voltage;
+  double restored_voltage;
+  device.get_voltage(voltage);
+  restored.get_voltage(restored_voltage);
+  BOOST_TEST(restored_voltage == voltage);
+
+  boost::property_tree::ptree ptree = make_database();
+  ptree.put("cpe_exponent", 1.0);
+  BOOST_CHECK_THROW(cap::FractionalRC(ptree, world), std::runtime_error);
+}
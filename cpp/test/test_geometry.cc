@@ -16,10 +16,13 @@
 #include <deal.II/grid/grid_out.h>
 #include <deal.II/grid/grid_tools.h>
 #include <deal.II/lac/dynamic_sparsity_pattern.h>
+#include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/info_parser.hpp>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <unordered_map>
 
 // - Check that a mesh can be loaded, that the areas are computed correctly, and
@@ -276,6 +279,33 @@ BOOST_AUTO_TEST_CASE(check_repetitions)
   }
 
   BOOST_CHECK(cells_done.size() == n_cells);
+
+  // The first cell of the stack has 46 coarse cells and each repetition adds
+  // 37 coarse cells. The mesh is refined twice.
+  BOOST_CHECK(tria->n_global_active_cells() == (46 + 5 * 37) * 16);
+
+  // The repetitions are stacked one after the other along the first
+  // coordinate: they neither overlap nor leave gaps.
+  double const cm_to_m = 0.01;
+  double const collector_thickness =
+      geometry_database.get<double>("anode_collector_thickness") * cm_to_m;
+  double const cell_thickness =
+      (geometry_database.get<double>("anode_electrode_thickness") +
+       geometry_database.get<double>("separator_thickness") +
+       geometry_database.get<double>("cathode_electrode_thickness")) *
+      cm_to_m;
+  double min_x = std::numeric_limits<double>::max();
+  double max_x = std::numeric_limits<double>::lowest();
+  std::vector<bool> const &used_vertices = tria->get_used_vertices();
+  std::vector<dealii::Point<2>> const &vertices = tria->get_vertices();
+  for (unsigned int i = 0; i < vertices.size(); ++i)
+    if (used_vertices[i])
+    {
+      min_x = std::min(min_x, vertices[i][0]);
+      max_x = std::max(max_x, vertices[i][0]);
+    }
+  BOOST_TEST(max_x - min_x == 6 * cell_thickness + 7 * collector_thickness,
+             boost::test_tools::tolerance(1e-10));
 }
 
 BOOST_AUTO_TEST_CASE(test_hyper_trapezoid_2d_geometry)
@@ -317,3 +347,68 @@ BOOST_AUTO_TEST_CASE(test_hyper_trapezoid_2d_geometry)
   write_mesh("output_test_geometry_1.vtu", geometry->get_triangulation());
   BOOST_CHECK(n_cells == triangulation->n_active_cells());
 }
+
+// Check that a geometry built twice is loaded from the cache the second time
+// and that modifying the database invalidates the cache.
+BOOST_AUTO_TEST_CASE(geometry_cache)
+{
+  boost::mpi::communicator comm;
+  std::string const cache_directory = "geometry_cache";
+  if (comm.rank() == 0)
+    boost::filesystem::remove_all(cache_directory);
+  comm.barrier();
+
+  boost::property_tree::ptree geometry_database;
+  boost::property_tree::info_parser::read_info("generate_mesh.info",
+                                               geometry_database);
+  geometry_database.put("cache_directory", cache_directory);
+  auto build_geometry = [&](boost::property_tree::ptree const &database)
+  {
+    return std::make_shared<cap::Geometry<2>>(
+        std::make_shared<boost::property_tree::ptree>(database), comm);
+  };
+  auto n_cache_entries = [&]()
+  {
+    unsigned int n_entries = 0;
+    for (boost::filesystem::directory_iterator it(cache_directory);
+         it != boost::filesystem::directory_iterator(); ++it)
+      if (it->path().extension() == ".coarse_mesh")
+        ++n_entries;
+    return n_entries;
+  };
+  auto compute_anode_area = [&](cap::Geometry<2> &geometry)
+  {
+    double area = 0.;
+    auto tria = geometry.get_triangulation();
+    for (auto cell : tria->active_cell_iterators())
+      if (cell->is_locally_owned())
+        for (unsigned int f = 0; f < dealii::GeometryInfo<2>::faces_per_cell;
+             ++f)
+          if (cell->face(f)->at_boundary() &&
+              (cell->face(f)->boundary_id() == 1))
+            area += cell->face(f)->measure();
+    return dealii::Utilities::MPI::sum(area, comm);
+  };
+
+  auto reference = build_geometry(geometry_database);
+  BOOST_TEST(n_cache_entries() == 1);
+  auto cached = build_geometry(geometry_database);
+  BOOST_TEST(n_cache_entries() == 1);
+  BOOST_TEST(cached->get_triangulation()->n_global_active_cells() ==
+             reference->get_triangulation()->n_global_active_cells());
+  BOOST_CHECK(*cached->get_materials() == *reference->get_materials());
+  BOOST_CHECK(*cached->get_boundaries() == *reference->get_boundaries());
+  BOOST_TEST(compute_anode_area(*cached) > 0.);
+  BOOST_TEST(compute_anode_area(*cached) == compute_anode_area(*reference),
+             boost::test_tools::tolerance(1e-12));
+
+  geometry_database.put("n_refinements", 1);
+  auto coarse = build_geometry(geometry_database);
+  BOOST_TEST(n_cache_entries() == 2);
+  BOOST_TEST(4 * coarse->get_triangulation()->n_global_active_cells() ==
+             reference->get_triangulation()->n_global_active_cells());
+
+  comm.barrier();
+  if (comm.rank() == 0)
+    boost::filesystem::remove_all(cache_directory);
+}
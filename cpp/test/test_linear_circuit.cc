@@ -0,0 +1,225 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE LinearCircuit
+
+#include "main.cc"
+
+#include <cap/linear_circuit.h>
+#include <cap/resistor_capacitor.h>
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+double const R_SERIES = 55.0e-3;
+double const R_PARALLEL = 2.5e6;
+double const C = 3.0;
+double const TOLERANCE = 1.0e-6; // in percentage units
+
+void add_element(boost::property_tree::ptree &ptree, std::string const &type,
+                 std::string const &nodes, double const value)
+{
+  std::size_t const k = ptree.get<std::size_t>("elements", 0);
+  std::string const element = "element_" + std::to_string(k);
+  ptree.put(element + ".type", type);
+  ptree.put(element + ".nodes", nodes);
+  ptree.put(element + ".value", value);
+  ptree.put("elements", k + 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_rc_circuits)
+{
+  // A netlist describing a SeriesRC or a ParallelRC must behave as the
+  // corresponding device.
+  boost::mpi::communicator world;
+  double const dt = 0.1;
+  std::vector<std::function<void(cap::EnergyStorageDevice &)>> const
+      operating_conditions = {
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_current(dt, 0.1);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_linear_current(dt, 0.3);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_voltage(dt, 2.1);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_linear_voltage(dt, 1.9);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_power(dt, -0.5);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_load(dt, 0.2);
+          }};
+  for (bool const leakage : {false, true})
+  {
+    boost::property_tree::ptree rc_database;
+    rc_database.put("series_resistance", R_SERIES);
+    rc_database.put("capacitance", C);
+    boost::property_tree::ptree circuit_database;
+    add_element(circuit_database, "resistor", "1, 2", R_SERIES);
+    add_element(circuit_database, "capacitor", "2, 0", C);
+    std::unique_ptr<cap::EnergyStorageDevice> rc;
+    if (leakage)
+    {
+      rc_database.put("parallel_resistance", R_PARALLEL);
+      rc.reset(new cap::ParallelRC(rc_database, world));
+      add_element(circuit_database, "resistor", "0, 2", R_PARALLEL);
+    }
+    else
+    {
+      rc.reset(new cap::SeriesRC(rc_database, world));
+    }
+    cap::LinearCircuit circuit(circuit_database, world);
+    BOOST_TEST(circuit.n_states() == 1);
+
+    for (auto const &evolve : operating_conditions)
+      for (int step = 0; step < 3; ++step)
+      {
+        evolve(*rc);
+        evolve(circuit);
+        double rc_voltage;
+        double rc_current;
+        double voltage;
+        double current;
+        rc->get_voltage(rc_voltage);
+        rc->get_current(rc_current);
+        circuit.get_voltage(voltage);
+        circuit.get_current(current);
+        BOOST_CHECK_CLOSE(voltage, rc_voltage, TOLERANCE);
+        BOOST_CHECK_CLOSE(current, rc_current, TOLERANCE);
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_rl_circuit)
+{
+  // The current through a resistor in series with an inductor rises as
+  // V/R (1 - exp(-R t / L)) when a constant voltage is imposed. The current
+  // can not be imposed since it would fix the state of the inductor.
+  boost::property_tree::ptree ptree;
+  add_element(ptree, "resistor", "1, 2", 2.0);
+  add_element(ptree, "inductor", "2, 0", 0.5);
+  ptree.put("type", "LinearCircuit");
+  auto device =
+      cap::EnergyStorageDevice::build(ptree, boost::mpi::communicator());
+  BOOST_CHECK_THROW(device->evolve_one_time_step_constant_current(0.1, 1.0),
+                    std::runtime_error);
+
+  double const voltage = 3.0;
+  double const dt = 0.05;
+  for (int step = 1; step <= 20; ++step)
+  {
+    device->evolve_one_time_step_constant_voltage(dt, voltage);
+    double current;
+    device->get_current(current);
+    BOOST_CHECK_CLOSE(current,
+                      voltage / 2.0 * (1.0 - std::exp(-2.0 * step * dt / 0.5)),
+                      TOLERANCE);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_capacitor_across_terminals)
+{
+  // The voltage can not be imposed on a capacitor directly connected between
+  // the terminals but its initial voltage is seen at the terminals.
+  boost::property_tree::ptree ptree;
+  add_element(ptree, "capacitor", "1, 0", C);
+  add_element(ptree, "resistor", "1, 0", R_PARALLEL);
+  ptree.put("element_0.initial_voltage", 2.0);
+  cap::LinearCircuit circuit(ptree, boost::mpi::communicator());
+  double voltage;
+  circuit.get_voltage(voltage);
+  BOOST_TEST(voltage == 2.0);
+  BOOST_CHECK_THROW(circuit.evolve_one_time_step_constant_voltage(0.1, 1.0),
+                    std::runtime_error);
+  circuit.evolve_one_time_step_constant_current(0.1, 3.0);
+  circuit.get_voltage(voltage);
+  BOOST_CHECK_CLOSE(voltage, 2.1, 1.0e-3);
+
+  // Invalid netlists.
+  ptree.put("element_1.nodes", "1, 1");
+  BOOST_CHECK_THROW(cap::LinearCircuit(ptree, boost::mpi::communicator()),
+                    std::runtime_error);
+  ptree.put("element_1.nodes", "2, 3");
+  BOOST_CHECK_THROW(cap::LinearCircuit(ptree, boost::mpi::communicator()),
+                    std::runtime_error);
+  ptree.put("element_1.type", "diode");
+  BOOST_CHECK_THROW(cap::LinearCircuit(ptree, boost::mpi::communicator()),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_batch)
+{
+  // Circuits built together share the netlist but not the element values.
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree;
+  add_element(ptree, "resistor", "1, 2", R_SERIES);
+  add_element(ptree, "capacitor", "2, 0", C);
+  std::vector<std::vector<double>> const element_values = {
+      {R_SERIES, C}, {2.0 * R_SERIES, C}, {R_SERIES, 0.5 * C}};
+  auto circuits = cap::LinearCircuit::build_batch(ptree, world, element_values);
+  BOOST_TEST(circuits.size() == element_values.size());
+  for (std::size_t i = 0; i < circuits.size(); ++i)
+  {
+    boost::property_tree::ptree rc_database;
+    rc_database.put("series_resistance", element_values[i][0]);
+    rc_database.put("capacitance", element_values[i][1]);
+    cap::SeriesRC rc(rc_database, world);
+    rc.evolve_one_time_step_constant_current(0.1, 1.0);
+    circuits[i]->evolve_one_time_step_constant_current(0.1, 1.0);
+    double voltage;
+    circuits[i]->get_voltage(voltage);
+    BOOST_CHECK_CLOSE(voltage, rc.U, TOLERANCE);
+  }
+
+  // Changing the values keeps the state.
+  std::vector<double> const state = circuits[0]->get_state();
+  circuits[0]->set_element_values({R_SERIES, 2.0 * C});
+  BOOST_TEST(circuits[0]->get_state() == state);
+  BOOST_CHECK_THROW(circuits[0]->set_element_values({R_SERIES}),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(circuits[0]->set_element_values({R_SERIES, -C}),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_save_load)
+{
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree;
+  add_element(ptree, "resistor", "1, 2", R_SERIES);
+  add_element(ptree, "capacitor", "2, 0", C);
+  add_element(ptree, "inductor", "2, 3", 1.0e-3);
+  add_element(ptree, "resistor", "3, 0", 1.0);
+  cap::LinearCircuit circuit(ptree, world);
+  circuit.evolve_one_time_step_constant_current(0.1, 1.0);
+  std::string const filename = "linear_circuit.txt";
+  circuit.save(filename);
+
+  cap::LinearCircuit restored(ptree, world);
+  restored.load(filename);
+  BOOST_TEST(restored.get_state() == circuit.get_state());
+  circuit.evolve_one_time_step_constant_current(0.1, 2.0);
+  restored.evolve_one_time_step_constant_current(0.1, 2.0);
+  double voltage;
+  double restored_voltage;
+  circuit.get_voltage(voltage);
+  restored.get_voltage(restored_voltage);
+  BOOST_TEST(restored_voltage == voltage);
+  std::remove(filename.c_str());
+}
@@ -21,6 +21,7 @@
 #include <deal.II/fe/fe_values.h>
 #include <deal.II/fe/fe_q.h>
 #include <deal.II/base/quadrature_lib.h>
+#include <set>
 
 BOOST_AUTO_TEST_CASE(fe_values)
 {
@@ -82,6 +83,33 @@ BOOST_AUTO_TEST_CASE(function_space, *boost::unit_test::tolerance(1e-15))
   mp_values->get_values(key, fe_values, values);
   for (std::size_t p = 0; p < points.size(); ++p)
     BOOST_TEST(values[p] == 2 * points[p][0]);
+  // a different quadrature rule on the same cell returns the values at its
+  // own points
+  std::vector<dealii::Point<dim>> other_points = {{0.25, 0.0}, {0.75, 1.0}};
+  dealii::FEValues<dim> other_fe_values(fe,
+                                        dealii::Quadrature<dim>(other_points),
+                                        dealii::update_quadrature_points);
+  other_fe_values.reinit(cell);
+  std::vector<double> other_values(other_points.size());
+  mp_values->get_values(key, other_fe_values, other_values);
+  for (std::size_t p = 0; p < other_points.size(); ++p)
+    BOOST_TEST(other_values[p] == 2 * other_points[p][0]);
+  mp_values->get_values(key, fe_values, values);
+  for (std::size_t p = 0; p < points.size(); ++p)
+    BOOST_TEST(values[p] == 2 * points[p][0]);
+  // the values can also be evaluated at the quadrature points of a face
+  dealii::FEFaceValues<dim> fe_face_values(fe, dealii::QGauss<dim - 1>(3),
+                                           dealii::update_quadrature_points);
+  for (unsigned int face = 0; face < dealii::GeometryInfo<dim>::faces_per_cell;
+       ++face)
+  {
+    fe_face_values.reinit(cell, face);
+    std::vector<double> face_values(fe_face_values.n_quadrature_points);
+    mp_values->get_values(key, fe_face_values, face_values);
+    for (unsigned int q = 0; q < face_values.size(); ++q)
+      BOOST_TEST(face_values[q] ==
+                 2 * fe_face_values.quadrature_point(q)[0]);
+  }
   //  BOOST_CHECK_THROW(mp_values->get_values(key, fe_values, values),
   //                    dealii::ExceptionBase);
 
@@ -267,6 +295,45 @@ BOOST_AUTO_TEST_CASE(test_inhomogenous_mp_values)
   database->put("parameter_1.path", "electrode_material.void_volume_fraction");
   BOOST_CHECK_NO_THROW(cap::SuperCapacitorMPValuesFactory<2>::build(params));
 
+  // The perturbed properties only depend on the cell and on the seed, so that
+  // building the MPValues again gives the same values.
+  {
+    dealii::FE_Q<2> fe(1);
+    dealii::DoFHandler<2> dof_handler(*params.geometry->get_triangulation());
+    dof_handler.distribute_dofs(fe);
+    std::vector<std::string> const keys = {"liquid_electrical_conductivity",
+                                           "specific_capacitance"};
+    dealii::QGauss<2> quadrature_rule(1);
+    auto const table = [&]()
+    {
+      return cap::MPValuesTable<2>(
+          *cap::SuperCapacitorMPValuesFactory<2>::build(params), keys,
+          dof_handler, quadrature_rule);
+    };
+    cap::MPValuesTable<2> const first = table();
+    cap::MPValuesTable<2> const second = table();
+    database->put("seed", 1);
+    cap::MPValuesTable<2> const other_seed = table();
+    database->erase("seed");
+    unsigned int const handle = first.get_handle(keys[0]);
+    std::set<double> distinct_values;
+    unsigned int n_different = 0;
+    for (auto cell : dof_handler.active_cell_iterators())
+    {
+      unsigned int const index = cell->active_cell_index();
+      BOOST_TEST(*first.get_values(handle, index) ==
+                 *second.get_values(handle, index));
+      if (*first.get_values(handle, index) !=
+          *other_seed.get_values(handle, index))
+        ++n_different;
+      distinct_values.insert(*first.get_values(handle, index));
+    }
+    BOOST_TEST(n_different > 0);
+    // the cells of the electrodes and of the separator are perturbed
+    // independently
+    BOOST_TEST(distinct_values.size() > 3);
+  }
+
   // Check that an exception is thrown the parameter path does not already exist
   // in the database. It most likely means that it is typo and we want to catch
   // that.
@@ -479,3 +546,121 @@ BOOST_AUTO_TEST_CASE(test_mp_values)
   mp_values->get_values("solid_electrical_conductivity", fe_values, values);
   BOOST_TEST(std::abs(values[0]) == 0.);
 }
+
+BOOST_AUTO_TEST_CASE(test_mp_values_table)
+{
+  boost::mpi::communicator world;
+
+  boost::property_tree::ptree ptree;
+  boost::property_tree::read_info("super_capacitor.info", ptree);
+  auto database = std::make_shared<boost::property_tree::ptree>(
+      ptree.get_child("material_properties"));
+  database->put("electrode_material.custom_liquid_electrical_conductivity."
+                "expression",
+                "1.0+x");
+
+  int constexpr dim = 2;
+  cap::MPValuesParameters<dim> params(database);
+  params.geometry = std::make_shared<cap::Geometry<dim>>(
+      std::make_shared<boost::property_tree::ptree>(
+          ptree.get_child("geometry")),
+      world);
+  std::shared_ptr<cap::MPValues<dim>> mp_values =
+      cap::SuperCapacitorMPValuesFactory<dim>::build(params);
+
+  dealii::FE_Q<dim> fe(1);
+  dealii::DoFHandler<dim> dof_handler(*params.geometry->get_triangulation());
+  dof_handler.distribute_dofs(fe);
+  dealii::QGauss<dim> quadrature_rule(2);
+  std::vector<std::string> const keys = {"liquid_electrical_conductivity",
+                                         "density"};
+  cap::MPValuesTable<dim> table(*mp_values, keys, dof_handler,
+                                quadrature_rule);
+  BOOST_TEST(table.n_quadrature_points() == quadrature_rule.size());
+  BOOST_CHECK_THROW(table.get_handle("specific_capacitance"),
+                    std::runtime_error);
+
+  // the table must hold the same values as MPValues::get_values()
+  dealii::FEValues<dim> fe_values(fe, quadrature_rule,
+                                  dealii::update_quadrature_points);
+  std::vector<double> values(quadrature_rule.size());
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (cell->is_locally_owned())
+    {
+      fe_values.reinit(cell);
+      for (auto const &key : keys)
+      {
+        mp_values->get_values(key, fe_values, values);
+        double const *table_values =
+            table.get_values(table.get_handle(key), cell->active_cell_index());
+        for (unsigned int q = 0; q < values.size(); ++q)
+          BOOST_TEST(table_values[q] == values[q]);
+      }
+    }
+}
+
+// Count the quadrature points at which the wrapped property is evaluated.
+template <int dim>
+class CountingMPValues : public cap::MPValues<dim>
+{
+public:
+  CountingMPValues(std::shared_ptr<cap::MPValues<dim>> mp_values)
+      : _mp_values(mp_values)
+  {
+  }
+
+  void get_values(std::string const &key,
+                  dealii::FEValuesBase<dim> const &fe_values,
+                  std::vector<double> &values) const override
+  {
+    _n_evaluations += fe_values.n_quadrature_points;
+    _mp_values->get_values(key, fe_values, values);
+  }
+
+  unsigned int get_n_evaluations() const { return _n_evaluations; }
+
+private:
+  std::shared_ptr<cap::MPValues<dim>> _mp_values;
+  mutable unsigned int _n_evaluations = 0;
+};
+
+BOOST_AUTO_TEST_CASE(test_mp_values_table_evaluates_once,
+                     *boost::unit_test::tolerance(1e-15))
+{
+  int constexpr dim = 2;
+  dealii::Triangulation<dim> triangulation;
+  dealii::GridGenerator::hyper_cube(triangulation);
+  triangulation.refine_global(2);
+  dealii::FE_Q<dim> fe(1);
+  dealii::DoFHandler<dim> dof_handler(triangulation);
+  dof_handler.distribute_dofs(fe);
+
+  boost::property_tree::ptree ptree;
+  ptree.put("expression", "2*x");
+  CountingMPValues<dim> mp_values(
+      std::make_shared<cap::FunctionSpaceMPValues<dim>>(ptree));
+  dealii::QGauss<dim> quadrature_rule(2);
+  std::string const key = "key does not matter";
+  cap::MPValuesTable<dim> table(mp_values, {key}, dof_handler,
+                                quadrature_rule);
+  // the parser is evaluated once at each quadrature point of the mesh
+  unsigned int const n_evaluations =
+      triangulation.n_active_cells() * quadrature_rule.size();
+  BOOST_TEST(mp_values.get_n_evaluations() == n_evaluations);
+
+  // reading the table again, e.g. at every time step, does not evaluate the
+  // parser
+  dealii::FEValues<dim> fe_values(fe, quadrature_rule,
+                                  dealii::update_quadrature_points);
+  unsigned int const handle = table.get_handle(key);
+  for (unsigned int step = 0; step < 3; ++step)
+    for (auto cell : dof_handler.active_cell_iterators())
+    {
+      fe_values.reinit(cell);
+      double const *values =
+          table.get_values(handle, cell->active_cell_index());
+      for (unsigned int q = 0; q < quadrature_rule.size(); ++q)
+        BOOST_TEST(values[q] == 2 * fe_values.quadrature_point(q)[0]);
+    }
+  BOOST_TEST(mp_values.get_n_evaluations() == n_evaluations);
+}
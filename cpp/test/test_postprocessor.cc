@@ -18,6 +18,8 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/info_parser.hpp>
 #include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -152,3 +154,146 @@ BOOST_AUTO_TEST_CASE(test_throw)
     BOOST_CHECK_NO_THROW(cap::EnergyStorageDevice::build(ptree, world));
   }
 }
+
+// Check that the quantities computed on request are updated after each time
+// step
+BOOST_AUTO_TEST_CASE(test_lazy_evaluation)
+{
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  ptree.put("debug.solution_fields", "joule_heating");
+  boost::mpi::communicator world;
+  std::shared_ptr<cap::EnergyStorageDevice> device =
+      cap::EnergyStorageDevice::build(ptree, world);
+  auto supercapacitor = dynamic_cast<cap::SuperCapacitor<2> *>(device.get());
+  BOOST_TEST_REQUIRE(supercapacitor != nullptr);
+  std::shared_ptr<cap::Postprocessor<2>> post_processor =
+      supercapacitor->get_post_processor();
+
+  double const time_step = 0.1;
+  double volume = 0.0;
+  post_processor->get("volume", volume);
+  double joule_heating = 0.0;
+  device->evolve_one_time_step_constant_current(time_step, 0.1);
+  post_processor->get("joule_heating", joule_heating);
+  BOOST_TEST(joule_heating > 0.0);
+  double const joule_heating_field =
+      post_processor->get("joule_heating").l1_norm();
+  BOOST_TEST(joule_heating_field > 0.0);
+  // Only the locally owned cells are stored
+  BOOST_TEST(post_processor->get("joule_heating").size() ==
+             supercapacitor->get_geometry()
+                 ->get_triangulation()
+                 ->n_locally_owned_active_cells());
+
+  // The Joule heating depends on the current
+  device->evolve_one_time_step_constant_current(time_step, 0.2);
+  double new_joule_heating = 0.0;
+  post_processor->get("joule_heating", new_joule_heating);
+  BOOST_TEST(new_joule_heating > joule_heating);
+  BOOST_TEST(post_processor->get("joule_heating").l1_norm() >
+             joule_heating_field);
+
+  // The static quantities do not change
+  double new_volume = 0.0;
+  post_processor->get("volume", new_volume);
+  BOOST_TEST(new_volume == volume);
+}
+
+// Check that the current computed from the reaction at the cathode is the
+// current imposed by the boundary condition, with and without non-blocking
+// reduction
+BOOST_AUTO_TEST_CASE(test_current)
+{
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::mpi::communicator world;
+
+  double const time_step = 0.1;
+  double const percent_tolerance = 1e-6;
+  for (bool const non_blocking_reduction : {false, true})
+  {
+    ptree.put("post_processor.non_blocking_reduction", non_blocking_reduction);
+    std::shared_ptr<cap::EnergyStorageDevice> device =
+        cap::EnergyStorageDevice::build(ptree, world);
+    for (double const imposed_current : {0.1, -0.3, 0.2})
+    {
+      device->evolve_one_time_step_constant_current(time_step,
+                                                    imposed_current);
+      double current = 0.0;
+      device->get_current(current);
+      BOOST_CHECK_CLOSE(current, imposed_current, percent_tolerance);
+    }
+    // Evolve twice without asking for the current in between
+    device->evolve_one_time_step_constant_current(time_step, 0.4);
+    device->evolve_one_time_step_constant_current(time_step, 0.5);
+    double current = 0.0;
+    device->get_current(current);
+    BOOST_CHECK_CLOSE(current, 0.5, percent_tolerance);
+  }
+}
+
+// Check the values of the solution sampled at the probes
+BOOST_AUTO_TEST_CASE(test_probes)
+{
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::mpi::communicator world;
+
+  // Use the bounding box of the mesh to place a line through the sandwich
+  std::vector<double> lower(2, std::numeric_limits<double>::max());
+  std::vector<double> upper(2, std::numeric_limits<double>::lowest());
+  {
+    std::shared_ptr<cap::EnergyStorageDevice> device =
+        cap::EnergyStorageDevice::build(ptree, world);
+    auto supercapacitor = dynamic_cast<cap::SuperCapacitor<2> *>(device.get());
+    BOOST_TEST_REQUIRE(supercapacitor != nullptr);
+    for (auto const &vertex :
+         supercapacitor->get_geometry()->get_triangulation()->get_vertices())
+      for (unsigned int d = 0; d < 2; ++d)
+      {
+        lower[d] = std::min(lower[d], vertex[d]);
+        upper[d] = std::max(upper[d], vertex[d]);
+      }
+  }
+  double const epsilon = 1e-3 * (upper[0] - lower[0]);
+  double const y = 0.5 * (lower[1] + upper[1]);
+  std::string const start =
+      (boost::format("%.17g,%.17g") % (lower[0] + epsilon) % y).str();
+  std::string const end =
+      (boost::format("%.17g,%.17g") % (upper[0] - epsilon) % y).str();
+  unsigned int const n_points = 11;
+  ptree.put("probes.points", 1);
+  ptree.put("probes.point_0", start);
+  ptree.put("probes.lines", 1);
+  ptree.put("probes.line_0.start", start);
+  ptree.put("probes.line_0.end", end);
+  ptree.put("probes.line_0.n_points", n_points);
+
+  std::shared_ptr<cap::EnergyStorageDevice> device =
+      cap::EnergyStorageDevice::build(ptree, world);
+  device->evolve_one_time_step_constant_current(0.1, 0.1);
+  cap::ProbeInspector<2> inspector;
+  device->inspect(&inspector);
+  auto const &data = inspector.get_data();
+  std::vector<double> const &solid_potential = data.at("solid_potential");
+  std::vector<double> const &liquid_potential = data.at("liquid_potential");
+  std::vector<double> const &overpotential = data.at("overpotential");
+  BOOST_TEST(solid_potential.size() == n_points + 1);
+  BOOST_TEST(data.at("position_0").size() == n_points + 1);
+  for (unsigned int p = 0; p < n_points + 1; ++p)
+    BOOST_TEST(overpotential[p] == solid_potential[p] - liquid_potential[p],
+               boost::test_tools::tolerance(1e-12));
+  // The point and the first point of the line are at the same position
+  BOOST_TEST(solid_potential[0] == solid_potential[1],
+             boost::test_tools::tolerance(1e-12));
+  // The anode is grounded and the device is charging
+  BOOST_TEST(solid_potential[n_points] > solid_potential[1]);
+
+  // A probe outside of the mesh is invalid
+  ptree.put("probes.point_0",
+            (boost::format("%.17g,%.17g") % (2. * upper[0] - lower[0]) % y)
+                .str());
+  BOOST_CHECK_THROW(cap::EnergyStorageDevice::build(ptree, world),
+                    std::runtime_error);
+}
@@ -0,0 +1,259 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE RCBank
+
+#include "main.cc"
+
+#include <cap/rc_bank.h>
+#include <cap/resistor_capacitor.h>
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+double const R_SERIES = 55.0e-3;
+double const R_PARALLEL = 2.5e6;
+double const C = 3.0;
+double const TOLERANCE = 1.0e-8; // in percentage units
+
+// Each operating condition is applied for a few time steps.
+std::vector<std::function<void(cap::EnergyStorageDevice &)>>
+operating_conditions()
+{
+  double const dt = 0.1;
+  return {[dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_current(dt, 0.1);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_linear_current(dt, 0.3);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_voltage(dt, 2.1);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_linear_voltage(dt, 1.9);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_power(dt, -0.5);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_load(dt, 0.2);
+          }};
+}
+
+BOOST_AUTO_TEST_CASE(test_homogeneous_bank)
+{
+  // A bank of identical cells must behave exactly as a single cell.
+  boost::mpi::communicator world;
+  for (bool const leakage : {false, true})
+  {
+    boost::property_tree::ptree ptree;
+    ptree.put("series_resistance", R_SERIES);
+    ptree.put("capacitance", C);
+    ptree.put("initial_voltage", 1.0);
+    if (leakage)
+      ptree.put("parallel_resistance", R_PARALLEL);
+    std::unique_ptr<cap::EnergyStorageDevice> cell;
+    if (leakage)
+      cell.reset(new cap::ParallelRC(ptree, world));
+    else
+      cell.reset(new cap::SeriesRC(ptree, world));
+    ptree.put("type", "RCBank");
+    ptree.put("n_cells", 17);
+    ptree.put("distributed", true);
+    auto bank = cap::EnergyStorageDevice::build(ptree, world);
+
+    for (auto const &evolve : operating_conditions())
+      for (int step = 0; step < 5; ++step)
+      {
+        evolve(*cell);
+        evolve(*bank);
+        double cell_value, bank_value;
+        cell->get_voltage(cell_value);
+        bank->get_voltage(bank_value);
+        BOOST_CHECK_CLOSE(cell_value, bank_value, TOLERANCE);
+        cell->get_current(cell_value);
+        bank->get_current(bank_value);
+        BOOST_CHECK_CLOSE(cell_value, bank_value, TOLERANCE);
+      }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_power_overload)
+{
+  // A power that the cells cannot deliver must throw and leave the bank in
+  // the state it was before the time step.
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree;
+  ptree.put("type", "RCBank");
+  ptree.put("n_cells", 17);
+  ptree.put("distributed", true);
+  ptree.put("series_resistance", R_SERIES);
+  ptree.put("capacitance", C);
+  ptree.put("initial_voltage", 1.0);
+  auto bank = cap::EnergyStorageDevice::build(ptree, world);
+  auto reference = cap::EnergyStorageDevice::build(ptree, world);
+  double const dt = 0.1;
+  bank->evolve_one_time_step_constant_current(dt, 0.1);
+  reference->evolve_one_time_step_constant_current(dt, 0.1);
+  double voltage, current;
+  bank->get_voltage(voltage);
+  bank->get_current(current);
+
+  BOOST_CHECK_THROW(bank->evolve_one_time_step_constant_power(dt, -1.0e3),
+                    std::runtime_error);
+  double value;
+  bank->get_voltage(value);
+  BOOST_TEST(value == voltage);
+  bank->get_current(value);
+  BOOST_TEST(value == current);
+
+  // The next time step starts from the unchanged state.
+  bank->evolve_one_time_step_constant_current(dt, 0.1);
+  reference->evolve_one_time_step_constant_current(dt, 0.1);
+  bank->get_voltage(value);
+  reference->get_voltage(voltage);
+  BOOST_TEST(value == voltage);
+}
+
+BOOST_AUTO_TEST_CASE(test_heterogeneous_bank)
+{
+  // Each cell of the bank must behave as the corresponding ParallelRC.
+  boost::mpi::communicator world;
+  std::vector<double> const capacitance = {1.0, 2.0, 3.0, 4.0, 5.0};
+  boost::property_tree::ptree ptree;
+  ptree.put("type", "RCBank");
+  ptree.put("n_cells", capacitance.size());
+  ptree.put("distributed", true);
+  ptree.put("series_resistance", R_SERIES);
+  ptree.put("parallel_resistance", R_PARALLEL);
+  ptree.put("capacitance", "1.0, 2.0, 3.0, 4.0, 5.0");
+  cap::RCBank bank(ptree, world);
+  BOOST_TEST(bank.n_cells() == capacitance.size());
+
+  std::vector<std::unique_ptr<cap::EnergyStorageDevice>> cells;
+  for (double const c : capacitance)
+  {
+    boost::property_tree::ptree cell_ptree;
+    cell_ptree.put("series_resistance", R_SERIES);
+    cell_ptree.put("parallel_resistance", R_PARALLEL);
+    cell_ptree.put("capacitance", c);
+    cells.emplace_back(new cap::ParallelRC(cell_ptree, world));
+  }
+
+  for (auto const &evolve : operating_conditions())
+  {
+    evolve(bank);
+    std::vector<double> voltage;
+    std::vector<double> current;
+    bank.gather_voltage(voltage);
+    bank.gather_current(current);
+    BOOST_TEST(voltage.size() == capacitance.size());
+    BOOST_TEST(current.size() == capacitance.size());
+    for (std::size_t i = 0; i < cells.size(); ++i)
+    {
+      evolve(*cells[i]);
+      double value;
+      // ParallelRC suffers from cancellation when the leakage is small so the
+      // tolerance is looser.
+      cells[i]->get_voltage(value);
+      BOOST_CHECK_CLOSE(voltage[i], value, 1e3 * TOLERANCE);
+      cells[i]->get_current(value);
+      BOOST_CHECK_CLOSE(current[i], value, 1e3 * TOLERANCE);
+    }
+  }
+
+  // the number of values must match the number of cells
+  ptree.put("capacitance", "1.0, 2.0");
+  BOOST_CHECK_THROW(cap::RCBank(ptree, world), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_distribution)
+{
+  // The parameters drawn from a distribution do not depend on the number of
+  // processors.
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree;
+  ptree.put("n_cells", 100);
+  ptree.put("seed", 42);
+  ptree.put("series_resistance", R_SERIES);
+  ptree.put("capacitance.distribution_type", "normal");
+  ptree.put("capacitance.mean", C);
+  ptree.put("capacitance.standard_deviation", 0.1);
+  ptree.put("initial_voltage.distribution_type", "uniform");
+  ptree.put("initial_voltage.range", "1.0, 2.0");
+  cap::RCBank serial_bank(ptree, world);
+  ptree.put("distributed", true);
+  cap::RCBank distributed_bank(ptree, world);
+  if (world.size() > 1)
+    BOOST_TEST(distributed_bank.n_local_cells() < distributed_bank.n_cells());
+
+  std::vector<double> serial_voltage;
+  std::vector<double> distributed_voltage;
+  serial_bank.gather_voltage(serial_voltage);
+  distributed_bank.gather_voltage(distributed_voltage);
+  BOOST_TEST(serial_voltage == distributed_voltage,
+             boost::test_tools::per_element());
+  for (double const voltage : serial_voltage)
+    BOOST_TEST((voltage >= 1.0 && voltage <= 2.0));
+
+  serial_bank.evolve_one_time_step_constant_current(1.0, 0.1);
+  distributed_bank.evolve_one_time_step_constant_current(1.0, 0.1);
+  serial_bank.gather_voltage(serial_voltage);
+  distributed_bank.gather_voltage(distributed_voltage);
+  BOOST_TEST(serial_voltage.size() == distributed_voltage.size());
+  for (std::size_t i = 0; i < serial_voltage.size(); ++i)
+    BOOST_CHECK_CLOSE(serial_voltage[i], distributed_voltage[i], TOLERANCE);
+
+  ptree.put("capacitance.distribution_type", "invalid");
+  BOOST_CHECK_THROW(cap::RCBank(ptree, world), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_save_load)
+{
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree;
+  ptree.put("n_cells", 10);
+  ptree.put("distributed", true);
+  ptree.put("series_resistance", R_SERIES);
+  ptree.put("parallel_resistance", R_PARALLEL);
+  ptree.put("capacitance.distribution_type", "uniform");
+  ptree.put("capacitance.range", "2.0, 4.0");
+  cap::RCBank original_bank(ptree, world);
+  original_bank.evolve_one_time_step_constant_voltage(0.1, 2.1);
+  original_bank.save("rc_bank.txt");
+  world.barrier();
+
+  ptree.erase("capacitance");
+  ptree.put("capacitance", 1.0);
+  cap::RCBank restored_bank(ptree, world);
+  restored_bank.load("rc_bank.txt");
+  double original_value, restored_value;
+  original_bank.get_voltage(original_value);
+  restored_bank.get_voltage(restored_value);
+  BOOST_TEST(original_value == restored_value);
+  original_bank.evolve_one_time_step_constant_current(0.1, 0.1);
+  restored_bank.evolve_one_time_step_constant_current(0.1, 0.1);
+  original_bank.get_voltage(original_value);
+  restored_bank.get_voltage(restored_value);
+  BOOST_TEST(original_value == restored_value);
+
+  world.barrier();
+  if (world.rank() == 0)
+    std::remove("rc_bank.txt");
+  world.barrier();
+  // All the processors throw when the file cannot be read.
+  BOOST_CHECK_THROW(restored_bank.load("rc_bank.txt"), std::runtime_error);
+}
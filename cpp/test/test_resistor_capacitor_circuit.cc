@@ -17,6 +17,7 @@
 #include <string>
 #include <tuple>
 #include <cmath>
+#include <functional>
 #include <iostream>
 
 // This file contains the following tests:
@@ -28,6 +29,9 @@
 //  - Parallel RC constant voltage
 //  - Parallel RC constant power
 //  - Parallel RC constant load
+//  - Closed-form constant power
+//  - Propagator cache with varying time steps
+//  - Evolution over long intervals
 
 double const R_SERIES = 55.0e-3;
 double const R_PARALLEL = 2.5e6;
@@ -339,3 +343,200 @@ BOOST_AUTO_TEST_CASE(test_parallel_rc_constant_load)
     rc.evolve_one_time_step_constant_load(DELTA_T, R_LOAD);
   }
 }
+
+template <typename RC>
+void check_closed_form_constant_power()
+{
+  double const TAU = R_SERIES * C;
+  double const DELTA_T = 0.1 * TAU;
+
+  RC rc_newton(initialize_database(), boost::mpi::communicator());
+  RC rc_closed_form(initialize_database(), boost::mpi::communicator());
+
+  for (double const power : {P, -P})
+  {
+    set_voltage(rc_newton, U);
+    set_voltage(rc_closed_form, U);
+    for (int step = 0; step < 50; ++step)
+    {
+      rc_newton.evolve_one_time_step_constant_power(DELTA_T, power,
+                                                    cap::PowerSolver::NEWTON);
+      BOOST_TEST(rc_closed_form.evolve_one_time_step_constant_power(
+                     DELTA_T, power, cap::PowerSolver::CLOSED_FORM) == 0);
+      BOOST_CHECK_CLOSE(rc_newton.U, rc_closed_form.U, TOLERANCE);
+      BOOST_CHECK_CLOSE(rc_newton.I, rc_closed_form.I, TOLERANCE);
+      BOOST_CHECK_CLOSE(rc_newton.U_C, rc_closed_form.U_C, TOLERANCE);
+    }
+  }
+
+  // Zero power on a discharged device is a rest
+  set_voltage(rc_closed_form, 0.0);
+  for (std::string const method : {"CLOSED_FORM", "NEWTON", "FIXED_POINT"})
+  {
+    rc_closed_form.evolve_one_time_step_constant_power(DELTA_T, 0.0, method);
+    BOOST_TEST(rc_closed_form.U == 0.0);
+    BOOST_TEST(rc_closed_form.I == 0.0);
+  }
+
+  // A discharged device cannot deliver power
+  BOOST_CHECK_THROW(rc_closed_form.evolve_one_time_step_constant_power(
+                        DELTA_T, -P, cap::PowerSolver::CLOSED_FORM),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_closed_form_constant_power)
+{
+  check_closed_form_constant_power<cap::SeriesRC>();
+  check_closed_form_constant_power<cap::ParallelRC>();
+
+  // The solver used by the EnergyStorageDevice interface is read from the
+  // database
+  boost::property_tree::ptree database = initialize_database();
+  database.put("power_solver", "FIXED_POINT");
+  cap::SeriesRC rc_fixed_point(database, boost::mpi::communicator());
+  database.put("power_solver", "CLOSED_FORM");
+  cap::SeriesRC rc_closed_form(database, boost::mpi::communicator());
+  set_voltage(rc_fixed_point, U);
+  set_voltage(rc_closed_form, U);
+  rc_fixed_point.evolve_one_time_step_constant_power(1.0e-3, P);
+  rc_closed_form.evolve_one_time_step_constant_power(1.0e-3, P);
+  BOOST_CHECK_CLOSE(rc_fixed_point.U, rc_closed_form.U, TOLERANCE);
+
+  database.put("power_solver", "INVALID_ROOT_FINDING_METHOD");
+  BOOST_CHECK_THROW(cap::SeriesRC(database, boost::mpi::communicator()),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_propagator_cache)
+{
+  // Cycle through more time steps than the cache can hold so that the
+  // propagators are evicted and computed again.
+  double const TAU = R_PARALLEL * C;
+  std::vector<double> const time_steps = {0.01 * TAU, 0.02 * TAU, 0.03 * TAU,
+                                          0.05 * TAU, 0.07 * TAU, 0.11 * TAU};
+
+  cap::ParallelRC rc(initialize_database(), boost::mpi::communicator());
+  rc.R_series = 0.0;
+
+  // CHARGE
+  set_voltage(rc, 0.0);
+  set_current(rc, I);
+  double t = 0.0;
+  for (int cycle = 0; cycle < 3; ++cycle)
+    for (double const delta_t : time_steps)
+    {
+      rc.evolve_one_time_step_constant_current(delta_t, I);
+      t += delta_t;
+      BOOST_CHECK_CLOSE(
+          rc.U_C, R_PARALLEL * I * (1.0 - std::exp(-t / (R_PARALLEL * C))),
+          TOLERANCE);
+    }
+
+  // The propagators depend on the parameters of the circuit
+  cap::SeriesRC series_rc(initialize_database(), boost::mpi::communicator());
+  set_voltage(series_rc, 0.0);
+  series_rc.evolve_one_time_step_constant_current(time_steps[0], I);
+  series_rc.C = 2.0 * C;
+  series_rc.evolve_one_time_step_constant_current(time_steps[0], I);
+  BOOST_CHECK_CLOSE(series_rc.U_C, 1.5 * I * time_steps[0] / C, TOLERANCE);
+}
+
+BOOST_AUTO_TEST_CASE(test_series_rc_evolve_over_interval)
+{
+  double const TAU = R_SERIES * C;
+  double const DURATION = 86400.0;
+  double const R_LOAD = 5.0 * R_SERIES;
+
+  cap::SeriesRC rc(initialize_database(), boost::mpi::communicator());
+  BOOST_TEST(rc.has_closed_form_response());
+  double charge, energy;
+
+  // CHARGE
+  set_voltage(rc, 0.0);
+  rc.evolve_over_interval_constant_current(5.0 * TAU, I, charge, energy);
+  BOOST_CHECK_CLOSE(rc.U_C, I * 5.0 * TAU / C, TOLERANCE);
+  BOOST_CHECK_CLOSE(charge, I * 5.0 * TAU, TOLERANCE);
+  BOOST_CHECK_CLOSE(energy, 0.5 * C * rc.U_C * rc.U_C +
+                                R_SERIES * I * I * 5.0 * TAU,
+                    TOLERANCE);
+
+  // VOLTAGE HOLD
+  set_voltage(rc, 0.0);
+  rc.evolve_over_interval_constant_voltage(DURATION, U, charge, energy);
+  BOOST_CHECK_CLOSE(rc.U_C, U, TOLERANCE);
+  BOOST_CHECK_CLOSE(charge, C * U, TOLERANCE);
+  BOOST_CHECK_CLOSE(energy, C * U * U, TOLERANCE);
+
+  // SELF-DISCHARGE IN A LOAD
+  set_voltage(rc, U);
+  rc.evolve_over_interval_constant_load(5.0 * TAU, R_LOAD, charge, energy);
+  double const decay = std::exp(-5.0 * TAU / ((R_SERIES + R_LOAD) * C));
+  BOOST_CHECK_CLOSE(rc.U_C, U * decay, TOLERANCE);
+  BOOST_CHECK_CLOSE(charge, -C * U * (1.0 - decay), TOLERANCE);
+  BOOST_CHECK_CLOSE(energy, -R_LOAD / (R_SERIES + R_LOAD) * 0.5 * C * U * U *
+                                (1.0 - decay * decay),
+                    TOLERANCE);
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_rc_evolve_over_interval)
+{
+  // A single call over the whole interval must match many calls over
+  // subintervals. The charge and the energy are additive.
+  double const DURATION = 0.5 * R_PARALLEL * C;
+  int const N_SUBINTERVALS = 1000;
+  double const R_LOAD = 5.0e6;
+
+  std::vector<std::function<void(cap::ParallelRC &, double, double &,
+                                 double &)>> const evolve_over_interval = {
+      [](cap::ParallelRC &rc, double duration, double &q, double &e)
+      {
+        rc.evolve_over_interval_constant_current(duration, I, q, e);
+      },
+      [](cap::ParallelRC &rc, double duration, double &q, double &e)
+      {
+        rc.evolve_over_interval_constant_voltage(duration, U, q, e);
+      },
+      [R_LOAD](cap::ParallelRC &rc, double duration, double &q, double &e)
+      {
+        rc.evolve_over_interval_constant_load(duration, R_LOAD, q, e);
+      }};
+
+  for (auto const &evolve : evolve_over_interval)
+  {
+    cap::ParallelRC rc_jump(initialize_database(), boost::mpi::communicator());
+    cap::ParallelRC rc_steps(initialize_database(),
+                             boost::mpi::communicator());
+    set_voltage(rc_jump, 1.0);
+    set_voltage(rc_steps, 1.0);
+
+    double charge, energy;
+    evolve(rc_jump, DURATION, charge, energy);
+    double steps_charge = 0.0;
+    double steps_energy = 0.0;
+    for (int i = 0; i < N_SUBINTERVALS; ++i)
+    {
+      double q, e;
+      evolve(rc_steps, DURATION / N_SUBINTERVALS, q, e);
+      steps_charge += q;
+      steps_energy += e;
+    }
+    BOOST_CHECK_CLOSE(rc_jump.U, rc_steps.U, 1.0e-6);
+    BOOST_CHECK_CLOSE(rc_jump.I, rc_steps.I, 1.0e-6);
+    BOOST_CHECK_CLOSE(charge, steps_charge, 1.0e-6);
+    BOOST_CHECK_CLOSE(energy, steps_energy, 1.0e-6);
+  }
+
+  // At constant voltage, the capacitor reaches its steady state quickly and
+  // the leakage current is then constant. The leakage current is smaller
+  // during the transient, which delays the leakage by the time constant.
+  cap::ParallelRC rc(initialize_database(), boost::mpi::communicator());
+  set_voltage(rc, 0.0);
+  double charge, energy;
+  rc.evolve_over_interval_constant_voltage(DURATION, U, charge, energy);
+  double const U_C = U * R_PARALLEL / (R_SERIES + R_PARALLEL);
+  double const TAU = R_SERIES * R_PARALLEL / (R_SERIES + R_PARALLEL) * C;
+  BOOST_CHECK_CLOSE(rc.U_C, U_C, TOLERANCE);
+  BOOST_CHECK_CLOSE(charge, C * U_C + U_C / R_PARALLEL * (DURATION - TAU),
+                    TOLERANCE);
+  BOOST_CHECK_CLOSE(energy, U * charge, TOLERANCE);
+}
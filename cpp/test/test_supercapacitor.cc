@@ -10,12 +10,20 @@
 #include "main.cc"
 
 #include <cap/energy_storage_device.h>
+#include <cap/supercapacitor.h>
 #include <boost/test/unit_test.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/info_parser.hpp>
 #include <boost/format.hpp>
+#include <boost/mpi/collectives.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
 #include <memory>
 #include <iostream>
+#include <utility>
+#include <vector>
 #include <fstream>
 
 namespace cap
@@ -82,3 +90,301 @@ BOOST_AUTO_TEST_CASE(test_supercapacitor,
   // check sanity
   cap::check_sanity(supercap);
 }
+
+BOOST_AUTO_TEST_CASE(test_inactive_dofs)
+{
+  // The solid potential in the separator and the liquid potential in the
+  // collectors are constrained to zero. This must not change the solution.
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::mpi::communicator world;
+  std::shared_ptr<cap::EnergyStorageDevice> supercap =
+      cap::EnergyStorageDevice::build(ptree, world);
+  ptree.put("constrain_inactive_dofs", false);
+  std::shared_ptr<cap::EnergyStorageDevice> reference =
+      cap::EnergyStorageDevice::build(ptree, world);
+
+  double const tolerance = 1e-6;
+  double reference_value;
+  double value;
+  for (auto imposed_current : {10e-3, 5e-3, 2e-3})
+  {
+    reference->evolve_one_time_step_constant_current(2.0, imposed_current);
+    supercap->evolve_one_time_step_constant_current(2.0, imposed_current);
+    reference->get_voltage(reference_value);
+    supercap->get_voltage(value);
+    BOOST_TEST(value == reference_value,
+               boost::test_tools::tolerance(tolerance));
+  }
+  for (auto imposed_voltage : {1.4, 2.2})
+  {
+    reference->evolve_one_time_step_constant_voltage(2.0, imposed_voltage);
+    supercap->evolve_one_time_step_constant_voltage(2.0, imposed_voltage);
+    reference->get_current(reference_value);
+    supercap->get_current(value);
+    BOOST_TEST(value == reference_value,
+               boost::test_tools::tolerance(tolerance));
+  }
+
+  // Count the degrees of freedom of the solid potential that are only
+  // supported on separator cells and the ones of the liquid potential that
+  // are only supported on collector cells.
+  std::shared_ptr<cap::SuperCapacitor<2>> supercapacitor =
+      std::static_pointer_cast<cap::SuperCapacitor<2>>(supercap);
+  dealii::DoFHandler<2> const &dof_handler =
+      *(supercapacitor->get_post_processor_parameters()->dof_handler);
+  auto const &materials = *(supercapacitor->get_geometry()->get_materials());
+  auto const &separator_ids = materials.at("separator");
+  auto const &collector_ids = materials.at("collector");
+  unsigned int const solid_component =
+      ptree.get<unsigned int>("solid_potential_component");
+  unsigned int const liquid_component =
+      ptree.get<unsigned int>("liquid_potential_component");
+  dealii::FiniteElement<2> const &fe = dof_handler.get_fe();
+  std::vector<dealii::types::global_dof_index> local_dof_indices(
+      fe.dofs_per_cell);
+  std::map<dealii::types::global_dof_index, bool> active;
+  for (auto cell : dof_handler.active_cell_iterators())
+    if (!cell->is_artificial())
+    {
+      cell->get_dof_indices(local_dof_indices);
+      for (unsigned int i = 0; i < fe.dofs_per_cell; ++i)
+      {
+        unsigned int const component = fe.system_to_component_index(i).first;
+        bool const inactive =
+            ((component == solid_component) &&
+             (separator_ids.count(cell->material_id()) > 0)) ||
+            ((component == liquid_component) &&
+             (collector_ids.count(cell->material_id()) > 0));
+        active[local_dof_indices[i]] =
+            active[local_dof_indices[i]] || !inactive;
+      }
+    }
+  unsigned int n_inactive_dofs = 0;
+  for (auto const &dof : active)
+    if (!dof.second && dof_handler.locally_owned_dofs().is_element(dof.first))
+      ++n_inactive_dofs;
+  n_inactive_dofs =
+      boost::mpi::all_reduce(world, n_inactive_dofs, std::plus<unsigned int>());
+  BOOST_TEST(n_inactive_dofs > 0u);
+  BOOST_TEST(
+      supercapacitor->get_electrochemical_physics()->get_n_inactive_dofs() ==
+      n_inactive_dofs);
+  BOOST_TEST(std::static_pointer_cast<cap::SuperCapacitor<2>>(reference)
+                 ->get_electrochemical_physics()
+                 ->get_n_inactive_dofs() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_equipotential_collectors)
+{
+  // The potential drop in the aluminium collectors is negligible so the
+  // device with equipotential collectors must give the same voltage and
+  // current as the device where the collectors are resolved.
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::mpi::communicator world;
+  std::shared_ptr<cap::EnergyStorageDevice> reference =
+      cap::EnergyStorageDevice::build(ptree, world);
+  ptree.put("equipotential_collectors", true);
+  std::shared_ptr<cap::EnergyStorageDevice> supercap =
+      cap::EnergyStorageDevice::build(ptree, world);
+
+  double const fidelity_tolerance = 1e-3;
+  double reference_voltage;
+  double voltage;
+  for (auto imposed_current : {10e-3, 5e-3, 2e-3})
+  {
+    reference->evolve_one_time_step_constant_current(2.0, imposed_current);
+    supercap->evolve_one_time_step_constant_current(2.0, imposed_current);
+    reference->get_voltage(reference_voltage);
+    supercap->get_voltage(voltage);
+    BOOST_TEST(voltage == reference_voltage,
+               boost::test_tools::tolerance(fidelity_tolerance));
+  }
+  double reference_current;
+  double current;
+  for (auto imposed_voltage : {1.4, 2.2})
+  {
+    reference->evolve_one_time_step_constant_voltage(2.0, imposed_voltage);
+    supercap->evolve_one_time_step_constant_voltage(2.0, imposed_voltage);
+    reference->get_current(reference_current);
+    supercap->get_current(current);
+    BOOST_TEST(current == reference_current,
+               boost::test_tools::tolerance(fidelity_tolerance));
+  }
+
+  // The approximation is rejected, when the device is built, if the
+  // collectors are poor conductors.
+  ptree.put("material_properties.collector_material.electrical_resistivity",
+            1.0);
+  BOOST_CHECK_THROW(cap::EnergyStorageDevice::build(ptree, world),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_supercapacitor_1d)
+{
+  // The same input file with dim 1 builds the through-thickness model. It
+  // must reproduce the voltage of the two-dimensional model during a charge
+  // and a discharge at constant current. The voltage starts from zero and the
+  // first time steps of each stage are dominated by the ohmic drop, which
+  // depends on the current path in the collectors of the two-dimensional
+  // model. The voltages are therefore compared after this transient, within
+  // two percent of the largest voltage reached during the test.
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::mpi::communicator world;
+  std::shared_ptr<cap::EnergyStorageDevice> supercap_2d =
+      cap::EnergyStorageDevice::build(ptree, world);
+  ptree.put("dim", 1);
+  std::shared_ptr<cap::EnergyStorageDevice> supercap_1d =
+      cap::EnergyStorageDevice::build(ptree, world);
+
+  double const tolerance = 2e-2;
+  double const time_step = 0.1;
+  int const n_transient_steps = 5;
+  double voltage_1d;
+  double voltage_2d;
+  double current;
+  std::vector<std::pair<double, double>> voltages;
+  double max_voltage = 0.;
+  // Charge at 10 mA for 4 seconds, then discharge at 5 mA for 2 seconds.
+  std::vector<std::pair<double, int>> const stages = {{10e-3, 40},
+                                                      {-5e-3, 20}};
+  for (auto const &stage : stages)
+    for (int step = 0; step < stage.second; ++step)
+    {
+      supercap_1d->evolve_one_time_step_constant_current(time_step,
+                                                         stage.first);
+      supercap_2d->evolve_one_time_step_constant_current(time_step,
+                                                         stage.first);
+      supercap_1d->get_current(current);
+      BOOST_TEST(current == stage.first,
+                 boost::test_tools::tolerance(1e-12));
+      supercap_1d->get_voltage(voltage_1d);
+      supercap_2d->get_voltage(voltage_2d);
+      max_voltage = std::max(max_voltage, std::abs(voltage_2d));
+      if (step >= n_transient_steps)
+        voltages.emplace_back(voltage_1d, voltage_2d);
+    }
+  double max_deviation = 0.;
+  for (auto const &voltage : voltages)
+    max_deviation =
+        std::max(max_deviation, std::abs(voltage.first - voltage.second));
+  BOOST_TEST_MESSAGE("Largest difference between the dim 1 and the dim 2 "
+                     "voltages: "
+                     << max_deviation << " V, largest voltage: "
+                     << max_voltage << " V");
+  BOOST_TEST(max_deviation < tolerance * max_voltage);
+
+  ptree.put("dim", 4);
+  BOOST_CHECK_THROW(cap::EnergyStorageDevice::build(ptree, world),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_axisymmetric)
+{
+  // Far from the axis, the axisymmetric cell behaves like the planar cell
+  // whose depth is the circumference.
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::mpi::communicator world;
+  std::shared_ptr<cap::EnergyStorageDevice> planar =
+      cap::EnergyStorageDevice::build(ptree, world);
+  double const inner_radius = 100.; // [centimeter]
+  ptree.put("geometry.axisymmetric", true);
+  ptree.put("geometry.inner_radius", inner_radius);
+  std::shared_ptr<cap::EnergyStorageDevice> axisymmetric =
+      cap::EnergyStorageDevice::build(ptree, world);
+
+  double const circumference = 2. * M_PI * inner_radius * 0.01;
+  double const tolerance = 1e-3;
+  double planar_voltage;
+  double voltage;
+  double current;
+  for (auto imposed_current : {10e-3, 5e-3})
+  {
+    planar->evolve_one_time_step_constant_current(2.0, imposed_current);
+    axisymmetric->evolve_one_time_step_constant_current(
+        2.0, imposed_current * circumference);
+    planar->get_voltage(planar_voltage);
+    axisymmetric->get_voltage(voltage);
+    BOOST_TEST(voltage == planar_voltage,
+               boost::test_tools::tolerance(tolerance));
+    axisymmetric->get_current(current);
+    BOOST_TEST(current == imposed_current * circumference,
+               boost::test_tools::tolerance(tolerance));
+  }
+
+  // Only the two-dimensional geometries can be axisymmetric.
+  ptree.put("dim", 3);
+  BOOST_CHECK_THROW(cap::EnergyStorageDevice::build(ptree, world),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_unit_cell)
+{
+  // Validate the unit cell against the full stack. The material properties
+  // must be homogeneous for all the cells of the stack to be identical.
+  boost::property_tree::ptree ptree;
+  boost::property_tree::info_parser::read_info("super_capacitor.info", ptree);
+  boost::property_tree::ptree geometry_database;
+  boost::property_tree::info_parser::read_info("generate_mesh.info",
+                                               geometry_database);
+  unsigned int const n_repetitions = 2;
+  geometry_database.put("n_repetitions", n_repetitions);
+  geometry_database.put("n_refinements", 1);
+  ptree.put_child("geometry", geometry_database);
+  ptree.put("material_properties.inhomogeneous", false);
+  boost::mpi::communicator world;
+  std::shared_ptr<cap::EnergyStorageDevice> stack =
+      cap::EnergyStorageDevice::build(ptree, world);
+  ptree.put("geometry.unit_cell", true);
+  std::shared_ptr<cap::EnergyStorageDevice> unit_cell =
+      cap::EnergyStorageDevice::build(ptree, world);
+  // Check that only one cell of the stack has been meshed.
+  std::shared_ptr<cap::SuperCapacitor<2>> supercapacitor =
+      std::static_pointer_cast<cap::SuperCapacitor<2>>(unit_cell);
+  BOOST_TEST(supercapacitor->get_geometry()->get_n_unit_cells() ==
+             n_repetitions + 1);
+
+  double const tolerance = 1e-3;
+  double stack_value;
+  double value;
+  for (auto imposed_current : {10e-3, 5e-3})
+  {
+    stack->evolve_one_time_step_constant_current(2.0, imposed_current);
+    unit_cell->evolve_one_time_step_constant_current(2.0, imposed_current);
+    stack->get_voltage(stack_value);
+    unit_cell->get_voltage(value);
+    BOOST_TEST(value == stack_value, boost::test_tools::tolerance(tolerance));
+    unit_cell->get_current(value);
+    BOOST_TEST(value == imposed_current,
+               boost::test_tools::tolerance(tolerance));
+  }
+  for (auto imposed_voltage : {1.4, 2.2})
+  {
+    stack->evolve_one_time_step_constant_voltage(2.0, imposed_voltage);
+    unit_cell->evolve_one_time_step_constant_voltage(2.0, imposed_voltage);
+    stack->get_current(stack_value);
+    unit_cell->get_current(value);
+    BOOST_TEST(value == stack_value, boost::test_tools::tolerance(tolerance));
+  }
+  // The extensive values of the post-processor are the ones of the stack.
+  std::shared_ptr<cap::Postprocessor<2>> stack_post_processor =
+      std::static_pointer_cast<cap::SuperCapacitor<2>>(stack)
+          ->get_post_processor();
+  for (std::string const key :
+       {"volume", "mass", "anode_electrode_interfacial_surface_area",
+        "anode_electrode_mass_of_active_material",
+        "cathode_electrode_interfacial_surface_area",
+        "cathode_electrode_mass_of_active_material"})
+  {
+    stack_post_processor->get(key, stack_value);
+    supercapacitor->get_post_processor()->get(key, value);
+    BOOST_TEST(value == stack_value, boost::test_tools::tolerance(1e-10));
+  }
+  // The Joule heating of the shared collectors is accounted for.
+  stack_post_processor->get("joule_heating", stack_value);
+  supercapacitor->get_post_processor()->get("joule_heating", value);
+  BOOST_TEST(value == stack_value, boost::test_tools::tolerance(tolerance));
+}
@@ -0,0 +1,158 @@
+/* Copyright (c) 2016, the Cap authors.
+ *
+ * This file is subject to the Modified BSD License and may not be distributed
+ * without copyright and license information. Please refer to the file LICENSE
+ * for the text and further information on this license.
+ */
+
+#define BOOST_TEST_MODULE TransmissionLine
+
+#include "main.cc"
+
+#include <cap/transmission_line.h>
+#include <cap/resistor_capacitor.h>
+#include <boost/test/unit_test.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <cstdio>
+#include <functional>
+#include <numeric>
+
+double const R_SERIES = 20.0e-3;
+double const R_SOLID = 1.0e-3;
+double const R_LIQUID = 50.0e-3;
+double const R_LEAKAGE = 2.5e3;
+double const C = 3.0;
+double const TOLERANCE = 1.0e-8; // in percentage units
+
+boost::property_tree::ptree make_database(std::size_t const n_segments)
+{
+  boost::property_tree::ptree ptree;
+  ptree.put("type", "TransmissionLine");
+  ptree.put("n_segments", n_segments);
+  ptree.put("series_resistance", R_SERIES);
+  ptree.put("solid_resistance", R_SOLID);
+  ptree.put("liquid_resistance", R_LIQUID);
+  ptree.put("capacitance", C);
+  return ptree;
+}
+
+BOOST_AUTO_TEST_CASE(test_single_segment)
+{
+  // With a single segment, the current flows through half of each phase and
+  // the line is a series RC circuit. Backward Euler is exact for a capacitor
+  // charged at constant current.
+  boost::mpi::communicator world;
+  cap::TransmissionLine line(make_database(1), world);
+  boost::property_tree::ptree rc_database;
+  rc_database.put("series_resistance", R_SERIES + 0.5 * (R_SOLID + R_LIQUID));
+  rc_database.put("capacitance", C);
+  cap::SeriesRC rc(rc_database, world);
+  for (double const current : {0.1, -0.3, 0.2})
+  {
+    line.evolve_one_time_step_constant_current(0.1, current);
+    rc.evolve_one_time_step_constant_current(0.1, current);
+    double voltage;
+    line.get_voltage(voltage);
+    BOOST_CHECK_CLOSE(voltage, rc.U, TOLERANCE);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_de_levie_resistance)
+{
+  // Under constant current, the charge is conserved and, once the
+  // distribution of the charge in the electrode is established, the voltage
+  // is I t / C plus the low-frequency resistance of the transmission line,
+  // i.e. a third of the resistance of the two phases.
+  boost::mpi::communicator world;
+  std::size_t const n_segments = 200;
+  cap::TransmissionLine line(make_database(n_segments), world);
+  double const current = 0.5;
+  double const dt = 0.01;
+  int const n_steps = 1000;
+  for (int step = 0; step < n_steps; ++step)
+    line.evolve_one_time_step_constant_current(dt, current);
+
+  std::vector<double> const &v = line.get_capacitor_voltages();
+  double const charge =
+      C / n_segments * std::accumulate(v.begin(), v.end(), 0.0);
+  BOOST_CHECK_CLOSE(charge, current * dt * n_steps, TOLERANCE);
+
+  double const resistance = R_SERIES + (R_SOLID + R_LIQUID) / 3.0;
+  double voltage;
+  line.get_voltage(voltage);
+  BOOST_CHECK_CLOSE(voltage - charge / C, current * resistance, 1.0e-2);
+}
+
+BOOST_AUTO_TEST_CASE(test_operating_conditions)
+{
+  // The current obtained under constant voltage, power, or load must yield
+  // the same state when it is imposed.
+  boost::mpi::communicator world;
+  boost::property_tree::ptree ptree = make_database(20);
+  ptree.put("leakage_resistance", R_LEAKAGE);
+  ptree.put("initial_voltage", 1.0);
+  auto device = cap::EnergyStorageDevice::build(ptree, world);
+  cap::TransmissionLine line(ptree, world);
+  double const dt = 0.05;
+  std::vector<std::function<void(cap::EnergyStorageDevice &)>> const
+      operating_conditions = {
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_voltage(dt, 2.1);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_linear_voltage(dt, 1.9);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_power(dt, -0.5);
+          },
+          [dt](cap::EnergyStorageDevice &dev)
+          {
+            dev.evolve_one_time_step_constant_load(dt, 0.2);
+          }};
+  for (auto const &evolve : operating_conditions)
+  {
+    evolve(*device);
+    double current;
+    double voltage;
+    device->get_current(current);
+    device->get_voltage(voltage);
+    line.evolve_one_time_step_linear_current(dt, current);
+    double line_voltage;
+    line.get_voltage(line_voltage);
+    BOOST_CHECK_CLOSE(line_voltage, voltage, TOLERANCE);
+  }
+  double current;
+  double voltage;
+  device->get_current(current);
+  device->get_voltage(voltage);
+  BOOST_CHECK_CLOSE(voltage, -0.2 * current, TOLERANCE);
+  BOOST_CHECK_THROW(device->evolve_one_time_step_linear_power(dt, 1.0),
+                    std::runtime_error);
+  BOOST_CHECK_THROW(device->evolve_one_time_step_linear_load(dt, 1.0),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_save_load)
+{
+  boost::mpi::communicator world;
+  cap::TransmissionLine line(make_database(10), world);
+  line.evolve_one_time_step_constant_current(0.1, 1.0);
+  std::string const filename = "transmission_line.txt";
+  line.save(filename);
+  cap::TransmissionLine restored(make_database(10), world);
+  restored.load(filename);
+  BOOST_TEST(restored.get_capacitor_voltages() ==
+             line.get_capacitor_voltages());
+  cap::TransmissionLine other(make_database(11), world);
+  BOOST_CHECK_THROW(other.load(filename), std::runtime_error);
+  std::remove(filename.c_str());
+
+  boost::property_tree::ptree ptree = make_database(0);
+  BOOST_CHECK_THROW(cap::TransmissionLine(ptree, world), std::runtime_error);
+  ptree = make_database(10);
+  ptree.put("solid_resistance", -1.0);
+  BOOST_CHECK_THROW(cap::TransmissionLine(ptree, world), std::runtime_error);
+}
@@ -62,3 +62,50 @@ class TimeEvolution:
             raise RuntimeError("invalid TimeEvolution mode '" + mode + "'")
 
     factory = staticmethod(factory)
+
+    def interval_factory(ptree):
+        # Return a function that advances the device over an interval of
+        # arbitrary length in a single call, or None if the operating
+        # condition does not admit a closed-form response.
+        mode = ptree.get_string('mode')
+
+        if mode in ['constant_voltage', 'potentiostatic']:
+            constant_voltage = ptree.get_double('voltage')
+
+            def evolve_over_interval_constant_voltage(device, duration):
+                return device.evolve_over_interval_constant_voltage(
+                    duration, constant_voltage)
+            return evolve_over_interval_constant_voltage
+
+        elif mode in ['constant_current', 'galvanostatic']:
+            constant_current = ptree.get_double('current')
+
+            def evolve_over_interval_constant_current(device, duration):
+                return device.evolve_over_interval_constant_current(
+                    duration, constant_current)
+            return evolve_over_interval_constant_current
+
+        elif mode == 'constant_load':
+            constant_load = ptree.get_double('load')
+
+            def evolve_over_interval_constant_load(device, duration):
+                return device.evolve_over_interval_constant_load(
+                    duration, constant_load)
+            return evolve_over_interval_constant_load
+
+        elif mode == 'hold':
+            def evolve_over_interval_hold(device, duration):
+                return device.evolve_over_interval_constant_voltage(
+                    duration, device.get_voltage())
+            return evolve_over_interval_hold
+
+        elif mode == 'rest':
+            def evolve_over_interval_rest(device, duration):
+                return device.evolve_over_interval_constant_current(
+                    duration, 0.0)
+            return evolve_over_interval_rest
+
+        else:
+            return None
+
+    interval_factory = staticmethod(interval_factory)
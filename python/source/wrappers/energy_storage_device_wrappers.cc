@@ -26,6 +26,59 @@ double get_voltage(cap::EnergyStorageDevice const & dev)
     return voltage;
 }
 
+boost::python::tuple evolve_over_interval_constant_current(
+    cap::EnergyStorageDevice & dev, double duration, double current)
+{
+    double charge, energy;
+    dev.evolve_over_interval_constant_current(duration, current, charge,
+                                              energy);
+    return boost::python::make_tuple(charge, energy);
+}
+
+boost::python::tuple evolve_over_interval_constant_voltage(
+    cap::EnergyStorageDevice & dev, double duration, double voltage)
+{
+    double charge, energy;
+    dev.evolve_over_interval_constant_voltage(duration, voltage, charge,
+                                              energy);
+    return boost::python::make_tuple(charge, energy);
+}
+
+boost::python::tuple evolve_over_interval_constant_load(
+    cap::EnergyStorageDevice & dev, double duration, double load)
+{
+    double charge, energy;
+    dev.evolve_over_interval_constant_load(duration, load, charge, energy);
+    return boost::python::make_tuple(charge, energy);
+}
+
+namespace
+{
+// Extract the values at the probes of a SuperCapacitor<dim>. Return false if
+// the device is not a SuperCapacitor<dim>.
+template <int dim>
+bool inspect_probes(cap::EnergyStorageDevice & dev, boost::python::dict & data)
+{
+    cap::ProbeInspector<dim> inspector;
+    try
+    {
+      dev.inspect(&inspector);
+    }
+    catch (std::bad_cast const &)
+    {
+      return false;
+    }
+    for (auto const & x : inspector.get_data())
+    {
+      boost::python::list values;
+      for (double const value : x.second)
+        values.append(value);
+      data[x.first] = values;
+    }
+    return true;
+}
+} // end anonymous namespace
+
 boost::python::dict inspect(cap::EnergyStorageDevice & dev,
                             const std::string & type)
 {
@@ -70,6 +123,12 @@ boost::python::dict inspect(cap::EnergyStorageDevice & dev,
         throw std::runtime_error("The postprocessor inspector can only be used "
             "with a supercapacitor device");
     }
+    else if (type.compare("probes") == 0)
+    {
+      if (!inspect_probes<2>(dev, data) && !inspect_probes<3>(dev, data))
+        throw std::runtime_error("The probes inspector can only be used "
+            "with a supercapacitor device");
+    }
     else
       throw std::runtime_error("Unknown inspector type");
 
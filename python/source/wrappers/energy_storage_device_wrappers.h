@@ -5,12 +5,20 @@
 #include <boost/python/object.hpp>
 #include <boost/python/wrapper.hpp>
 #include <boost/python/dict.hpp>
+#include <boost/python/list.hpp>
+#include <boost/python/tuple.hpp>
 #include <string>
 
 namespace pycap {
 
 double get_current(cap::EnergyStorageDevice const & device);
 double get_voltage(cap::EnergyStorageDevice const & device);
+boost::python::tuple evolve_over_interval_constant_current(
+    cap::EnergyStorageDevice & device, double duration, double current);
+boost::python::tuple evolve_over_interval_constant_voltage(
+    cap::EnergyStorageDevice & device, double duration, double voltage);
+boost::python::tuple evolve_over_interval_constant_load(
+    cap::EnergyStorageDevice & device, double duration, double load);
 // TODO: may want const reference here
 boost::python::dict inspect(cap::EnergyStorageDevice & device,
                             const std::string & type = "default");
@@ -55,6 +55,7 @@ char const inspect_docstring[] =
   "    Possible values are:                                                 \n"
   "        - 'default' (default value)                                      \n"
   "        - 'postprocessor' (only for supercapacitor)                      \n"
+  "        - 'probes' (only for supercapacitor)                             \n"
   "                                                                         \n"
   "Returns                                                                  \n"
   "-------                                                                  \n"
@@ -105,6 +106,67 @@ char const evolve_one_time_step_constant_load_docstring[] =
   "    The load in ohms.                                                    \n"
   ;
 
+char const has_closed_form_response_docstring[] =
+  "Check whether the device can be evolved over long intervals in one call. \n"
+  "                                                                         \n"
+  "Returns                                                                  \n"
+  "-------                                                                  \n"
+  "bool                                                                     \n"
+  "    True if the evolve_over_interval functions are implemented.          \n"
+  ;
+
+char const evolve_over_interval_constant_current_docstring[] =
+  "Impose the electrical current and evolve over an interval in one call.   \n"
+  "                                                                         \n"
+  "Parameters                                                               \n"
+  "----------                                                               \n"
+  "duration : float                                                         \n"
+  "    The length of the interval in seconds.                               \n"
+  "current : float                                                          \n"
+  "    The electrical current in amperes.                                   \n"
+  "                                                                         \n"
+  "Returns                                                                  \n"
+  "-------                                                                  \n"
+  "tuple                                                                    \n"
+  "    The charge in coulombs and the energy in joules that entered the     \n"
+  "    device during the interval.                                          \n"
+  ;
+
+char const evolve_over_interval_constant_voltage_docstring[] =
+  "Impose the voltage across the device and evolve over an interval in one  \n"
+  "call.                                                                    \n"
+  "                                                                         \n"
+  "Parameters                                                               \n"
+  "----------                                                               \n"
+  "duration : float                                                         \n"
+  "    The length of the interval in seconds.                               \n"
+  "voltage : float                                                          \n"
+  "    The voltage across the device in volts.                              \n"
+  "                                                                         \n"
+  "Returns                                                                  \n"
+  "-------                                                                  \n"
+  "tuple                                                                    \n"
+  "    The charge in coulombs and the energy in joules that entered the     \n"
+  "    device during the interval.                                          \n"
+  ;
+
+char const evolve_over_interval_constant_load_docstring[] =
+  "Impose the load and evolve over an interval in one call.                 \n"
+  "                                                                         \n"
+  "Parameters                                                               \n"
+  "----------                                                               \n"
+  "duration : float                                                         \n"
+  "    The length of the interval in seconds.                               \n"
+  "load : float                                                             \n"
+  "    The load in ohms.                                                    \n"
+  "                                                                         \n"
+  "Returns                                                                  \n"
+  "-------                                                                  \n"
+  "tuple                                                                    \n"
+  "    The charge in coulombs and the energy in joules that entered the     \n"
+  "    device during the interval.                                          \n"
+  ;
+
 char const save_docstring[] =
   "Save the current state of the energy storage device in a file.           \n"
   "                                                                         \n"
@@ -179,6 +241,22 @@ void export_energy_storage_device()
     .def("evolve_one_time_step_linear_load",
          &cap::EnergyStorageDevice::evolve_one_time_step_linear_load,
          boost::python::args("self", "time_step", "load") )
+    .def("has_closed_form_response",
+         &cap::EnergyStorageDevice::has_closed_form_response,
+         has_closed_form_response_docstring,
+         boost::python::args("self") )
+    .def("evolve_over_interval_constant_current",
+         &evolve_over_interval_constant_current,
+         evolve_over_interval_constant_current_docstring,
+         boost::python::args("self", "duration", "current") )
+    .def("evolve_over_interval_constant_voltage",
+         &evolve_over_interval_constant_voltage,
+         evolve_over_interval_constant_voltage_docstring,
+         boost::python::args("self", "duration", "voltage") )
+    .def("evolve_over_interval_constant_load",
+         &evolve_over_interval_constant_load,
+         evolve_over_interval_constant_load_docstring,
+         boost::python::args("self", "duration", "load") )
     .def("save",
          &cap::EnergyStorageDevice::save,
          save_docstring,
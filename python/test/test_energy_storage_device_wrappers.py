@@ -88,6 +88,23 @@ class capEnergyStorageDeviceWrappersTestCase(unittest.TestCase):
         os.remove(vtu_file)
         os.remove(pvtu_file)
 
+    def test_probes_inspect(self):
+        ptree = PropertyTree()
+        ptree.parse_info('series_rc.info')
+        device = EnergyStorageDevice(ptree)
+        self.assertRaises(RuntimeError, device.inspect, 'probes')
+
+        ptree = PropertyTree()
+        ptree.parse_info('super_capacitor.info')
+        device = EnergyStorageDevice(ptree)
+        device.evolve_one_time_step_constant_current(0.1, 0.1)
+        # no probe defined in the input
+        data = device.inspect('probes')
+        self.assertTrue(isinstance(data, dict))
+        for key in ['solid_potential', 'liquid_potential', 'overpotential',
+                    'position_0', 'position_1']:
+            self.assertEqual(data[key], [])
+
     def test_sanity(self):
         # valid input to buid an energy storage device
         for filename in valid_device_input:
@@ -70,6 +70,36 @@ class capStageTestCase(unittest.TestCase):
         self.assertAlmostEqual(data['voltage'][0], data['voltage'][1])
         self.assertAlmostEqual(data['current'][3], 0.0)
 
+    def test_time_limited_stage_in_a_single_call(self):
+        device_jump = EnergyStorageDevice(ptree, comm)
+        device_steps = EnergyStorageDevice(ptree, comm)
+        self.assertTrue(device_jump.has_closed_form_response())
+        stage_ptree = PropertyTree()
+        stage_ptree.put_string('mode', 'constant_current')
+        stage_ptree.put_double('current', 5e-3)
+        stage_ptree.put_string('end_criterion', 'time')
+        stage_ptree.put_double('duration', 15.0)
+        stage_ptree.put_double('time_step', 0.1)
+        stage = Stage(stage_ptree)
+        # without data the stage is performed in a single call that stands for
+        # the same number of time steps
+        self.assertEqual(stage.run(device_jump), 150)
+        data = initialize_data()
+        self.assertEqual(stage.run(device_steps, data), 150)
+        self.assertAlmostEqual(device_jump.get_voltage(),
+                               device_steps.get_voltage())
+        self.assertAlmostEqual(device_jump.get_current(), 5e-3)
+        # the single call ends where the last time step ends even when the
+        # duration is not a multiple of the time step
+        stage_ptree.put_double('duration', 15.05)
+        stage = Stage(stage_ptree)
+        self.assertEqual(stage.run(device_jump), 151)
+        data = initialize_data()
+        self.assertEqual(stage.run(device_steps, data), 151)
+        self.assertAlmostEqual(data['time'][-1], 15.1)
+        self.assertAlmostEqual(device_jump.get_voltage(),
+                               device_steps.get_voltage())
+
 
 if __name__ == '__main__':
     unittest.main()